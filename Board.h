@@ -57,6 +57,8 @@ extern "C" {
 #define Board_ADCBUF0           CC26X2R1_LAUNCHXL_ADCBUF0
 #define Board_ADCBUF0CHANNEL0   CC26X2R1_LAUNCHXL_ADCBUF0CHANNEL0
 #define Board_ADCBUF0CHANNEL1   CC26X2R1_LAUNCHXL_ADCBUF0CHANNEL1
+#define Board_ADCBUF_BATTERY            Board_ADCBUF0
+#define Board_ADCBUF_BATTERY_CHANNEL    CC26X2R1_LAUNCHXL_ADCBUF0CHANNEL7  /* DIO30, same input as Board_POWER_ADC */
 
 #define Board_ECDH0             CC26X2R1_LAUNCHXL_ECDH0
 #define Board_ECDSA0            CC26X2R1_LAUNCHXL_ECDSA0
@@ -122,11 +124,14 @@ extern "C" {
 #define Board_GPTIMER2B         CC26X2R1_LAUNCHXL_GPTIMER2B
 #define Board_GPTIMER3A         CC26X2R1_LAUNCHXL_GPTIMER3A
 #define Board_GPTIMER3B         CC26X2R1_LAUNCHXL_GPTIMER3B
+#define Board_GPTIMER_TONE      CC26X2R1_LAUNCHXL_GPTIMER3B  /* buzzer tone sequencer, owns GPT3B: no Board_PWM7 */
+#define Board_GPTIMER_PULSE     CC26X2R1_LAUNCHXL_GPTIMER3A  /* pulse train generator, owns GPT3A: no MOTOR_PWM (main.c) */
 
 #define Board_I2C0              CC26X2R1_LAUNCHXL_I2C0
 #define Board_I2C_TMP           Board_I2C0
 
 #define Board_NVSINTERNAL       CC26X2R1_LAUNCHXL_NVSCC26XX0
+#define Board_NVSKEYPADAUTH     CC26X2R1_LAUNCHXL_NVSCC26XX1  /* keypad replay counter */
 #define Board_NVSEXTERNAL       CC26X2R1_LAUNCHXL_NVSSPI25X0
 
 #define Board_DIO14_MOTOR_SW1   CC26X2R1_JANUS_DIO14_MOTOR_SW1
@@ -149,7 +154,11 @@ extern "C" {
 #define Board_PWM4              CC26X2R1_LAUNCHXL_PWM4
 #define Board_PWM5              CC26X2R1_LAUNCHXL_PWM5
 #define Board_PWM_MOTOR2        CC26X2R1_LAUNCHXL_PWM6
-#define Board_PWM7              CC26X2R1_LAUNCHXL_PWM7
+/* No Board_PWM7: its timer half GPT3B is Board_GPTIMER_TONE, opened by the buzzer in every build */
+#define Board_PWM_LED_FR        Board_PWM1  /* LED dimming channels, routed to the LEDs with LED_PWM */
+#define Board_PWM_LED_FG        Board_PWM3
+#define Board_PWM_LED_BR        Board_PWM4
+#define Board_PWM_LED_BG        Board_PWM5
 
 #define Board_SD0               CC26X2R1_LAUNCHXL_SDSPI0
 
@@ -171,7 +171,7 @@ const ADCCC26XX_HWAttrs adcCC26xxHWAttrs[CC26X2R1_LAUNCHXL_ADCCOUNT] = {
         .adcDIO              = CC26X2R1_LAUNCHXL_DIO30_ANALOG,
         .adcCompBInput       = ADC_COMPB_IN_AUXIO0,
         .refSource           = ADCCC26XX_FIXED_REFERENCE,
-        .samplingDuration    = ADCCC26XX_SAMPLING_DURATION_10P9_MS,
+        .samplingDuration    = ADCCC26XX_SAMPLING_DURATION_341_US,  /* battery divider, BATTERY_SAMPLING_US */
         .inputScalingEnabled = true,
         .triggerSource       = ADCCC26XX_TRIGGER_MANUAL,
         .returnAdjustedVal   = false
@@ -747,6 +747,9 @@ const uint_least8_t I2S_count = CC26X2R1_LAUNCHXL_I2SCOUNT;
 #define NVS_REGIONS_BASE 0x48000
 #define SECTORSIZE       0x2000
 #define REGIONSIZE       (SECTORSIZE * 4)
+/* Region 0 gets the first two sectors, region 1 the last two */
+#define REGION0SIZE      (SECTORSIZE * 2)
+#define REGION1SIZE      (REGIONSIZE - REGION0SIZE)
 
 #ifndef Board_EXCLUDE_NVS_INTERNAL_FLASH
 
@@ -788,13 +791,17 @@ static char flashBuf[REGIONSIZE];
 #endif
 
 /* Allocate objects for NVS Internal Regions */
-NVSCC26XX_Object nvsCC26xxObjects[1];
+NVSCC26XX_Object nvsCC26xxObjects[2];
 
 /* Hardware attributes for NVS Internal Regions */
-const NVSCC26XX_HWAttrs nvsCC26xxHWAttrs[1] = {
+const NVSCC26XX_HWAttrs nvsCC26xxHWAttrs[2] = {
     {
         .regionBase = (void *)flashBuf,
-        .regionSize = REGIONSIZE,
+        .regionSize = REGION0SIZE,
+    },
+    {
+        .regionBase = (void *)(flashBuf + REGION0SIZE),
+        .regionSize = REGION1SIZE,
     },
 };
 
@@ -829,7 +836,7 @@ const NVSSPI25X_HWAttrs nvsSPI25XHWAttrs[1] = {
 
 #endif /* Board_EXCLUDE_NVS_EXTERNAL_FLASH */
 
-/* NVS Region index 0 and 1 refer to NVS and NVS SPI respectively */
+/* NVS Region index 0 and 1 refer to NVS, 2 to NVS SPI */
 const NVS_Config NVS_config[CC26X2R1_LAUNCHXL_NVSCOUNT] = {
 #ifndef Board_EXCLUDE_NVS_INTERNAL_FLASH
     {
@@ -837,6 +844,11 @@ const NVS_Config NVS_config[CC26X2R1_LAUNCHXL_NVSCOUNT] = {
         .object = &nvsCC26xxObjects[0],
         .hwAttrs = &nvsCC26xxHWAttrs[0],
     },
+    {
+        .fxnTablePtr = &NVSCC26XX_fxnTable,
+        .object = &nvsCC26xxObjects[1],
+        .hwAttrs = &nvsCC26xxHWAttrs[1],
+    },
 #endif
 #ifndef Board_EXCLUDE_NVS_EXTERNAL_FLASH
     {
@@ -925,7 +937,7 @@ PWMTimerCC26XX_Object pwmtimerCC26xxObjects[CC26X2R1_LAUNCHXL_PWMCOUNT];
 
 const PWMTimerCC26XX_HwAttrs pwmtimerCC26xxHWAttrs[CC26X2R1_LAUNCHXL_PWMCOUNT] = {
     { .pwmPin = CC26X2R1_JANUS_L1_MOTOR1_PWMPIN0, .gpTimerUnit = CC26X2R1_LAUNCHXL_GPTIMER0A },
-    { .pwmPin = CC26X2R1_LAUNCHXL_PWMPIN6, .gpTimerUnit = CC26X2R1_LAUNCHXL_GPTIMER0B },
+    { .pwmPin = CC26X2R1_LAUNCHXL_PWMPIN1, .gpTimerUnit = CC26X2R1_LAUNCHXL_GPTIMER0B },
     { .pwmPin = CC26X2R1_JANUS_L1_BUZZER_PWMPIN2, .gpTimerUnit = CC26X2R1_LAUNCHXL_GPTIMER1A },
     { .pwmPin = CC26X2R1_LAUNCHXL_PWMPIN3, .gpTimerUnit = CC26X2R1_LAUNCHXL_GPTIMER1B },
     { .pwmPin = CC26X2R1_LAUNCHXL_PWMPIN4, .gpTimerUnit = CC26X2R1_LAUNCHXL_GPTIMER2A },
@@ -148,9 +148,17 @@ extern const PIN_Config BoardGpioInitTable[];
 #define CC26X2R1_JANUS_L1_MOTOR2_PWMPIN1        IOID_24
 #define CC26X2R1_JANUS_L1_BUZZER_PWMPIN2        IOID_25
 
+#ifdef LED_PWM
+#define CC26X2R1_LAUNCHXL_PWMPIN1               CC26X2R1_LAUNCHXL_DIO22_FRONT_RLED
+#define CC26X2R1_LAUNCHXL_PWMPIN3               CC26X2R1_LAUNCHXL_DIO21_FRONT_GLED
+#define CC26X2R1_LAUNCHXL_PWMPIN4               CC26X2R1_LAUNCHXL_DIO19_BACK_RLED
+#define CC26X2R1_LAUNCHXL_PWMPIN5               CC26X2R1_LAUNCHXL_DIO18_BACK_GLED
+#else
+#define CC26X2R1_LAUNCHXL_PWMPIN1               PIN_UNASSIGNED
 #define CC26X2R1_LAUNCHXL_PWMPIN3               PIN_UNASSIGNED
 #define CC26X2R1_LAUNCHXL_PWMPIN4               PIN_UNASSIGNED
 #define CC26X2R1_LAUNCHXL_PWMPIN5               PIN_UNASSIGNED
+#endif
 #define CC26X2R1_LAUNCHXL_PWMPIN6               PIN_UNASSIGNED
 #define CC26X2R1_LAUNCHXL_PWMPIN7               PIN_UNASSIGNED
 
@@ -449,6 +457,7 @@ typedef enum CC26X2R1_LAUNCHXL_I2SName {
 typedef enum CC26X2R1_LAUNCHXL_NVSName {
 #ifndef Board_EXCLUDE_NVS_INTERNAL_FLASH
     CC26X2R1_LAUNCHXL_NVSCC26XX0 = 0,
+    CC26X2R1_LAUNCHXL_NVSCC26XX1,
 #endif
 #ifndef Board_EXCLUDE_NVS_EXTERNAL_FLASH
     CC26X2R1_LAUNCHXL_NVSSPI25X0,
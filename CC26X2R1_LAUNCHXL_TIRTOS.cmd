@@ -108,6 +108,7 @@ SECTIONS
     .sysmem         :   > SRAM
     .stack          :   > SRAM (HIGH)
     .nonretenvar    :   > SRAM
+    .TI.noinit      :   > SRAM
     /* Heap buffer used by HeapMem */
     .priheap   : {
         __primary_heap_start__ = .;
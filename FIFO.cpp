@@ -79,8 +79,6 @@ int FIFOFilledNumber(FIFO_Buf* fifo)
 {
   if(FIFOIsEmpty(fifo))
     return 0;
-  else if(FIFOIsFull(fifo))
-    return fifo->size;
   else if(fifo->writeIndex < fifo->readIndex)
     return (fifo->writeIndex) + (fifo->size - fifo->readIndex);
   else
@@ -202,3 +200,63 @@ int FIFOGetBytes(FIFO_Buf* fifo, char* bytes, int count)
 
   return count;
 }
+
+/**
+  * @brief  Read one byte data from FIFO buffer without removing it
+  * @param fifo : the poiter of FIFO buffer structure.
+  * @param offset : position of the byte counted from the oldest byte
+  * @param byte : the pointer of byte value which store one byte data from FIFO buffer
+  * @return true when successful; false when fail
+  */
+bool FIFOPeekByte(FIFO_Buf* fifo, int offset, char* byte)
+{
+  int index;
+
+  if(fifo == NULL)
+  {
+#ifdef DEBUG
+    System_printf("FIFO is NULL\n");
+#endif
+    return false;
+  }
+  if((offset < 0) || (offset >= FIFOFilledNumber(fifo)))
+    return false;
+
+  index = fifo->readIndex + offset;
+  if(index >= fifo->size)
+    index -= fifo->size;
+  *byte = fifo->buffer[index];
+  return true;
+}
+
+/**
+  * @brief  Remove bytes data from FIFO buffer without reading them
+  * @param fifo : the poiter of FIFO buffer structure.
+  * @param count : the number of bytes to remove
+  * @return -1 when fail; the real number of byte data are removed from FIFO buffer when successful
+  */
+int FIFODiscardBytes(FIFO_Buf* fifo, int count)
+{
+  int filled;
+  int index;
+
+  if(fifo == NULL)
+  {
+#ifdef DEBUG
+    System_printf("FIFO is NULL\n");
+#endif
+    return -1;
+  }
+
+  filled = FIFOFilledNumber(fifo);
+  if(count > filled)
+    count = filled;
+  if(count <= 0)
+    return 0;
+
+  index = fifo->readIndex + count;
+  if(index >= fifo->size)
+    index -= fifo->size;
+  fifo->readIndex = index;
+  return count;
+}
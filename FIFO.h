@@ -21,6 +21,8 @@ extern bool FIFOPutByte(FIFO_Buf* fifo, char byte);
 extern bool FIFOGetByte(FIFO_Buf* fifo, char* byte);
 extern int FIFOPutBytes(FIFO_Buf* fifo, char* bytes, int count);
 extern int FIFOGetBytes(FIFO_Buf* fifo, char* bytes, int count);
+extern bool FIFOPeekByte(FIFO_Buf* fifo, int offset, char* byte);
+extern int FIFODiscardBytes(FIFO_Buf* fifo, int count);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,387 @@
+/*
+ *  ======== aes_ccm.c ========
+ *  Software AES-128 CCM (NIST SP 800-38C, RFC 3610).
+ *
+ *  Byte oriented implementation of the AES forward cipher, which is all
+ *  CCM needs, and of CCM authenticated encryption on top of it. It gives
+ *  the same output as the AESCCM driver, and has no TI-RTOS dependency so
+ *  it can also be compiled on a host.
+ */
+
+#include <string.h>
+
+#include "aes_ccm.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define AES_CCM_ROUNDS          10
+
+/* Largest AAD length encoded in 2 bytes */
+#define AES_CCM_AAD_SHORT_MAX   0xFEFF
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static const uint8_t aesSbox[256] = {
+    0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+    0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+    0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+    0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+    0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+    0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+    0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+    0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+    0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+    0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+    0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+    0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+    0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+    0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+    0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+    0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16,
+};
+
+static const uint8_t aesRcon[AES_CCM_ROUNDS] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36,
+};
+
+/**
+  * @brief  Multiply by x in GF(2^8).
+  * @param a : input byte.
+  * @return product
+  */
+static uint8_t AesCcm_xtime(uint8_t a)
+{
+    return (uint8_t)((a << 1) ^ ((a & 0x80) ? 0x1B : 0x00));
+}
+
+/**
+  * @brief  Expand an AES-128 key into the round keys.
+  * @param ctx : context to initialize.
+  * @param key : AES_CCM_KEY_SIZE bytes key.
+  * @return none
+  */
+void AesCcm_setKey(AesCcmContext *ctx, const uint8_t *key)
+{
+    uint8_t *w = ctx->roundKey;
+    uint8_t t[4];
+    uint8_t i;
+
+    memcpy(w, key, AES_CCM_KEY_SIZE);
+    for(i = 4; i < 4 * (AES_CCM_ROUNDS + 1); i++)
+    {
+        memcpy(t, &w[(i - 1) * 4], 4);
+        if((i & 3) == 0)
+        {
+            uint8_t first = t[0];
+
+            t[0] = aesSbox[t[1]] ^ aesRcon[(i >> 2) - 1];
+            t[1] = aesSbox[t[2]];
+            t[2] = aesSbox[t[3]];
+            t[3] = aesSbox[first];
+        }
+        w[i * 4 + 0] = w[(i - 4) * 4 + 0] ^ t[0];
+        w[i * 4 + 1] = w[(i - 4) * 4 + 1] ^ t[1];
+        w[i * 4 + 2] = w[(i - 4) * 4 + 2] ^ t[2];
+        w[i * 4 + 3] = w[(i - 4) * 4 + 3] ^ t[3];
+    }
+}
+
+/**
+  * @brief  Encrypt one block with the AES forward cipher.
+  * @param ctx : context with the expanded key.
+  * @param input : AES_CCM_BLOCK_SIZE bytes plaintext.
+  * @param output : AES_CCM_BLOCK_SIZE bytes ciphertext, may equal input.
+  * @return none
+  */
+void AesCcm_encryptBlock(const AesCcmContext *ctx, const uint8_t *input, uint8_t *output)
+{
+    uint8_t s[AES_CCM_BLOCK_SIZE];
+    uint8_t t[AES_CCM_BLOCK_SIZE];
+    uint8_t round;
+    uint8_t c;
+    uint8_t i;
+
+    for(i = 0; i < AES_CCM_BLOCK_SIZE; i++)
+    {
+        s[i] = input[i] ^ ctx->roundKey[i];
+    }
+
+    for(round = 1; round <= AES_CCM_ROUNDS; round++)
+    {
+        /* SubBytes and ShiftRows, the state is stored column by column */
+        for(i = 0; i < AES_CCM_BLOCK_SIZE; i++)
+        {
+            t[i] = aesSbox[s[(i + 4 * (i & 3)) & 0x0F]];
+        }
+
+        /* MixColumns, skipped in the last round */
+        if(round < AES_CCM_ROUNDS)
+        {
+            for(c = 0; c < AES_CCM_BLOCK_SIZE; c += 4)
+            {
+                uint8_t a0 = t[c], a1 = t[c + 1], a2 = t[c + 2], a3 = t[c + 3];
+                uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+
+                t[c]     = a0 ^ all ^ AesCcm_xtime(a0 ^ a1);
+                t[c + 1] = a1 ^ all ^ AesCcm_xtime(a1 ^ a2);
+                t[c + 2] = a2 ^ all ^ AesCcm_xtime(a2 ^ a3);
+                t[c + 3] = a3 ^ all ^ AesCcm_xtime(a3 ^ a0);
+            }
+        }
+
+        /* AddRoundKey */
+        for(i = 0; i < AES_CCM_BLOCK_SIZE; i++)
+        {
+            s[i] = t[i] ^ ctx->roundKey[round * AES_CCM_BLOCK_SIZE + i];
+        }
+    }
+
+    memcpy(output, s, AES_CCM_BLOCK_SIZE);
+}
+
+/**
+  * @brief  Check CCM parameters.
+  * @param nonceLength : nonce length.
+  * @param aadLength : additional data length.
+  * @param length : payload length.
+  * @param macLength : MAC length.
+  * @return true when they are supported
+  */
+static bool AesCcm_checkParams(uint8_t nonceLength, size_t aadLength, size_t length, uint8_t macLength)
+{
+    uint8_t lengthSize = 15 - nonceLength;
+
+    if((nonceLength < AES_CCM_NONCE_MIN) || (nonceLength > AES_CCM_NONCE_MAX))
+        return false;
+    if((macLength < AES_CCM_MAC_MIN) || (macLength > AES_CCM_MAC_MAX) || (macLength & 1))
+        return false;
+    if(aadLength > AES_CCM_AAD_SHORT_MAX)
+        return false;
+    /* The payload length must fit in the length field */
+    if((lengthSize < sizeof(size_t)) && ((length >> (8 * lengthSize)) != 0))
+        return false;
+    return true;
+}
+
+/**
+  * @brief  Build a counter block A(i).
+  * @param block : output, AES_CCM_BLOCK_SIZE bytes.
+  * @param nonce : nonce.
+  * @param nonceLength : nonce length.
+  * @param counter : block counter.
+  * @return none
+  */
+static void AesCcm_counterBlock(uint8_t *block, const uint8_t *nonce, uint8_t nonceLength, uint32_t counter)
+{
+    uint8_t i;
+
+    memset(block, 0, AES_CCM_BLOCK_SIZE);
+    block[0] = 14 - nonceLength;        //L - 1
+    memcpy(&block[1], nonce, nonceLength);
+    for(i = AES_CCM_BLOCK_SIZE - 1; (i > nonceLength) && counter; i--)
+    {
+        block[i] = (uint8_t)counter;
+        counter >>= 8;
+    }
+}
+
+/**
+  * @brief  Compute the CBC-MAC of a CCM message.
+  * @param ctx : context with the expanded key.
+  * @param nonce : nonce.
+  * @param nonceLength : nonce length.
+  * @param aad : additional authenticated data.
+  * @param aadLength : additional data length.
+  * @param payload : plaintext.
+  * @param length : plaintext length.
+  * @param macLength : MAC length.
+  * @param tag : output, AES_CCM_BLOCK_SIZE bytes unencrypted tag.
+  * @return none
+  */
+static void AesCcm_cbcMac(const AesCcmContext *ctx, const uint8_t *nonce, uint8_t nonceLength,
+                          const uint8_t *aad, size_t aadLength,
+                          const uint8_t *payload, size_t length, uint8_t macLength, uint8_t *tag)
+{
+    size_t remaining;
+    size_t i;
+    uint8_t pos;
+
+    /* B0: flags | nonce | payload length */
+    AesCcm_counterBlock(tag, nonce, nonceLength, 0);
+    tag[0] = (aadLength ? 0x40 : 0x00) | (((macLength - 2) / 2) << 3) | (14 - nonceLength);
+    remaining = length;
+    for(i = AES_CCM_BLOCK_SIZE - 1; (i > nonceLength) && remaining; i--)
+    {
+        tag[i] = (uint8_t)remaining;
+        remaining >>= 8;
+    }
+    AesCcm_encryptBlock(ctx, tag, tag);
+
+    /* Additional data, prefixed with its 2-byte length and zero padded */
+    if(aadLength)
+    {
+        tag[0] ^= (uint8_t)(aadLength >> 8);
+        tag[1] ^= (uint8_t)aadLength;
+        pos = 2;
+        for(i = 0; i < aadLength; i++)
+        {
+            tag[pos++] ^= aad[i];
+            if(pos == AES_CCM_BLOCK_SIZE)
+            {
+                AesCcm_encryptBlock(ctx, tag, tag);
+                pos = 0;
+            }
+        }
+        if(pos)
+            AesCcm_encryptBlock(ctx, tag, tag);
+    }
+
+    /* Payload, zero padded */
+    pos = 0;
+    for(i = 0; i < length; i++)
+    {
+        tag[pos++] ^= payload[i];
+        if(pos == AES_CCM_BLOCK_SIZE)
+        {
+            AesCcm_encryptBlock(ctx, tag, tag);
+            pos = 0;
+        }
+    }
+    if(pos)
+        AesCcm_encryptBlock(ctx, tag, tag);
+}
+
+/**
+  * @brief  Apply the CTR key stream, starting with counter 1.
+  * @param ctx : context with the expanded key.
+  * @param nonce : nonce.
+  * @param nonceLength : nonce length.
+  * @param input : input data.
+  * @param output : output data, may equal input.
+  * @param length : data length.
+  * @return none
+  */
+static void AesCcm_ctr(const AesCcmContext *ctx, const uint8_t *nonce, uint8_t nonceLength,
+                       const uint8_t *input, uint8_t *output, size_t length)
+{
+    uint8_t stream[AES_CCM_BLOCK_SIZE];
+    uint32_t counter = 1;
+    size_t i;
+
+    for(i = 0; i < length; i++)
+    {
+        if((i % AES_CCM_BLOCK_SIZE) == 0)
+        {
+            AesCcm_counterBlock(stream, nonce, nonceLength, counter++);
+            AesCcm_encryptBlock(ctx, stream, stream);
+        }
+        output[i] = input[i] ^ stream[i % AES_CCM_BLOCK_SIZE];
+    }
+    memset(stream, 0, sizeof(stream));
+}
+
+/**
+  * @brief  Encrypt the tag with counter block 0.
+  * @param ctx : context with the expanded key.
+  * @param nonce : nonce.
+  * @param nonceLength : nonce length.
+  * @param tag : tag, encrypted in place.
+  * @return none
+  */
+static void AesCcm_encryptTag(const AesCcmContext *ctx, const uint8_t *nonce, uint8_t nonceLength, uint8_t *tag)
+{
+    uint8_t stream[AES_CCM_BLOCK_SIZE];
+    uint8_t i;
+
+    AesCcm_counterBlock(stream, nonce, nonceLength, 0);
+    AesCcm_encryptBlock(ctx, stream, stream);
+    for(i = 0; i < AES_CCM_BLOCK_SIZE; i++)
+    {
+        tag[i] ^= stream[i];
+    }
+    memset(stream, 0, sizeof(stream));
+}
+
+/**
+  * @brief  CCM authenticated encryption.
+  * @param ctx : context with the expanded key.
+  * @param nonce : nonce, AES_CCM_NONCE_MIN ~ AES_CCM_NONCE_MAX bytes.
+  * @param nonceLength : nonce length.
+  * @param aad : additional authenticated data, may be NULL when aadLength is 0.
+  * @param aadLength : additional data length.
+  * @param input : plaintext.
+  * @param output : output, ciphertext, may equal input.
+  * @param length : plaintext length.
+  * @param mac : output, MAC.
+  * @param macLength : MAC length, even, AES_CCM_MAC_MIN ~ AES_CCM_MAC_MAX.
+  * @return true when success
+  */
+bool AesCcm_encrypt(const AesCcmContext *ctx,
+                    const uint8_t *nonce, uint8_t nonceLength,
+                    const uint8_t *aad, size_t aadLength,
+                    const uint8_t *input, uint8_t *output, size_t length,
+                    uint8_t *mac, uint8_t macLength)
+{
+    uint8_t tag[AES_CCM_BLOCK_SIZE];
+
+    if(!AesCcm_checkParams(nonceLength, aadLength, length, macLength))
+        return false;
+
+    AesCcm_cbcMac(ctx, nonce, nonceLength, aad, aadLength, input, length, macLength, tag);
+    AesCcm_encryptTag(ctx, nonce, nonceLength, tag);
+    AesCcm_ctr(ctx, nonce, nonceLength, input, output, length);
+    memcpy(mac, tag, macLength);
+    memset(tag, 0, sizeof(tag));
+    return true;
+}
+
+/**
+  * @brief  CCM authenticated decryption. The output is wiped when the MAC
+  *         doesn't match.
+  * @param ctx : context with the expanded key.
+  * @param nonce : nonce, AES_CCM_NONCE_MIN ~ AES_CCM_NONCE_MAX bytes.
+  * @param nonceLength : nonce length.
+  * @param aad : additional authenticated data, may be NULL when aadLength is 0.
+  * @param aadLength : additional data length.
+  * @param input : ciphertext.
+  * @param output : output, plaintext, may equal input.
+  * @param length : ciphertext length.
+  * @param mac : received MAC.
+  * @param macLength : MAC length.
+  * @return true when the MAC is valid
+  */
+bool AesCcm_decrypt(const AesCcmContext *ctx,
+                    const uint8_t *nonce, uint8_t nonceLength,
+                    const uint8_t *aad, size_t aadLength,
+                    const uint8_t *input, uint8_t *output, size_t length,
+                    const uint8_t *mac, uint8_t macLength)
+{
+    uint8_t tag[AES_CCM_BLOCK_SIZE];
+    uint8_t diff = 0;
+    uint8_t i;
+
+    if(!AesCcm_checkParams(nonceLength, aadLength, length, macLength))
+        return false;
+
+    AesCcm_ctr(ctx, nonce, nonceLength, input, output, length);
+    AesCcm_cbcMac(ctx, nonce, nonceLength, aad, aadLength, output, length, macLength, tag);
+    AesCcm_encryptTag(ctx, nonce, nonceLength, tag);
+
+    /* Constant time compare */
+    for(i = 0; i < macLength; i++)
+    {
+        diff |= tag[i] ^ mac[i];
+    }
+    memset(tag, 0, sizeof(tag));
+
+    if(diff)
+    {
+        memset(output, 0, length);
+        return false;
+    }
+    return true;
+}
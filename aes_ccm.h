@@ -0,0 +1,53 @@
+#ifndef _AES_CCM_H_
+#define _AES_CCM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define AES_CCM_KEY_SIZE        16      //AES-128
+#define AES_CCM_BLOCK_SIZE      16
+
+#define AES_CCM_NONCE_MIN       7
+#define AES_CCM_NONCE_MAX       13
+#define AES_CCM_MAC_MIN         4
+#define AES_CCM_MAC_MAX         16
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct _aesCcmContext {
+    uint8_t roundKey[AES_CCM_BLOCK_SIZE * 11];
+} AesCcmContext;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void AesCcm_setKey(AesCcmContext *ctx, const uint8_t *key);
+extern void AesCcm_encryptBlock(const AesCcmContext *ctx, const uint8_t *input, uint8_t *output);
+extern bool AesCcm_encrypt(const AesCcmContext *ctx,
+                           const uint8_t *nonce, uint8_t nonceLength,
+                           const uint8_t *aad, size_t aadLength,
+                           const uint8_t *input, uint8_t *output, size_t length,
+                           uint8_t *mac, uint8_t macLength);
+extern bool AesCcm_decrypt(const AesCcmContext *ctx,
+                           const uint8_t *nonce, uint8_t nonceLength,
+                           const uint8_t *aad, size_t aadLength,
+                           const uint8_t *input, uint8_t *output, size_t length,
+                           const uint8_t *mac, uint8_t macLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_AES_CCM_H_
@@ -0,0 +1,754 @@
+/*
+ *  ======== battery.c ========
+ *  Battery monitor.
+ *
+ *  The battery rail is sampled in blocks by ADCBuf: the conversions are
+ *  timed by a GPTimer and moved to RAM by uDMA, and the completion
+ *  callback filters the block and caches the result with its time. New
+ *  blocks are taken when convenient, after a motor move or from the idle
+ *  main loop once the value is BATTERY_REFRESH_MS old, so reading the
+ *  battery voltage is normally a lookup of the latest value. Only a
+ *  caller that needs a fresher value than the cached one waits for a
+ *  conversion.
+ *
+ *  The divider feeding the ADC is switched on by BAT_CTRL only around a
+ *  measurement: a block starts BATTERY_SETTLE_MS after the divider is
+ *  enabled, timed by a Clock, and the divider is disabled again from the
+ *  completion callback.
+ *
+ *  During a motor move ADCBuf is reopened in continuous mode to record the
+ *  rail at BATTERY_SAG_FREQ_HZ (sag capture). The recording ends
+ *  BATTERY_SAG_TAIL_MS after the end switch edge, then the task reduces it
+ *  to the minimum voltage, the time to minimum and the recovery time.
+ *
+ *  With BATTERY_ADC_SOFTWARE (MOTOR_PWM builds, whose motor PWM takes the
+ *  GPTimer that triggers ADCBuf) the ADC driver converts by software: a
+ *  periodic Clock takes one polled conversion per tick, at
+ *  BATTERY_SAMPLE_FREQ_HZ for a block and at BATTERY_SAG_FREQ_HZ for the
+ *  sag capture. A conversion holds the Clock Swi for BATTERY_SAMPLING_US,
+ *  so a block is spread over ticks rather than taken in one callback.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/drivers/PIN.h>
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "util.h"
+#include "trace.h"
+#include "filter.h"
+#include "tlog.h"
+#include "battery.h"
+
+#ifdef BATTERY_ADC_SOFTWARE
+#include <ti/drivers/ADC.h>
+#else
+#include <ti/drivers/ADCBuf.h>
+#include <ti/drivers/adcbuf/ADCBufCC26X2.h>
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BATTERY_SAG_NO_STOP         0xFFFF
+#define BATTERY_SAG_TAIL_SAMPLES    (BATTERY_SAG_TAIL_MS * BATTERY_SAG_FREQ_HZ / 1000)
+
+#ifdef BATTERY_ADC_SOFTWARE
+/* Sample periods are whole Clock periods of Util_constructClock() */
+#if (1000 % BATTERY_SAMPLE_FREQ_HZ) || (1000 % BATTERY_SAG_FREQ_HZ)
+#error "BATTERY_SAMPLE_FREQ_HZ and BATTERY_SAG_FREQ_HZ must divide 1000 with BATTERY_ADC_SOFTWARE"
+#endif
+#endif
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static PIN_Config batteryDividerPinTable[] = {
+    Board_DIO13_BAT_CTRL | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
+    PIN_DRVSTR_MAX,
+    PIN_TERMINATE
+};
+
+static PIN_Handle batteryDividerPinHandle = NULL;
+static PIN_State batteryDividerPinState;
+
+static Clock_Struct batterySettleClockStruct;
+
+#ifdef BATTERY_ADC_SOFTWARE
+static ADC_Handle batteryAdc = NULL;
+static Clock_Struct batteryBlockClockStruct;
+static Clock_Struct batterySagClockStruct;
+static uint16_t batteryBlockCount;      //samples of the block taken
+#else
+static ADCBuf_Handle batteryAdc = NULL;
+static ADCBuf_Conversion batteryConversion;
+/* Same acquisition time as the ADC7 board entry, for the divider output */
+static ADCBufCC26X2_ParamsExtension batteryAdcParams = {
+    .samplingDuration = ADCBufCC26X2_SAMPLING_DURATION_341_US,
+    .samplingMode = ADCBufCC26X2_SAMPING_MODE_SYNCHRONOUS,
+    .refSource = ADCBufCC26X2_FIXED_REFERENCE,
+    .inputScalingEnabled = true,
+};
+#endif
+static uint16_t batterySamples[BATTERY_BLOCK_SAMPLES];
+
+static Semaphore_Struct batteryDoneSemStruct;
+static Semaphore_Handle batteryDoneSem;     //posted when a block ends
+
+static volatile bool batteryBusy;       //block being sampled
+static volatile bool batteryValid;      //at least one block done
+static volatile uint16_t batteryRaw;
+static volatile uint32_t batteryMicroVolt;
+static volatile uint32_t batteryTick;   //Clock tick of the latest block
+
+/* Sag capture */
+#ifndef BATTERY_ADC_SOFTWARE
+static ADCBuf_Conversion batterySagConversion;
+static uint16_t batterySagBlock[2][BATTERY_SAG_BLOCK];
+#endif
+static uint16_t batterySagSamples[BATTERY_SAG_SAMPLES];
+static volatile bool batterySagActive;  //capture owns the ADC
+static volatile bool batterySagDone;    //recording complete
+static volatile uint16_t batterySagCount;
+static volatile uint16_t batterySagStopIndex;
+static uint16_t batterySagBaseline;
+static bool batterySagValid;
+static BatterySag batterySag;
+
+/**
+  * @brief  Switch the battery divider.
+  * @param on : true to connect the divider.
+  * @return none
+  */
+static void Battery_divider(bool on)
+{
+    if(batteryDividerPinHandle)
+        PIN_setOutputValue(batteryDividerPinHandle, Board_DIO13_BAT_CTRL, on ? BATTERY_DIVIDER_ON : !BATTERY_DIVIDER_ON);
+}
+
+/**
+  * @brief  Convert an ADC value to micro volt.
+  * @param value : ADC value, raw with BATTERY_ADC_SOFTWARE, adjusted
+  *                otherwise.
+  * @return micro volt
+  */
+static uint32_t Battery_toMicroVolt(uint16_t value)
+{
+#ifdef BATTERY_ADC_SOFTWARE
+    return ADC_convertRawToMicroVolts(batteryAdc, value);
+#else
+    uint32_t microVolt = 0;
+
+    ADCBuf_convertAdjustedToMicroVolts(batteryAdc, Board_ADCBUF_BATTERY_CHANNEL, &value, &microVolt, 1);
+    return microVolt;
+#endif
+}
+
+/**
+  * @brief  A block is sampled: filter it and cache the result, then switch
+  *         the divider off.
+  * @param samples : BATTERY_BLOCK_SAMPLES samples, NULL when it failed.
+  * @return none
+  */
+static void Battery_blockDone(uint16_t *samples)
+{
+    uint16_t average;
+    uint32_t microVolt;
+
+    if(samples != NULL)
+    {
+        /* Settling samples skipped, outliers trimmed */
+        average = Filter_trimmedMean(samples + BATTERY_SKIP_SAMPLES, BATTERY_BLOCK_SAMPLES - BATTERY_SKIP_SAMPLES,
+                                     BATTERY_TRIM_SAMPLES);
+        microVolt = Battery_toMicroVolt(average);
+
+        batteryRaw = average;
+        batteryMicroVolt = microVolt;
+        batteryTick = Clock_getTicks();
+        batteryValid = true;
+        Trace_log(TRACE_BATTERY, (uint16_t)(microVolt / 1000));
+    }
+    Battery_divider(false);
+    batteryBusy = false;
+    Semaphore_post(batteryDoneSem);
+}
+
+/**
+  * @brief  Append samples to the sag recording, ends it once full or
+  *         BATTERY_SAG_TAIL_MS after the switch edge.
+  * @param samples : samples.
+  * @param n : number of samples.
+  * @return none
+  */
+static void Battery_sagAppend(const uint16_t *samples, uint16_t n)
+{
+    uint16_t count = batterySagCount;
+    uint16_t i;
+
+    for(i = 0; (i < n) && (count < BATTERY_SAG_SAMPLES); i++)
+    {
+        batterySagSamples[count++] = samples[i];
+    }
+    batterySagCount = count;
+
+    if((count >= BATTERY_SAG_SAMPLES) ||
+       ((batterySagStopIndex != BATTERY_SAG_NO_STOP) && (count >= batterySagStopIndex + BATTERY_SAG_TAIL_SAMPLES)))
+        batterySagDone = true;
+}
+
+#ifdef BATTERY_ADC_SOFTWARE
+/**
+  * @brief  Block CLOCK callback function, takes one sample of the block
+  *         and ends it once complete.
+  * @param arg0: input parameter for block CLOCK callback function
+  * @return none
+  */
+static void Battery_blockTickFxn(UArg arg0)
+{
+    /* The sag capture took the ADC over meanwhile */
+    if(!batteryBusy || batterySagActive)
+    {
+        Util_stopClock(&batteryBlockClockStruct);
+        return;
+    }
+
+    if(ADC_convert(batteryAdc, &batterySamples[batteryBlockCount]) != ADC_STATUS_SUCCESS)
+    {
+        Util_stopClock(&batteryBlockClockStruct);
+        Battery_blockDone(NULL);
+        return;
+    }
+    if(++batteryBlockCount >= BATTERY_BLOCK_SAMPLES)
+    {
+        Util_stopClock(&batteryBlockClockStruct);
+        Battery_blockDone(batterySamples);
+    }
+}
+
+/**
+  * @brief  Sag capture CLOCK callback function, takes one sample. The
+  *         conversion fits the period, so the capture runs at
+  *         BATTERY_SAG_FREQ_HZ.
+  * @param arg0: input parameter for sag CLOCK callback function
+  * @return none
+  */
+static void Battery_sagTickFxn(UArg arg0)
+{
+    uint16_t value;
+
+    if(batterySagDone)
+        return;
+    if(ADC_convert(batteryAdc, &value) == ADC_STATUS_SUCCESS)
+        Battery_sagAppend(&value, 1);
+}
+
+/**
+  * @brief  Open the ADC driver, kept open for both the blocks and the sag
+  *         capture. Conversions are polled and unprotected so that they
+  *         can run from Clock callbacks.
+  * @param sag : unused, there's no separate sag mode.
+  * @return true when success
+  */
+static bool Battery_open(bool sag)
+{
+    ADC_Params params;
+
+    if(batteryAdc != NULL)
+        return true;
+
+    ADC_Params_init(&params);
+    params.isProtected = false;
+    batteryAdc = ADC_open(Board_POWER_ADC, &params);
+    if(batteryAdc == NULL)
+        TLOG0(TLOG_BATTERY_ADC_FAILED);
+    return (batteryAdc != NULL);
+}
+
+/**
+  * @brief  Stop the sampling in progress.
+  * @param none
+  * @return none
+  */
+static void Battery_close(void)
+{
+    Util_stopClock(&batteryBlockClockStruct);
+    Util_stopClock(&batterySagClockStruct);
+}
+
+/**
+  * @brief  Start a block, one sample per tick of the block Clock.
+  * @param none
+  * @return true when started
+  */
+static bool Battery_startBlock(void)
+{
+    batteryBlockCount = 0;
+    Util_startClock(&batteryBlockClockStruct);
+    return true;
+}
+
+/**
+  * @brief  Start the sag recording.
+  * @param none
+  * @return true when started
+  */
+static bool Battery_startSag(void)
+{
+    Util_startClock(&batterySagClockStruct);
+    return true;
+}
+#else
+
+/**
+  * @brief  ADCBuf conversion done callback.
+  * @param handle : ADCBuf handle.
+  * @param conversion : finished conversion.
+  * @param completedADCBuffer : samples.
+  * @param completedChannel : ADC channel.
+  * @param status : conversion status.
+  * @return none
+  */
+static void Battery_adcFxn(ADCBuf_Handle handle, ADCBuf_Conversion *conversion,
+                           void *completedADCBuffer, uint32_t completedChannel, int_fast16_t status)
+{
+    uint16_t *samples = (uint16_t *)completedADCBuffer;
+
+    if(status != ADCBuf_STATUS_SUCCESS)
+    {
+        Battery_blockDone(NULL);
+        return;
+    }
+    ADCBuf_adjustRawValues(handle, samples, BATTERY_BLOCK_SAMPLES, completedChannel);
+    Battery_blockDone(samples);
+}
+
+/**
+  * @brief  ADCBuf sag capture callback, one half of the ping-pong buffer
+  *         is complete.
+  * @param handle : ADCBuf handle.
+  * @param conversion : running conversion.
+  * @param completedADCBuffer : samples.
+  * @param completedChannel : ADC channel.
+  * @param status : conversion status.
+  * @return none
+  */
+static void Battery_sagFxn(ADCBuf_Handle handle, ADCBuf_Conversion *conversion,
+                           void *completedADCBuffer, uint32_t completedChannel, int_fast16_t status)
+{
+    uint16_t *samples = (uint16_t *)completedADCBuffer;
+
+    if((status != ADCBuf_STATUS_SUCCESS) || batterySagDone)
+        return;
+
+    ADCBuf_adjustRawValues(handle, samples, BATTERY_SAG_BLOCK, completedChannel);
+    Battery_sagAppend(samples, BATTERY_SAG_BLOCK);
+}
+
+/**
+  * @brief  Open ADCBuf for one shot blocks or for the sag capture.
+  * @param sag : true for the continuous sag capture.
+  * @return true when success
+  */
+static bool Battery_open(bool sag)
+{
+    ADCBuf_Params params;
+
+    ADCBuf_Params_init(&params);
+    params.returnMode = ADCBuf_RETURN_MODE_CALLBACK;
+    params.custom = &batteryAdcParams;
+    if(sag)
+    {
+        params.recurrenceMode = ADCBuf_RECURRENCE_MODE_CONTINUOUS;
+        params.callbackFxn = Battery_sagFxn;
+        params.samplingFrequency = BATTERY_SAG_FREQ_HZ;
+    }
+    else
+    {
+        params.recurrenceMode = ADCBuf_RECURRENCE_MODE_ONE_SHOT;
+        params.callbackFxn = Battery_adcFxn;
+        params.samplingFrequency = BATTERY_SAMPLE_FREQ_HZ;
+    }
+    batteryAdc = ADCBuf_open(Board_ADCBUF_BATTERY, &params);
+    if(batteryAdc == NULL)
+        TLOG0(TLOG_BATTERY_ADC_FAILED);
+    return (batteryAdc != NULL);
+}
+
+/**
+  * @brief  Cancel the conversion in progress and close ADCBuf.
+  * @param none
+  * @return none
+  */
+static void Battery_close(void)
+{
+    if(batteryAdc)
+    {
+        ADCBuf_convertCancel(batteryAdc);
+        ADCBuf_close(batteryAdc);
+        batteryAdc = NULL;
+    }
+}
+
+/**
+  * @brief  Start a one shot block, the callback ends it.
+  * @param none
+  * @return true when started
+  */
+static bool Battery_startBlock(void)
+{
+    return (ADCBuf_convert(batteryAdc, &batteryConversion, 1) == ADCBuf_STATUS_SUCCESS);
+}
+
+/**
+  * @brief  Start the continuous sag recording.
+  * @param none
+  * @return true when started
+  */
+static bool Battery_startSag(void)
+{
+    return (ADCBuf_convert(batteryAdc, &batterySagConversion, 1) == ADCBuf_STATUS_SUCCESS);
+}
+#endif
+
+/**
+  * @brief  Divider settle CLOCK callback function, starts the block.
+  * @param arg0: input parameter for battery CLOCK callback function
+  * @return none
+  */
+static void Battery_settleFxn(UArg arg0)
+{
+    /* The sag capture took the ADC over meanwhile */
+    if(!batteryBusy || batterySagActive)
+        return;
+
+    if(!Battery_startBlock())
+        Battery_blockDone(NULL);
+}
+
+/**
+  * @brief  Initialize battery monitor and start the first measurement.
+  * @param none
+  * @return true when success
+  */
+bool Battery_init(void)
+{
+    Semaphore_Params semParams;
+
+    Semaphore_Params_init(&semParams);
+    semParams.mode = Semaphore_Mode_BINARY;
+    Semaphore_construct(&batteryDoneSemStruct, 0, &semParams);
+    batteryDoneSem = Semaphore_handle(&batteryDoneSemStruct);
+
+    Util_constructClock(&batterySettleClockStruct, Battery_settleFxn, BATTERY_SETTLE_MS, 0, false, 0);
+#ifdef BATTERY_ADC_SOFTWARE
+    Util_constructClock(&batteryBlockClockStruct, Battery_blockTickFxn, 1000 / BATTERY_SAMPLE_FREQ_HZ,
+                        1000 / BATTERY_SAMPLE_FREQ_HZ, false, 0);
+    Util_constructClock(&batterySagClockStruct, Battery_sagTickFxn, 1000 / BATTERY_SAG_FREQ_HZ,
+                        1000 / BATTERY_SAG_FREQ_HZ, false, 0);
+#endif
+
+    batteryDividerPinHandle = PIN_open(&batteryDividerPinState, batteryDividerPinTable);
+    if(!batteryDividerPinHandle)
+        TLOG0(TLOG_BATTERY_CTRL_FAILED);
+
+    batteryBusy = false;
+    batteryValid = false;
+    batteryRaw = 0;
+    batteryMicroVolt = 0;
+    batterySagActive = false;
+    batterySagValid = false;
+
+#ifndef BATTERY_ADC_SOFTWARE
+    batteryConversion.adcChannel = Board_ADCBUF_BATTERY_CHANNEL;
+    batteryConversion.sampleBuffer = batterySamples;
+    batteryConversion.sampleBufferTwo = NULL;
+    batteryConversion.samplesRequestedCount = BATTERY_BLOCK_SAMPLES;
+    batteryConversion.arg = NULL;
+
+    batterySagConversion.adcChannel = Board_ADCBUF_BATTERY_CHANNEL;
+    batterySagConversion.sampleBuffer = batterySagBlock[0];
+    batterySagConversion.sampleBufferTwo = batterySagBlock[1];
+    batterySagConversion.samplesRequestedCount = BATTERY_SAG_BLOCK;
+    batterySagConversion.arg = NULL;
+#endif
+
+    if(!Battery_open(false))
+        return false;
+
+    return Battery_refresh();
+}
+
+/**
+  * @brief  Start a measurement in the background. Can be called from any
+  *         context.
+  * @param none
+  * @return true when started or already running
+  */
+bool Battery_refresh(void)
+{
+    UInt key;
+
+    if(batteryAdc == NULL)
+        return false;
+
+    key = Hwi_disable();
+    /* The sag capture owns the ADC, it refreshes the value when it ends */
+    if(batteryBusy || batterySagActive)
+    {
+        Hwi_restore(key);
+        return true;
+    }
+    batteryBusy = true;
+    Hwi_restore(key);
+
+    /* The block starts once the divider output settled */
+    Battery_divider(true);
+    Util_startClock(&batterySettleClockStruct);
+    return true;
+}
+
+/**
+  * @brief  Refresh the measurement when it's BATTERY_REFRESH_MS old, called
+  *         when the system is idle.
+  * @param none
+  * @return none
+  */
+void Battery_idle(void)
+{
+    if(Battery_getAgeMs() >= BATTERY_REFRESH_MS)
+        Battery_refresh();
+}
+
+/**
+  * @brief  Get the battery voltage, a new measurement is only waited for
+  *         when the cached one is older than maxAgeMs. Task context only
+  *         when it may wait.
+  * @param maxAgeMs : oldest acceptable measurement, BATTERY_AGE_ANY to
+  *                   never wait.
+  * @param microVolt : output battery micro volt, may be NULL.
+  * @param ageMs : output age of the measurement, may be NULL.
+  * @return true when the measurement is valid and not older than maxAgeMs
+  */
+bool Battery_get(uint32_t maxAgeMs, uint32_t *microVolt, uint32_t *ageMs)
+{
+    uint32_t age = Battery_getAgeMs();
+
+    if((age > maxAgeMs) && !batterySagActive)
+    {
+        /* Drop the post of a block that ended earlier */
+        Semaphore_pend(batteryDoneSem, BIOS_NO_WAIT);
+        if(Battery_refresh())
+            Semaphore_pend(batteryDoneSem, BATTERY_WAIT_MS * (1000 / Clock_tickPeriod));
+        age = Battery_getAgeMs();
+    }
+
+    if(microVolt != NULL)
+        *microVolt = batteryMicroVolt;
+    if(ageMs != NULL)
+        *ageMs = age;
+    return batteryValid && (age <= maxAgeMs);
+}
+
+/**
+  * @brief  Age of the latest measurement.
+  * @param none
+  * @return ms, BATTERY_AGE_ANY when there's none
+  */
+uint32_t Battery_getAgeMs(void)
+{
+    if(!batteryValid)
+        return BATTERY_AGE_ANY;
+    return (Clock_getTicks() - batteryTick) / (1000 / Clock_tickPeriod);
+}
+
+/**
+  * @brief  Check whether a measurement is available.
+  * @param none
+  * @return true when Battery_getRaw() and Battery_getMicroVolt() are valid
+  */
+bool Battery_isValid(void)
+{
+    return batteryValid;
+}
+
+/**
+  * @brief  Latest battery ADC value.
+  * @param none
+  * @return averaged ADC value
+  */
+uint16_t Battery_getRaw(void)
+{
+    return batteryRaw;
+}
+
+/**
+  * @brief  Latest battery voltage.
+  * @param none
+  * @return micro volt
+  */
+uint32_t Battery_getMicroVolt(void)
+{
+    return batteryMicroVolt;
+}
+
+/**
+  * @brief  Start the sag capture, called right before the motor starts.
+  *         Task context only.
+  * @param none
+  * @return true when started
+  */
+bool Battery_sagStart(void)
+{
+    UInt key;
+
+    if(batteryAdc == NULL)
+        return false;
+
+    /* The previous capture hasn't been processed yet */
+    if(batterySagActive)
+        Battery_sagProcess();
+    if(batterySagActive)
+        return false;
+
+    key = Hwi_disable();
+    batterySagActive = true;
+    Hwi_restore(key);
+
+    /* Drop a block being sampled, the capture gives a fresh value */
+    Util_stopClock(&batterySettleClockStruct);
+    Battery_close();
+    batteryBusy = false;
+
+    /* The divider stays on for the whole capture, let it settle before the motor starts */
+    Battery_divider(true);
+    Task_sleep(BATTERY_SETTLE_MS * (1000 / Clock_tickPeriod));
+
+    batterySagBaseline = batteryRaw;
+    batterySagCount = 0;
+    batterySagStopIndex = BATTERY_SAG_NO_STOP;
+    batterySagDone = false;
+
+    if(!Battery_open(true) || !Battery_startSag())
+    {
+        batterySagDone = true;
+    }
+    return !batterySagDone;
+}
+
+/**
+  * @brief  Mark the end of the motor load (end switch edge). The capture
+  *         goes on for BATTERY_SAG_TAIL_MS. Can be called from any context.
+  * @param none
+  * @return none
+  */
+void Battery_sagStop(void)
+{
+    UInt key;
+
+    key = Hwi_disable();
+    if(batterySagActive && (batterySagStopIndex == BATTERY_SAG_NO_STOP))
+        batterySagStopIndex = batterySagCount;
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Finish a completed sag capture: the ADC goes back to one shot
+  *         blocks and the recording is reduced. Task context only.
+  * @param none
+  * @return true when a new result is available
+  */
+bool Battery_sagProcess(void)
+{
+    uint16_t count;
+    uint16_t minIndex = 0;
+    uint16_t minValue = 0xFFFF;
+    uint32_t threshold;
+    uint16_t i;
+
+    if(!batterySagActive || !batterySagDone)
+        return false;
+
+    Battery_close();
+    Battery_divider(false);
+    batterySagActive = false;
+    if(!Battery_open(false))
+        return false;
+
+    count = batterySagCount;
+    if(count == 0)
+    {
+        Battery_refresh();
+        return false;
+    }
+
+    for(i = 0; i < count; i++)
+    {
+        if(batterySagSamples[i] < minValue)
+        {
+            minValue = batterySagSamples[i];
+            minIndex = i;
+        }
+    }
+
+    threshold = (uint32_t)batterySagBaseline * BATTERY_SAG_RECOVERY_PERMILLE / 1000;
+    batterySag.recoveryMs = BATTERY_SAG_NOT_RECOVERED;
+    for(i = minIndex; i < count; i++)
+    {
+        if(batterySagSamples[i] >= threshold)
+        {
+            batterySag.recoveryMs = (uint32_t)(i - minIndex) * 1000 / BATTERY_SAG_FREQ_HZ;
+            break;
+        }
+    }
+
+    batterySag.baselineMicroVolt = Battery_toMicroVolt(batterySagBaseline);
+    batterySag.minMicroVolt = Battery_toMicroVolt(minValue);
+    batterySag.timeToMinMs = (uint32_t)minIndex * 1000 / BATTERY_SAG_FREQ_HZ;
+    batterySag.loadMs = (uint32_t)((batterySagStopIndex == BATTERY_SAG_NO_STOP) ? count : batterySagStopIndex) *
+                        1000 / BATTERY_SAG_FREQ_HZ;
+    batterySag.samples = count;
+    batterySagValid = true;
+
+    TLOG3(TLOG_BATTERY_SAG, batterySag.baselineMicroVolt, batterySag.minMicroVolt, batterySag.timeToMinMs);
+    TLOG2(TLOG_BATTERY_SAG_TIME, batterySag.recoveryMs, batterySag.loadMs);
+
+    Battery_refresh();
+    return true;
+}
+
+/**
+  * @brief  Result of the last sag capture.
+  * @param sag : output result.
+  * @return true when a result is available
+  */
+bool Battery_getSag(BatterySag *sag)
+{
+    if(!batterySagValid)
+        return false;
+
+    *sag = batterySag;
+    return true;
+}
+
+/**
+  * @brief  Samples of the last sag capture, ADC values at
+  *         BATTERY_SAG_FREQ_HZ (raw with BATTERY_ADC_SOFTWARE, adjusted
+  *         otherwise). Valid until the next capture starts.
+  * @param count : output number of samples.
+  * @return samples
+  */
+const uint16_t *Battery_getSagSamples(uint16_t *count)
+{
+    *count = batterySagValid ? batterySag.samples : 0;
+    return batterySagSamples;
+}
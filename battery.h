@@ -0,0 +1,117 @@
+#ifndef _BATTERY_H_
+#define _BATTERY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* The motor PWM takes GPTimer 0A, the ADCBuf trigger, so MOTOR_PWM builds
+   start the conversions by software through the ADC driver */
+#ifdef MOTOR_PWM
+#define BATTERY_ADC_SOFTWARE
+#endif
+
+/* One measurement is a block of samples, the first ones are dropped while
+   the sample and hold input settles */
+#define BATTERY_BLOCK_SAMPLES       20
+#define BATTERY_SKIP_SAMPLES        4
+/* Lowest and highest samples of a block dropped from the average */
+#define BATTERY_TRIM_SAMPLES        2
+#define BATTERY_SAMPLE_FREQ_HZ      1000
+#define BATTERY_BLOCK_MS            (BATTERY_BLOCK_SAMPLES * 1000 / BATTERY_SAMPLE_FREQ_HZ)
+
+/* Acquisition time of each sample, the ADC7 entry of the board file
+   (Board_POWER_ADC) and the ADCBuf parameters use the same. The divider
+   output is a high impedance source: the sample and hold capacitor must
+   charge to 1/2 LSB of 12 bits (9 time constants) through it, which this
+   time covers up to BATTERY_SOURCE_MAX_KOHM into BATTERY_HOLD_PF */
+#define BATTERY_SAMPLING_US         341
+#define BATTERY_SOURCE_MAX_KOHM     1000
+#define BATTERY_HOLD_PF             15
+
+#if 9 * BATTERY_SOURCE_MAX_KOHM * BATTERY_HOLD_PF / 1000 > BATTERY_SAMPLING_US
+#error "BATTERY_SAMPLING_US too short for the divider output impedance"
+#endif
+
+/* The polled conversions of BATTERY_ADC_SOFTWARE run in a Clock callback,
+   one per sample period: they may hold it for half the period at most */
+#if 2 * BATTERY_SAMPLING_US > 1000000 / BATTERY_SAMPLE_FREQ_HZ
+#error "BATTERY_SAMPLING_US too long for BATTERY_SAMPLE_FREQ_HZ"
+#endif
+
+/* The idle loop refreshes the measurement once it's this old */
+#define BATTERY_REFRESH_MS          60000
+
+/* Age of a measurement good enough before a motor move */
+#define BATTERY_MAX_AGE_MS          (2 * BATTERY_REFRESH_MS)
+
+/* No measurement, or any age accepted */
+#define BATTERY_AGE_ANY             0xFFFFFFFF
+
+/* BAT_CTRL level connecting the divider, and the time its output takes
+   to settle (RC of the divider and the sample and hold input) */
+#define BATTERY_DIVIDER_ON          1
+#define BATTERY_SETTLE_MS           5
+
+/* Longest wait for a forced measurement: settling, then a block, plus a
+   margin for the Clock ticks and the conversion of the last sample */
+#define BATTERY_WAIT_MS             (BATTERY_SETTLE_MS + BATTERY_BLOCK_MS + 10)
+
+/* Sag capture during a motor move: the rail is recorded at
+   BATTERY_SAG_FREQ_HZ until BATTERY_SAG_TAIL_MS after the switch edge */
+#define BATTERY_SAG_FREQ_HZ         1000
+#define BATTERY_SAG_SAMPLES         2048
+#define BATTERY_SAG_BLOCK           16
+#define BATTERY_SAG_TAIL_MS         600
+
+#if 2 * BATTERY_SAMPLING_US > 1000000 / BATTERY_SAG_FREQ_HZ
+#error "BATTERY_SAMPLING_US too long for BATTERY_SAG_FREQ_HZ"
+#endif
+
+/* The rail is recovered once back to this share (1/1000) of the level before the move */
+#define BATTERY_SAG_RECOVERY_PERMILLE   980
+#define BATTERY_SAG_NOT_RECOVERED       0xFFFF
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct _batterySag {
+    uint32_t baselineMicroVolt;     //before the move
+    uint32_t minMicroVolt;
+    uint16_t timeToMinMs;           //from motor start
+    uint16_t recoveryMs;            //from the minimum, BATTERY_SAG_NOT_RECOVERED when not seen
+    uint16_t loadMs;                //from motor start to the switch edge
+    uint16_t samples;
+} BatterySag;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern bool Battery_init(void);
+extern bool Battery_refresh(void);
+extern void Battery_idle(void);
+extern bool Battery_get(uint32_t maxAgeMs, uint32_t *microVolt, uint32_t *ageMs);
+extern uint32_t Battery_getAgeMs(void);
+extern bool Battery_isValid(void);
+extern uint16_t Battery_getRaw(void);
+extern uint32_t Battery_getMicroVolt(void);
+extern bool Battery_sagStart(void);
+extern void Battery_sagStop(void);
+extern bool Battery_sagProcess(void);
+extern bool Battery_getSag(BatterySag *sag);
+extern const uint16_t *Battery_getSagSamples(uint16_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_BATTERY_H_
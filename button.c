@@ -0,0 +1,281 @@
+/*
+ *  ======== button.c ========
+ *  Table driven button gesture engine.
+ *
+ *  A press edge interrupt starts a one-shot clock which samples all
+ *  buttons every BUTTON_POLL_MS and re-arms itself only while a button is
+ *  down or a click is waiting for its double click window, so there is no
+ *  periodic wakeup at idle. Recognized gestures are queued in a FIFO
+ *  (written by the clock Swi, read by the task) and drained with
+ *  Button_getEvent().
+ */
+
+#include <stdbool.h>
+
+/* XDC module Headers */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/drivers/PIN.h>
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "FIFO.h"
+#include "util.h"
+#include "button.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BUTTON_QUEUE_SIZE   16
+
+/* Queue entry: button index in the high nibble, event in the low nibble */
+#define BUTTON_QUEUE_ENTRY(index, event)    ((char)(((index) << 4) | (event)))
+#define BUTTON_QUEUE_INDEX(entry)           (((uint8_t)(entry)) >> 4)
+#define BUTTON_QUEUE_EVENT(entry)           ((ButtonEvent)((entry) & 0x0F))
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct _buttonState {
+    uint16_t heldMs;        //time the button has been down
+    uint16_t gapMs;         //time since the first click of a possible double click
+    uint16_t nextRepeatMs;  //heldMs of the next repeat event
+    bool pressed;           //press reported
+    bool longPressed;       //long press reported
+    bool chorded;           //part of a chord, no click/long press for this press
+    bool clickPending;      //click waiting for the double click window
+} ButtonState;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static const ButtonConfig *buttonConfig = NULL;
+static uint8_t buttonCount = 0;
+static ButtonState buttonState[BUTTON_MAX];
+static bool buttonChord;
+
+static PIN_Config buttonPinTable[BUTTON_MAX + 1];
+static PIN_Handle buttonPinHandle = NULL;
+static PIN_State buttonPinState;
+
+static Clock_Struct buttonClockStruct;
+
+static FIFO_Buf buttonFIFO;
+static char buttonFIFOStack[BUTTON_QUEUE_SIZE];
+
+/**
+  * @brief  Queue a button event for the task.
+  * @param index : button index or BUTTON_INDEX_CHORD.
+  * @param event : event to queue.
+  * @return none
+  */
+static void Button_post(uint8_t index, ButtonEvent event)
+{
+    if(!FIFOPutByte(&buttonFIFO, BUTTON_QUEUE_ENTRY(index, event)))
+    {
+#ifdef DEBUG
+        System_printf("button queue full\r\n");
+#endif
+    }
+}
+
+/**
+  * @brief  Run the gesture state machine of one button for one tick.
+  * @param index : button index.
+  * @param down : true when the button is down.
+  * @return true while the button needs more ticks
+  */
+static bool Button_step(uint8_t index, bool down)
+{
+    const ButtonConfig *config = &buttonConfig[index];
+    ButtonState *state = &buttonState[index];
+
+    if(down)
+    {
+        state->heldMs += BUTTON_POLL_MS;
+
+        if((!state->pressed) && (state->heldMs >= config->debounceMs))
+        {
+            state->pressed = true;
+            Button_post(index, BUTTON_EVENT_PRESS);
+        }
+
+        if(state->pressed && (!state->chorded))
+        {
+            if((!state->longPressed) && config->longPressMs && (state->heldMs >= config->longPressMs))
+            {
+                state->longPressed = true;
+                state->clickPending = false;
+                state->nextRepeatMs = config->longPressMs + config->repeatMs;
+                Button_post(index, BUTTON_EVENT_LONG_PRESS);
+            }
+            else if(state->longPressed && config->repeatMs && (state->heldMs >= state->nextRepeatMs))
+            {
+                state->nextRepeatMs += config->repeatMs;
+                Button_post(index, BUTTON_EVENT_REPEAT);
+            }
+        }
+        return true;
+    }
+
+    if(state->pressed)
+    {
+        Button_post(index, BUTTON_EVENT_RELEASE);
+        if((!state->longPressed) && (!state->chorded))
+        {
+            if(config->doubleClickMs == 0)
+            {
+                Button_post(index, BUTTON_EVENT_CLICK);
+            }
+            else if(state->clickPending)
+            {
+                state->clickPending = false;
+                Button_post(index, BUTTON_EVENT_DOUBLE_CLICK);
+            }
+            else
+            {
+                state->clickPending = true;
+                state->gapMs = 0;
+            }
+        }
+    }
+    state->heldMs = 0;
+    state->pressed = false;
+    state->longPressed = false;
+    state->chorded = false;
+
+    if(state->clickPending)
+    {
+        state->gapMs += BUTTON_POLL_MS;
+        if(state->gapMs > config->doubleClickMs)
+        {
+            state->clickPending = false;
+            Button_post(index, BUTTON_EVENT_CLICK);
+        }
+    }
+    return state->clickPending;
+}
+
+/**
+  * @brief  Button CLOCK callback function.
+  * @param arg0: input parameter for button CLOCK callback function
+  * @return none
+  */
+static void Button_clockFxn(UArg arg0)
+{
+    bool active = false;
+    bool allPressed = (buttonCount > 1);
+    uint8_t i;
+
+    for(i = 0; i < buttonCount; i++)
+    {
+        if(Button_step(i, !PIN_getInputValue(buttonConfig[i].pin)))
+            active = true;
+        if(!buttonState[i].pressed)
+            allPressed = false;
+    }
+
+    if(allPressed && (!buttonChord))
+    {
+        buttonChord = true;
+        for(i = 0; i < buttonCount; i++)
+        {
+            buttonState[i].chorded = true;
+            buttonState[i].clickPending = false;
+        }
+        Button_post(BUTTON_INDEX_CHORD, BUTTON_EVENT_CHORD);
+    }
+    else if(!allPressed)
+    {
+        buttonChord = false;
+    }
+
+    /* Keep polling while needed, otherwise wait for the next press edge */
+    if(active)
+        Util_startClock(&buttonClockStruct);
+}
+
+/**
+  * @brief  Button pin interrupt callback, starts the gesture engine on a press edge.
+  * @param handle : PIN handle.
+  * @param pinId : pin that generated the interrupt.
+  * @return none
+  */
+static void Button_intCallbackFxn(PIN_Handle handle, PIN_Id pinId)
+{
+    if(!Util_isActive(&buttonClockStruct))
+        Util_startClock(&buttonClockStruct);
+}
+
+/**
+  * @brief  Initialize button pins and gesture engine.
+  * @param config : per button configuration table, must stay valid.
+  * @param count : number of buttons in the table (max BUTTON_MAX).
+  * @return true when success
+  */
+bool Button_init(const ButtonConfig *config, uint8_t count)
+{
+    uint8_t i;
+
+    if((config == NULL) || (count == 0) || (count > BUTTON_MAX))
+        return false;
+
+    buttonConfig = config;
+    buttonCount = count;
+    buttonChord = false;
+    for(i = 0; i < count; i++)
+    {
+        buttonState[i].heldMs = 0;
+        buttonState[i].gapMs = 0;
+        buttonState[i].pressed = false;
+        buttonState[i].longPressed = false;
+        buttonState[i].chorded = false;
+        buttonState[i].clickPending = false;
+        buttonPinTable[i] = config[i].pin | PIN_INPUT_EN | PIN_PULLUP | PIN_IRQ_NEGEDGE;
+    }
+    buttonPinTable[count] = PIN_TERMINATE;
+
+    InitialFIFO(BUTTON_QUEUE_SIZE, buttonFIFOStack, &buttonFIFO);
+    Util_constructClock(&buttonClockStruct, Button_clockFxn, BUTTON_POLL_MS, 0, false, 0);
+
+    buttonPinHandle = PIN_open(&buttonPinState, buttonPinTable);
+    if(!buttonPinHandle)
+    {
+#ifdef DEBUG
+        System_printf("button open failed...\r\n");
+#endif
+        return false;
+    }
+    if(PIN_registerIntCb(buttonPinHandle, &Button_intCallbackFxn) != 0)
+    {
+#ifdef DEBUG
+        System_printf("register button callback failed...\r\n");
+#endif
+        return false;
+    }
+    return true;
+}
+
+/**
+  * @brief  Get the next queued button event.
+  * @param index : output, button index or BUTTON_INDEX_CHORD.
+  * @param event : output, button event.
+  * @return true when an event was returned
+  */
+bool Button_getEvent(uint8_t *index, ButtonEvent *event)
+{
+    char entry;
+
+    if(!FIFOGetByte(&buttonFIFO, &entry))
+        return false;
+
+    *index = BUTTON_QUEUE_INDEX(entry);
+    *event = BUTTON_QUEUE_EVENT(entry);
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef _BUTTON_H_
+#define _BUTTON_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ti/drivers/PIN.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Gesture engine tick, only runs while a button is down or a click is pending */
+#define BUTTON_POLL_MS          20
+
+/* Maximum number of buttons handled by the engine */
+#define BUTTON_MAX              4
+
+/* Index reported with BUTTON_EVENT_CHORD */
+#define BUTTON_INDEX_CHORD      0x0F
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum _buttonEvent {
+    BUTTON_EVENT_NONE,
+    BUTTON_EVENT_PRESS,         //held for debounceMs
+    BUTTON_EVENT_RELEASE,       //released after a press
+    BUTTON_EVENT_CLICK,         //short press (after the double click window if enabled)
+    BUTTON_EVENT_DOUBLE_CLICK,  //second short press within doubleClickMs
+    BUTTON_EVENT_LONG_PRESS,    //held for longPressMs
+    BUTTON_EVENT_REPEAT,        //every repeatMs while held after a long press
+    BUTTON_EVENT_CHORD,         //all buttons pressed together
+} ButtonEvent;
+
+/*
+ * Per button timing, all in ms. A zero longPressMs, repeatMs or
+ * doubleClickMs disables that gesture. Buttons are active low.
+ */
+typedef struct _buttonConfig {
+    PIN_Id pin;
+    uint16_t debounceMs;
+    uint16_t longPressMs;
+    uint16_t repeatMs;
+    uint16_t doubleClickMs;
+} ButtonConfig;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern bool Button_init(const ButtonConfig *config, uint8_t count);
+extern bool Button_getEvent(uint8_t *index, ButtonEvent *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_BUTTON_H_
@@ -0,0 +1,330 @@
+/*
+ *  ======== buzzer.c ========
+ *  Buzzer driver and tone sequencer.
+ *
+ *  The buzzer PWM period/duty is reprogrammed from a note table by the
+ *  one-shot callback of a GPTimer, so a melody plays without any task
+ *  involvement and the CPU only wakes up when the tone has to change.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/drivers/PWM.h>
+#include <ti/drivers/timer/GPTimerCC26XX.h>
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "buzzer.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define DUTY_VOLUME_HIGH    (PWM_DUTY_FRACTION_MAX / 2)  /* 50% is the loudest duty for a piezo */
+#define DUTY_VOLUME_MEDIUM  (PWM_DUTY_FRACTION_MAX / 100 * 15)
+#define DUTY_VOLUME_LOW     (PWM_DUTY_FRACTION_MAX / 100 * 4)
+#define DUTY_VOLUME_OFF     0
+
+/* GPTimer runs from the 48MHz system clock */
+#define BUZZER_TIMER_TICKS_PER_MS   48000
+
+/* 16-bit timer with prescaler extension gives a 24-bit load value (~349ms) */
+#define BUZZER_TIMER_MAX_MS         300
+
+/* Frequency update interval while sweeping a chirp */
+#define BUZZER_CHIRP_STEP_MS        2
+
+/*********************************************************************
+ * MELODIES
+ */
+
+const BuzzerNote Buzzer_melodyKey[] = {
+    {2200, 3200, 30},
+    {0, 0, 0},
+};
+
+const BuzzerNote Buzzer_melodySuccess[] = {
+    {2000, 0, 80},
+    {0, 0, 20},
+    {2700, 0, 80},
+    {0, 0, 20},
+    {3400, 0, 120},
+    {0, 0, 0},
+};
+
+const BuzzerNote Buzzer_melodyFailure[] = {
+    {3000, 0, 150},
+    {0, 0, 50},
+    {2000, 0, 150},
+    {0, 0, 50},
+    {2000, 0, 300},
+    {0, 0, 0},
+};
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static PWM_Handle buzzerPWM = NULL;
+static GPTimerCC26XX_Handle buzzerTimer = NULL;
+
+static const BuzzerNote *volatile buzzerNote = NULL;  //note being played, NULL when no melody
+static uint16_t buzzerNoteElapsedMs;
+static uint16_t buzzerStepMs;
+static uint32_t buzzerDuty;      //duty of the melody being played
+static uint16_t buzzerFreqHz;    //tone programmed into the PWM
+static uint32_t buzzerPwmDuty;   //duty programmed into the PWM
+static bool buzzerRunning;
+
+/**
+  * @brief  Convert volume level to PWM duty.
+  * @param volume : volume level.
+  * @return duty in PWM_DUTY_FRACTION units
+  */
+static uint32_t Buzzer_volumeToDuty(BuzzerVolume volume)
+{
+    switch(volume)
+    {
+        case BUZZER_VOLUME_LOW:
+            return DUTY_VOLUME_LOW;
+        case BUZZER_VOLUME_MEDIUM:
+            return DUTY_VOLUME_MEDIUM;
+        case BUZZER_VOLUME_HIGH:
+            return DUTY_VOLUME_HIGH;
+        default:
+            return DUTY_VOLUME_OFF;
+    }
+}
+
+/**
+  * @brief  Output a tone on the buzzer.
+  * @param freqHz : tone frequency, 0 to silence the buzzer.
+  * @param duty : PWM duty in PWM_DUTY_FRACTION units.
+  * @return none
+  */
+static void Buzzer_setTone(uint16_t freqHz, uint32_t duty)
+{
+    if(freqHz == 0)
+    {
+        if(buzzerRunning)
+        {
+            PWM_stop(buzzerPWM);
+            buzzerRunning = false;
+        }
+        return;
+    }
+
+    if((freqHz != buzzerFreqHz) || (duty != buzzerPwmDuty))
+    {
+        /* Drop the duty first so the new period is never shorter than it */
+        PWM_setDuty(buzzerPWM, 0);
+        PWM_setPeriod(buzzerPWM, freqHz);
+        PWM_setDuty(buzzerPWM, duty);
+        buzzerFreqHz = freqHz;
+        buzzerPwmDuty = duty;
+    }
+
+    if(!buzzerRunning)
+    {
+        PWM_start(buzzerPWM);
+        buzzerRunning = true;
+    }
+}
+
+/**
+  * @brief  Output the tone for the current position of the melody and arm
+  *         the timer for the next change.
+  * @param none
+  * @return none
+  */
+static void Buzzer_step(void)
+{
+    const BuzzerNote *note = buzzerNote;
+    uint16_t freqHz = note->freqHz;
+
+    buzzerStepMs = note->durationMs - buzzerNoteElapsedMs;
+    if((freqHz != 0) && (note->endFreqHz != 0) && (note->endFreqHz != freqHz))
+    {
+        freqHz += ((int32_t)note->endFreqHz - (int32_t)note->freqHz) * buzzerNoteElapsedMs / note->durationMs;
+        if(buzzerStepMs > BUZZER_CHIRP_STEP_MS)
+            buzzerStepMs = BUZZER_CHIRP_STEP_MS;
+    }
+    if(buzzerStepMs > BUZZER_TIMER_MAX_MS)
+        buzzerStepMs = BUZZER_TIMER_MAX_MS;
+
+    Buzzer_setTone(freqHz, buzzerDuty);
+
+    GPTimerCC26XX_setLoadValue(buzzerTimer, (uint32_t)buzzerStepMs * BUZZER_TIMER_TICKS_PER_MS - 1);
+    GPTimerCC26XX_start(buzzerTimer);
+}
+
+/**
+  * @brief  Tone sequencer timer callback, runs in HWI context.
+  * @param handle : GPTimer handle.
+  * @param interruptMask : interrupt reasons.
+  * @return none
+  */
+static void Buzzer_timerFxn(GPTimerCC26XX_Handle handle, GPTimerCC26XX_IntMask interruptMask)
+{
+    if(buzzerNote == NULL)
+        return;
+
+    buzzerNoteElapsedMs += buzzerStepMs;
+    if(buzzerNoteElapsedMs >= buzzerNote->durationMs)
+    {
+        buzzerNote++;
+        buzzerNoteElapsedMs = 0;
+    }
+
+    if(buzzerNote->durationMs == 0)
+    {
+        buzzerNote = NULL;
+        GPTimerCC26XX_stop(buzzerTimer);
+        Buzzer_setTone(0, 0);
+        return;
+    }
+
+    Buzzer_step();
+}
+
+/**
+  * @brief  Initialize buzzer PWM and tone sequencer timer.
+  * @param none
+  * @return none
+  */
+void Buzzer_init(void)
+{
+    PWM_Params params;
+    GPTimerCC26XX_Params timerParams;
+
+    buzzerDuty = DUTY_VOLUME_HIGH;
+    buzzerPwmDuty = DUTY_VOLUME_HIGH;
+    buzzerFreqHz = BUZZER_PWM_FREQ;
+    buzzerRunning = false;
+
+    PWM_Params_init(&params);
+    params.dutyUnits = PWM_DUTY_FRACTION;
+    params.dutyValue = buzzerPwmDuty;
+    params.periodUnits = PWM_PERIOD_HZ;
+    params.periodValue = buzzerFreqHz;
+    buzzerPWM = PWM_open(Board_PWM_PUZZER, &params);
+#ifdef DEBUG
+    if (!buzzerPWM)
+        System_printf("buzzer pwm open failed...\r\n");
+#endif
+
+    GPTimerCC26XX_Params_init(&timerParams);
+    timerParams.width = GPT_CONFIG_16BIT;
+    timerParams.mode = GPT_MODE_ONESHOT;
+    timerParams.debugStallMode = GPTimerCC26XX_DEBUG_STALL_OFF;
+    buzzerTimer = GPTimerCC26XX_open(Board_GPTIMER_TONE, &timerParams);
+    if(buzzerTimer)
+    {
+        GPTimerCC26XX_registerInterrupt(buzzerTimer, Buzzer_timerFxn, GPT_INT_TIMEOUT);
+    }
+#ifdef DEBUG
+    else
+        System_printf("buzzer timer open failed...\r\n");
+#endif
+}
+
+/**
+  * @brief  Stop the melody being played, if any.
+  * @param none
+  * @return none
+  */
+void Buzzer_stop(void)
+{
+    UInt key;
+
+    key = Hwi_disable();
+    if(buzzerNote != NULL)
+    {
+        buzzerNote = NULL;
+        GPTimerCC26XX_stop(buzzerTimer);
+    }
+    Buzzer_setTone(0, 0);
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Turn buzzer on with the default tone and volume.
+  * @param none
+  * @return none
+  */
+void Buzzer_on(void)
+{
+    UInt key;
+
+    if(!buzzerPWM)
+        return;
+
+    key = Hwi_disable();
+    if(buzzerNote != NULL)
+    {
+        buzzerNote = NULL;
+        GPTimerCC26XX_stop(buzzerTimer);
+    }
+    Buzzer_setTone(BUZZER_PWM_FREQ, DUTY_VOLUME_HIGH);
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Turn off the default tone. A melody being played is left alone.
+  * @param none
+  * @return none
+  */
+void Buzzer_off(void)
+{
+    UInt key;
+
+    if(!buzzerPWM)
+        return;
+
+    key = Hwi_disable();
+    if(buzzerNote == NULL)
+        Buzzer_setTone(0, 0);
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Play a melody in the background. A melody being played is replaced.
+  * @param melody : note table terminated by a note with durationMs = 0.
+  * @param volume : volume level.
+  * @return none
+  */
+void Buzzer_play(const BuzzerNote *melody, BuzzerVolume volume)
+{
+    UInt key;
+
+    if((!buzzerPWM) || (!buzzerTimer) || (melody == NULL))
+        return;
+
+    if((volume == BUZZER_VOLUME_OFF) || (melody->durationMs == 0))
+    {
+        Buzzer_stop();
+        return;
+    }
+
+    key = Hwi_disable();
+    GPTimerCC26XX_stop(buzzerTimer);
+    buzzerNote = melody;
+    buzzerNoteElapsedMs = 0;
+    buzzerDuty = Buzzer_volumeToDuty(volume);
+    Buzzer_step();
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Check whether a melody is being played.
+  * @param none
+  * @return true when a melody is being played
+  */
+bool Buzzer_isPlaying(void)
+{
+    return (buzzerNote != NULL);
+}
@@ -0,0 +1,63 @@
+#ifndef _BUZZER_H_
+#define _BUZZER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Default tone, used by the plain on/off beeps of the UI */
+#define BUZZER_PWM_FREQ     2730
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum _buzzerVolume {
+    BUZZER_VOLUME_OFF,
+    BUZZER_VOLUME_LOW,
+    BUZZER_VOLUME_MEDIUM,
+    BUZZER_VOLUME_HIGH,
+} BuzzerVolume;
+
+/*
+ * One step of a melody.
+ * freqHz = 0 is a rest. When endFreqHz is non zero and differs from freqHz
+ * the tone sweeps linearly from freqHz to endFreqHz (chirp).
+ * A note with durationMs = 0 terminates the melody.
+ */
+typedef struct _buzzerNote {
+    uint16_t freqHz;
+    uint16_t endFreqHz;
+    uint16_t durationMs;
+} BuzzerNote;
+
+/*********************************************************************
+ * MELODIES
+ */
+extern const BuzzerNote Buzzer_melodyKey[];
+extern const BuzzerNote Buzzer_melodySuccess[];
+extern const BuzzerNote Buzzer_melodyFailure[];
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void Buzzer_init(void);
+extern void Buzzer_on(void);
+extern void Buzzer_off(void);
+extern void Buzzer_play(const BuzzerNote *melody, BuzzerVolume volume);
+extern void Buzzer_stop(void);
+extern bool Buzzer_isPlaying(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_BUZZER_H_
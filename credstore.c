@@ -0,0 +1,522 @@
+/*
+ *  ======== credstore.c ========
+ *  PIN credential store in internal flash.
+ *
+ *  Credentials live in one NVS sector as an open addressing hash table of
+ *  8-byte slots indexed by a hash of the PIN, so a verification normally
+ *  costs a single slot read whatever the number of users. Slots follow
+ *  the flash programming rules: an erased slot (0xFF) is free, a slot is
+ *  enrolled by programming it and removed by clearing its state byte,
+ *  which leaves a tombstone that keeps later probe chains intact.
+ *
+ *  Tombstones can only be reclaimed by an erase: when a probe chain has no
+ *  free slot left the live entries are copied into the other sector, whose
+ *  header is written last with the next generation, and the old sector is
+ *  erased. At boot the valid header with the newest generation wins, so a
+ *  compaction cut by a reset leaves the previous table in place.
+ *
+ *  A new or erased store is empty: nothing opens the lock until PINs are
+ *  provisioned through the PIN entry enrolment.
+ */
+
+#include <string.h>
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+/* BIOS module Headers */
+#include <ti/drivers/NVS.h>
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "tlog.h"
+#include "credstore.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define CREDSTORE_MAGIC         0xC7ED
+#define CREDSTORE_VERSION       1
+
+#define CREDSTORE_SLOT_EMPTY    0xFF    //erased flash
+#define CREDSTORE_SLOT_VALID    0x7F
+#define CREDSTORE_SLOT_HEADER   0x5A
+#define CREDSTORE_SLOT_DELETED  0x00
+
+#define CREDSTORE_PIN_BYTES     (CREDSTORE_PIN_MAX / 2)
+
+/* Slot 0 holds the header, the others the hash table */
+#define CREDSTORE_SLOT_COUNT    (CREDSTORE_NVS_SIZE / sizeof(CredSlot))
+#define CREDSTORE_TABLE_SIZE    (CREDSTORE_SLOT_COUNT - 1)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct _credSlot {
+    uint8_t state;
+    uint8_t length;                     //PIN digits, version in the header
+    uint16_t userId;                    //magic in the header
+    uint8_t pin[CREDSTORE_PIN_BYTES];   //BCD digits, unused nibbles 0xF
+                                        //generation in the header
+} CredSlot;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static NVS_Handle credstoreNvs = NULL;
+static uint8_t credstoreSector = 0;         //sector holding the live table
+static uint32_t credstoreGeneration = 0;    //bumped by each compaction
+
+/**
+  * @brief  Pack PIN digits into BCD.
+  * @param digits : PIN digits '0'~'9'.
+  * @param length : number of digits.
+  * @param packed : output, CREDSTORE_PIN_BYTES bytes.
+  * @return true when the PIN is valid
+  */
+static bool Credstore_pack(const char *digits, uint8_t length, uint8_t *packed)
+{
+    uint8_t i;
+    uint8_t nibble;
+
+    if((digits == NULL) || (length < CREDSTORE_PIN_MIN) || (length > CREDSTORE_PIN_MAX))
+        return false;
+
+    memset(packed, 0xFF, CREDSTORE_PIN_BYTES);
+    for(i = 0; i < length; i++)
+    {
+        if((digits[i] < '0') || (digits[i] > '9'))
+            return false;
+        nibble = digits[i] - '0';
+        if(i & 1)
+            packed[i >> 1] = (packed[i >> 1] & 0xF0) | nibble;
+        else
+            packed[i >> 1] = (packed[i >> 1] & 0x0F) | (nibble << 4);
+    }
+    return true;
+}
+
+/**
+  * @brief  Hash a packed PIN to its home slot (FNV-1a).
+  * @param packed : packed PIN.
+  * @param length : number of digits.
+  * @return table slot number (1 ~ CREDSTORE_TABLE_SIZE)
+  */
+static uint16_t Credstore_home(const uint8_t *packed, uint8_t length)
+{
+    uint32_t hash = 2166136261u;
+    uint8_t i;
+
+    hash = (hash ^ length) * 16777619u;
+    for(i = 0; i < CREDSTORE_PIN_BYTES; i++)
+    {
+        hash = (hash ^ packed[i]) * 16777619u;
+    }
+    return (uint16_t)(hash % CREDSTORE_TABLE_SIZE) + 1;
+}
+
+/**
+  * @brief  Next slot of a probe sequence.
+  * @param slot : current slot number.
+  * @return next slot number
+  */
+static uint16_t Credstore_next(uint16_t slot)
+{
+    return (slot >= CREDSTORE_TABLE_SIZE) ? 1 : (slot + 1);
+}
+
+/**
+  * @brief  NVS offset of a slot.
+  * @param sector : table sector.
+  * @param slot : slot number.
+  * @return offset in the NVS region
+  */
+static size_t Credstore_offset(uint8_t sector, uint16_t slot)
+{
+    return CREDSTORE_NVS_OFFSET + sector * CREDSTORE_NVS_SIZE + slot * sizeof(CredSlot);
+}
+
+/**
+  * @brief  Read one slot.
+  * @param sector : table sector.
+  * @param slot : slot number.
+  * @param data : output slot.
+  * @return true when success
+  */
+static bool Credstore_readSlot(uint8_t sector, uint16_t slot, CredSlot *data)
+{
+    return (NVS_read(credstoreNvs, Credstore_offset(sector, slot),
+                     data, sizeof(CredSlot)) == NVS_STATUS_SUCCESS);
+}
+
+/**
+  * @brief  Program one erased slot. The state byte is written last so an
+  *         interrupted write never leaves a valid looking slot.
+  * @param sector : table sector.
+  * @param slot : slot number.
+  * @param data : slot content.
+  * @return true when success
+  */
+static bool Credstore_writeSlot(uint8_t sector, uint16_t slot, CredSlot *data)
+{
+    size_t offset = Credstore_offset(sector, slot);
+
+    if(NVS_write(credstoreNvs, offset + 1, ((uint8_t *)data) + 1, sizeof(CredSlot) - 1,
+                 NVS_WRITE_POST_VERIFY) != NVS_STATUS_SUCCESS)
+        return false;
+
+    return (NVS_write(credstoreNvs, offset, &data->state, 1,
+                      NVS_WRITE_POST_VERIFY) == NVS_STATUS_SUCCESS);
+}
+
+/**
+  * @brief  Compare a slot with a packed PIN in constant time.
+  * @param data : slot.
+  * @param packed : packed PIN.
+  * @param length : number of digits.
+  * @return true when they match
+  */
+static bool Credstore_match(const CredSlot *data, const uint8_t *packed, uint8_t length)
+{
+    uint8_t diff;
+    uint8_t i;
+
+    diff = data->state ^ CREDSTORE_SLOT_VALID;
+    diff |= data->length ^ length;
+    for(i = 0; i < CREDSTORE_PIN_BYTES; i++)
+    {
+        diff |= data->pin[i] ^ packed[i];
+    }
+    return (diff == 0);
+}
+
+/**
+  * @brief  Find the slot holding a PIN.
+  * @param packed : packed PIN.
+  * @param length : number of digits.
+  * @param found : output slot content, may be NULL.
+  * @return slot number, 0 when not found
+  */
+static uint16_t Credstore_find(const uint8_t *packed, uint8_t length, CredSlot *found)
+{
+    CredSlot data;
+    uint16_t slot = Credstore_home(packed, length);
+    uint16_t probe;
+
+    for(probe = 0; probe < CREDSTORE_MAX_PROBE; probe++)
+    {
+        if(!Credstore_readSlot(credstoreSector, slot, &data))
+            return 0;
+        if(data.state == CREDSTORE_SLOT_EMPTY)
+            return 0;
+        if(Credstore_match(&data, packed, length))
+        {
+            if(found)
+                *found = data;
+            return slot;
+        }
+        slot = Credstore_next(slot);
+    }
+    return 0;
+}
+
+/**
+  * @brief  Erase one table sector.
+  * @param sector : table sector.
+  * @return true when success
+  */
+static bool Credstore_eraseSector(uint8_t sector)
+{
+    return (NVS_erase(credstoreNvs, Credstore_offset(sector, 0),
+                      CREDSTORE_NVS_SIZE) == NVS_STATUS_SUCCESS);
+}
+
+/**
+  * @brief  Read the header of a table sector.
+  * @param sector : table sector.
+  * @param generation : output, table generation.
+  * @return true when the sector holds a valid table
+  */
+static bool Credstore_readHeader(uint8_t sector, uint32_t *generation)
+{
+    CredSlot header;
+
+    if(!Credstore_readSlot(sector, 0, &header) ||
+       (header.state != CREDSTORE_SLOT_HEADER) ||
+       (header.length != CREDSTORE_VERSION) ||
+       (header.userId != CREDSTORE_MAGIC))
+        return false;
+
+    memcpy(generation, header.pin, sizeof(*generation));
+    return true;
+}
+
+/**
+  * @brief  Write the header of a table sector, which makes it valid.
+  * @param sector : table sector, already erased.
+  * @param generation : table generation.
+  * @return true when success
+  */
+static bool Credstore_writeHeader(uint8_t sector, uint32_t generation)
+{
+    CredSlot header;
+
+    header.state = CREDSTORE_SLOT_HEADER;
+    header.length = CREDSTORE_VERSION;
+    header.userId = CREDSTORE_MAGIC;
+    memcpy(header.pin, &generation, sizeof(generation));
+    return Credstore_writeSlot(sector, 0, &header);
+}
+
+/**
+  * @brief  Erase the store and write a new header, the table is empty.
+  * @param none
+  * @return CREDSTORE_SUCCESS when success
+  */
+static CredstoreStatus Credstore_format(void)
+{
+    if(!Credstore_eraseSector(credstoreSector ^ 1) ||
+       !Credstore_eraseSector(credstoreSector) ||
+       !Credstore_writeHeader(credstoreSector, credstoreGeneration))
+        return CREDSTORE_ERROR;
+    return CREDSTORE_SUCCESS;
+}
+
+/**
+  * @brief  Program a slot into the first free slot of its probe chain.
+  * @param sector : table sector.
+  * @param data : slot content, the PIN is already checked not enrolled.
+  * @return CREDSTORE_SUCCESS when success
+  */
+static CredstoreStatus Credstore_insert(uint8_t sector, CredSlot *data)
+{
+    CredSlot current;
+    uint16_t slot = Credstore_home(data->pin, data->length);
+    uint16_t probe;
+
+    /* Tombstones can't be reprogrammed without an erase, take the first free slot */
+    for(probe = 0; probe < CREDSTORE_MAX_PROBE; probe++)
+    {
+        if(!Credstore_readSlot(sector, slot, &current))
+            return CREDSTORE_ERROR;
+        if(current.state == CREDSTORE_SLOT_EMPTY)
+            return Credstore_writeSlot(sector, slot, data) ? CREDSTORE_SUCCESS : CREDSTORE_ERROR;
+        slot = Credstore_next(slot);
+    }
+    return CREDSTORE_FULL;
+}
+
+/**
+  * @brief  Copy the live entries into the other sector, dropping the
+  *         tombstones, and make it the live table.
+  * @param none
+  * @return CREDSTORE_SUCCESS when success
+  */
+static CredstoreStatus Credstore_compact(void)
+{
+    CredstoreStatus status;
+    CredSlot data;
+    uint8_t target = credstoreSector ^ 1;
+    uint16_t slot;
+
+    if(!Credstore_eraseSector(target))
+        return CREDSTORE_ERROR;
+
+    for(slot = 1; slot <= CREDSTORE_TABLE_SIZE; slot++)
+    {
+        if(!Credstore_readSlot(credstoreSector, slot, &data))
+            return CREDSTORE_ERROR;
+        if(data.state != CREDSTORE_SLOT_VALID)
+            continue;
+        status = Credstore_insert(target, &data);
+        if(status != CREDSTORE_SUCCESS)
+            return status;
+    }
+
+    /* The new table only becomes valid once complete */
+    if(!Credstore_writeHeader(target, credstoreGeneration + 1))
+        return CREDSTORE_ERROR;
+
+    credstoreGeneration++;
+    credstoreSector = target;
+    Credstore_eraseSector(target ^ 1);
+    return CREDSTORE_SUCCESS;
+}
+
+/**
+  * @brief  Open the credential store, creating it when missing.
+  * @param none
+  * @return true when success
+  */
+bool Credstore_init(void)
+{
+    NVS_Params params;
+    uint32_t generation[CREDSTORE_NVS_SECTORS];
+    bool valid[CREDSTORE_NVS_SECTORS];
+    uint8_t sector;
+
+    NVS_Params_init(&params);
+    credstoreNvs = NVS_open(Board_NVSINTERNAL, &params);
+    if(credstoreNvs == NULL)
+    {
+        TLOG0(TLOG_CREDSTORE_OPEN_FAILED);
+        return false;
+    }
+
+    for(sector = 0; sector < CREDSTORE_NVS_SECTORS; sector++)
+    {
+        valid[sector] = Credstore_readHeader(sector, &generation[sector]);
+    }
+
+    if(valid[0] || valid[1])
+    {
+        /* Both valid when a compaction was cut before the old sector erase */
+        if(valid[0] && valid[1])
+            sector = ((int32_t)(generation[1] - generation[0]) > 0) ? 1 : 0;
+        else
+            sector = valid[0] ? 0 : 1;
+        credstoreSector = sector;
+        credstoreGeneration = generation[sector];
+        if(valid[sector ^ 1])
+            Credstore_eraseSector(sector ^ 1);
+        return true;
+    }
+
+    TLOG0(TLOG_CREDSTORE_FORMATTED);
+    if(Credstore_format() != CREDSTORE_SUCCESS)
+        return false;
+#ifdef CREDSTORE_DEFAULT_PIN
+    Credstore_add(0, CREDSTORE_DEFAULT_PIN, sizeof(CREDSTORE_DEFAULT_PIN) - 1);
+#endif
+    return true;
+}
+
+/**
+  * @brief  Enroll a PIN.
+  * @param userId : user the PIN belongs to.
+  * @param digits : PIN digits '0'~'9'.
+  * @param length : number of digits.
+  * @return CREDSTORE_SUCCESS when success
+  */
+CredstoreStatus Credstore_add(uint16_t userId, const char *digits, uint8_t length)
+{
+    CredstoreStatus status;
+    CredSlot data;
+
+    if(credstoreNvs == NULL)
+        return CREDSTORE_ERROR;
+    if(!Credstore_pack(digits, length, data.pin))
+        return CREDSTORE_INVALID;
+    if(Credstore_find(data.pin, length, NULL))
+        return CREDSTORE_EXISTS;
+
+    data.state = CREDSTORE_SLOT_VALID;
+    data.length = length;
+    data.userId = userId;
+    status = Credstore_insert(credstoreSector, &data);
+    if(status != CREDSTORE_FULL)
+        return status;
+
+    /* The probe chain is used up, reclaim the tombstones and try again */
+    TLOG0(TLOG_CREDSTORE_COMPACTED);
+    status = Credstore_compact();
+    if(status != CREDSTORE_SUCCESS)
+        return status;
+    return Credstore_insert(credstoreSector, &data);
+}
+
+/**
+  * @brief  Remove an enrolled PIN.
+  * @param digits : PIN digits '0'~'9'.
+  * @param length : number of digits.
+  * @return CREDSTORE_SUCCESS when success
+  */
+CredstoreStatus Credstore_remove(const char *digits, uint8_t length)
+{
+    uint8_t packed[CREDSTORE_PIN_BYTES];
+    uint8_t state = CREDSTORE_SLOT_DELETED;
+    uint16_t slot;
+
+    if(credstoreNvs == NULL)
+        return CREDSTORE_ERROR;
+    if(!Credstore_pack(digits, length, packed))
+        return CREDSTORE_INVALID;
+
+    slot = Credstore_find(packed, length, NULL);
+    if(slot == 0)
+        return CREDSTORE_NOT_FOUND;
+
+    if(NVS_write(credstoreNvs, Credstore_offset(credstoreSector, slot), &state, 1,
+                 NVS_WRITE_POST_VERIFY) != NVS_STATUS_SUCCESS)
+        return CREDSTORE_ERROR;
+    return CREDSTORE_SUCCESS;
+}
+
+/**
+  * @brief  Check a PIN against the enrolled credentials.
+  * @param digits : PIN digits.
+  * @param length : number of digits.
+  * @param userId : output, user the PIN belongs to, may be NULL.
+  * @return true when the PIN is enrolled
+  */
+bool Credstore_verify(const char *digits, uint8_t length, uint16_t *userId)
+{
+    uint8_t packed[CREDSTORE_PIN_BYTES];
+    CredSlot data;
+    bool result = false;
+
+    if((credstoreNvs != NULL) && Credstore_pack(digits, length, packed) &&
+       Credstore_find(packed, length, &data))
+    {
+        if(userId)
+            *userId = data.userId;
+        result = true;
+    }
+
+    memset(packed, 0, sizeof(packed));
+    return result;
+}
+
+/**
+  * @brief  Remove all credentials. The store is left empty until PINs are
+  *         provisioned again.
+  * @param none
+  * @return CREDSTORE_SUCCESS when success
+  */
+CredstoreStatus Credstore_erase(void)
+{
+    if(credstoreNvs == NULL)
+        return CREDSTORE_ERROR;
+
+    return Credstore_format();
+}
+
+/**
+  * @brief  Count the enrolled credentials, scans the whole table.
+  * @param maxUserId : output, highest user ID enrolled, may be NULL.
+  * @return number of credentials, 0 when the store needs provisioning
+  */
+uint16_t Credstore_count(uint16_t *maxUserId)
+{
+    CredSlot data;
+    uint16_t count = 0;
+    uint16_t slot;
+
+    if(maxUserId)
+        *maxUserId = 0;
+    if(credstoreNvs == NULL)
+        return 0;
+
+    for(slot = 1; slot <= CREDSTORE_TABLE_SIZE; slot++)
+    {
+        if(!Credstore_readSlot(credstoreSector, slot, &data) || (data.state != CREDSTORE_SLOT_VALID))
+            continue;
+        count++;
+        if(maxUserId && (data.userId > *maxUserId))
+            *maxUserId = data.userId;
+    }
+    return count;
+}
@@ -0,0 +1,64 @@
+#ifndef _CREDSTORE_H_
+#define _CREDSTORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Credential table location in the internal NVS region, one flash sector
+ * per table and a second sector the table is compacted into */
+#define CREDSTORE_NVS_OFFSET    0x0000
+#define CREDSTORE_NVS_SIZE      0x2000
+#define CREDSTORE_NVS_SECTORS   2
+
+#define CREDSTORE_PIN_MIN       4
+#define CREDSTORE_PIN_MAX       8
+
+/* Longest probe sequence of the hashed table */
+#define CREDSTORE_MAX_PROBE     32
+
+/*
+ * A new store is empty, PINs are provisioned with PinEntry_enrol(). Bench
+ * units can get a PIN enrolled as user 0 when the store is created with
+ * -DCREDSTORE_DEFAULT_PIN=\"1234\", debug builds only.
+ */
+#if defined(CREDSTORE_DEFAULT_PIN) && !defined(DEBUG)
+#error "CREDSTORE_DEFAULT_PIN is only allowed in debug builds"
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum _credstoreStatus {
+    CREDSTORE_SUCCESS,
+    CREDSTORE_INVALID,      //bad PIN length or digits
+    CREDSTORE_EXISTS,       //PIN already enrolled
+    CREDSTORE_NOT_FOUND,
+    CREDSTORE_FULL,         //no free slot within CREDSTORE_MAX_PROBE, even compacted
+    CREDSTORE_ERROR,        //NVS access failed
+} CredstoreStatus;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern bool Credstore_init(void);
+extern CredstoreStatus Credstore_add(uint16_t userId, const char *digits, uint8_t length);
+extern CredstoreStatus Credstore_remove(const char *digits, uint8_t length);
+extern bool Credstore_verify(const char *digits, uint8_t length, uint16_t *userId);
+extern CredstoreStatus Credstore_erase(void);
+extern uint16_t Credstore_count(uint16_t *maxUserId);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_CREDSTORE_H_
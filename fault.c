@@ -0,0 +1,358 @@
+/*
+ *  ======== fault.c ========
+ *  Fault handler.
+ *
+ *  Hardware exceptions (m3Hwi.excHandlerFunc) and fatal errors of the
+ *  Error module (System.abortFxn) end here. The motor outputs are driven
+ *  low first, with direct register writes that don't depend on the state
+ *  of the drivers, then the context is saved in a crash record in RAM
+ *  that is not initialized at startup and the device is reset.
+ *
+ *  The record holds the registers, the fault status, a few stack words,
+ *  the current task and the latest trace events, plus the timings of the
+ *  recovery: CPU cycles from the handler entry to the motor off, time
+ *  from the fault to main() after the reset, measured with the AON RTC
+ *  which runs through a system reset, and time from BIOS_start() to the
+ *  main task ready. After the next boot it is sent to the token log from
+ *  the idle main loop, in TLOG_ENABLE builds only; Release builds keep it
+ *  for the debugger until the next fault.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/devices/cc13x2_cc26x2/inc/hw_types.h>
+#include <ti/devices/cc13x2_cc26x2/inc/hw_memmap.h>
+#include <ti/devices/cc13x2_cc26x2/inc/hw_cpu_dwt.h>
+#include <ti/devices/cc13x2_cc26x2/inc/hw_cpu_scs.h>
+#include <ti/devices/cc13x2_cc26x2/driverlib/gpio.h>
+#include <ti/devices/cc13x2_cc26x2/driverlib/ioc.h>
+#include <ti/devices/cc13x2_cc26x2/driverlib/aon_rtc.h>
+#include <ti/devices/cc13x2_cc26x2/driverlib/sys_ctrl.h>
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "trace.h"
+#include "tlog.h"
+#include "fault.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define FAULT_MAGIC             0x464C5421      //"FLT!"
+
+#define FAULT_SRAM_SIZE         0x14000
+
+/* Longer means the RTC was restarted since the fault, time unknown */
+#define FAULT_RESET_MAX_RTC     (10UL << 16)
+#define FAULT_TIME_UNKNOWN      0xFFFFFFFF
+
+/* Saved registers, r0-r12 then sp, lr, pc, xpsr */
+#define FAULT_REG_SP            13
+#define FAULT_REG_LR            14
+#define FAULT_REG_PC            15
+#define FAULT_REG_XPSR          16
+#define FAULT_REG_COUNT         17
+
+/*
+ * Exception stack of the SYS/BIOS m3 Hwi handler: r4-r11 pushed by the
+ * handler, then the frame stacked by the core, r0-r3, r12, lr, pc, xpsr
+ */
+#define FAULT_EXC_R4            0
+#define FAULT_EXC_R0            8
+#define FAULT_EXC_R12           12
+#define FAULT_EXC_LR            13
+#define FAULT_EXC_PC            14
+#define FAULT_EXC_XPSR          15
+#define FAULT_EXC_FRAME_WORDS   16
+/* s0-s15, fpscr and a reserved word after a frame with FPU context */
+#define FAULT_EXC_FPU_WORDS     18
+#define FAULT_EXC_RETURN_NO_FPU 0x10
+#define FAULT_XPSR_ALIGN        0x200
+
+/* Record lines of Fault_dumpLine() */
+#define FAULT_LINE_REGS         4
+#define FAULT_LINE_STACK        (FAULT_LINE_REGS + FAULT_REG_COUNT)
+#define FAULT_LINE_TRACE        (FAULT_LINE_STACK + FAULT_STACK_WORDS)
+#define FAULT_LINE_COUNT        (FAULT_LINE_TRACE + FAULT_TRACE_LEN)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct _faultRecord {
+    uint32_t magic;
+    uint16_t count;             //faults since the last power-on
+    uint8_t reported;           //sent to the token log after the reset
+    uint8_t threadType;         //BIOS_ThreadType at the fault
+    uint32_t vector;            //active exception, FAULT_VECTOR_ABORT for an error
+    uint32_t regs[FAULT_REG_COUNT];
+    uint32_t excReturn;
+    uint32_t cfsr;
+    uint32_t hfsr;
+    uint32_t address;           //MMFAR or BFAR when valid
+    uint32_t task;              //Task_Handle
+    uint32_t stack[FAULT_STACK_WORDS];
+    TraceEntry trace[FAULT_TRACE_LEN];
+    uint32_t safeCycles;        //handler entry to motor off
+    uint32_t rtc;               //AON RTC at the fault, 16.16 seconds
+    uint32_t resetUs;           //fault to main()
+    uint32_t readyUs;           //BIOS_start() to main task ready
+    uint32_t magicInverse;
+} FaultRecord;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+#if defined(__TI_COMPILER_VERSION__)
+#pragma NOINIT(faultRecord);
+static FaultRecord faultRecord;
+#elif defined(__GNUC__)
+static FaultRecord faultRecord __attribute__ ((section (".noinit")));
+#else
+static FaultRecord faultRecord;
+#endif
+
+/* Next record line to dump, FAULT_LINE_COUNT when done */
+static uint8_t faultDumpLine = FAULT_LINE_COUNT;
+
+/**
+  * @brief  Drive the motor outputs low. Takes the pins from the timers or
+  *         the PIN driver, so it works whatever they were doing.
+  * @param none
+  * @return none
+  */
+static void Fault_motorOff(void)
+{
+    GPIO_clearDio(CC26X2R1_JANUS_L1_MOTOR1_PWMPIN0);
+    GPIO_clearDio(CC26X2R1_JANUS_L1_MOTOR2_PWMPIN1);
+    GPIO_setOutputEnableDio(CC26X2R1_JANUS_L1_MOTOR1_PWMPIN0, GPIO_OUTPUT_ENABLE);
+    GPIO_setOutputEnableDio(CC26X2R1_JANUS_L1_MOTOR2_PWMPIN1, GPIO_OUTPUT_ENABLE);
+    IOCIOPortIdSet(CC26X2R1_JANUS_L1_MOTOR1_PWMPIN0, IOC_PORT_GPIO);
+    IOCIOPortIdSet(CC26X2R1_JANUS_L1_MOTOR2_PWMPIN1, IOC_PORT_GPIO);
+}
+
+/**
+  * @brief  Check that both magic words of the crash record are set, so a
+  *         partly valid record left in RAM is never taken for a crash.
+  * @param none
+  * @return true when the record holds a crash
+  */
+static bool Fault_recordValid(void)
+{
+    return (faultRecord.magic == FAULT_MAGIC) && (faultRecord.magicInverse == ~(uint32_t)FAULT_MAGIC);
+}
+
+/**
+  * @brief  Make the motor safe, save the crash record and reset.
+  * @param excStack : exception stack, NULL for an error.
+  * @param excReturn : EXC_RETURN of the exception.
+  * @return none, does not return
+  */
+static void Fault_handle(uint32_t *excStack, uint32_t excReturn)
+{
+    uint32_t cycles;
+    uintptr_t sp;
+    uint32_t cfsr;
+    uint8_t i;
+
+    /* Cycle counter off after standby, restart it for the measurement */
+    HWREG(CPU_SCS_BASE + CPU_SCS_O_DEMCR) |= CPU_SCS_DEMCR_TRCENA;
+    HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT) = 0;
+    HWREG(CPU_DWT_BASE + CPU_DWT_O_CTRL) |= CPU_DWT_CTRL_CYCCNTENA;
+    Fault_motorOff();
+    cycles = HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT);
+
+    if(!Fault_recordValid())
+        faultRecord.count = 0;
+    faultRecord.magic = 0;
+    faultRecord.count++;
+    faultRecord.reported = 0;
+    faultRecord.safeCycles = cycles;
+    faultRecord.rtc = AONRTCCurrentCompareValueGet();
+    faultRecord.resetUs = 0;
+    faultRecord.readyUs = 0;
+    faultRecord.vector = excStack ? (HWREG(CPU_SCS_BASE + CPU_SCS_O_ICSR) & CPU_SCS_ICSR_VECTACTIVE_M) : FAULT_VECTOR_ABORT;
+    faultRecord.threadType = (uint8_t)BIOS_getThreadType();
+    faultRecord.task = (uint32_t)(uintptr_t)Task_self();
+    faultRecord.excReturn = excReturn;
+
+    cfsr = HWREG(CPU_SCS_BASE + CPU_SCS_O_CFSR);
+    faultRecord.cfsr = cfsr;
+    faultRecord.hfsr = HWREG(CPU_SCS_BASE + CPU_SCS_O_HFSR);
+    if(cfsr & CPU_SCS_CFSR_BFARVALID)
+        faultRecord.address = HWREG(CPU_SCS_BASE + CPU_SCS_O_BFAR);
+    else if(cfsr & CPU_SCS_CFSR_MMARVALID)
+        faultRecord.address = HWREG(CPU_SCS_BASE + CPU_SCS_O_MMFAR);
+    else
+        faultRecord.address = 0;
+
+    for(i = 0; i < FAULT_REG_COUNT; i++)
+        faultRecord.regs[i] = 0;
+    for(i = 0; i < FAULT_STACK_WORDS; i++)
+        faultRecord.stack[i] = 0;
+    if(excStack)
+    {
+        for(i = 0; i < 4; i++)
+            faultRecord.regs[i] = excStack[FAULT_EXC_R0 + i];
+        for(i = 0; i < 8; i++)
+            faultRecord.regs[4 + i] = excStack[FAULT_EXC_R4 + i];
+        faultRecord.regs[12] = excStack[FAULT_EXC_R12];
+        faultRecord.regs[FAULT_REG_LR] = excStack[FAULT_EXC_LR];
+        faultRecord.regs[FAULT_REG_PC] = excStack[FAULT_EXC_PC];
+        faultRecord.regs[FAULT_REG_XPSR] = excStack[FAULT_EXC_XPSR];
+
+        /* Stack pointer before the exception */
+        sp = (uintptr_t)(excStack + FAULT_EXC_FRAME_WORDS);
+        if(!(excReturn & FAULT_EXC_RETURN_NO_FPU))
+            sp += FAULT_EXC_FPU_WORDS * 4;
+        if(excStack[FAULT_EXC_XPSR] & FAULT_XPSR_ALIGN)
+            sp += 4;
+        faultRecord.regs[FAULT_REG_SP] = (uint32_t)sp;
+
+        /* Only from RAM, sp may be what faulted */
+        if((sp >= SRAM_BASE) && (sp <= SRAM_BASE + FAULT_SRAM_SIZE - FAULT_STACK_WORDS * 4) && !(sp & 3))
+        {
+            for(i = 0; i < FAULT_STACK_WORDS; i++)
+                faultRecord.stack[i] = ((uint32_t *)sp)[i];
+        }
+    }
+
+    Trace_log(TRACE_FAULT, (uint16_t)faultRecord.vector);
+    Trace_getLast(faultRecord.trace, FAULT_TRACE_LEN);
+
+    faultRecord.magicInverse = ~(uint32_t)FAULT_MAGIC;
+    faultRecord.magic = FAULT_MAGIC;
+
+    SysCtrlSystemReset();
+    for(;;);
+}
+
+/**
+  * @brief  Exception handler, m3Hwi.excHandlerFunc.
+  * @param excStack : exception stack saved by the SYS/BIOS handler.
+  * @param excReturn : EXC_RETURN of the exception.
+  * @return none, does not return
+  */
+void Fault_excHandler(uint32_t *excStack, uint32_t excReturn)
+{
+    Fault_handle(excStack, excReturn);
+}
+
+/**
+  * @brief  Fatal error of the Error module, System.abortFxn.
+  * @param none
+  * @return none, does not return
+  */
+void Fault_abort(void)
+{
+    Fault_handle(NULL, 0);
+}
+
+/**
+  * @brief  Check for a crash record of the previous run and time the
+  *         reset. Called at the start of main(), before BIOS_start()
+  *         restarts the RTC.
+  * @param none
+  * @return none
+  */
+void Fault_init(void)
+{
+    uint32_t rtcDelta;
+
+    if(!Fault_recordValid())
+    {
+        faultRecord.count = 0;
+        return;
+    }
+    if(faultRecord.reported)
+        return;
+
+    rtcDelta = AONRTCCurrentCompareValueGet() - faultRecord.rtc;
+    if(rtcDelta > FAULT_RESET_MAX_RTC)
+        faultRecord.resetUs = FAULT_TIME_UNKNOWN;
+    else
+        /* 16.16 seconds to us, 1000000 / 65536 = 15625 / 1024 */
+        faultRecord.resetUs = (uint32_t)(((uint64_t)rtcDelta * 15625) >> 10);
+}
+
+/**
+  * @brief  The main task is ready: time it and start dumping the crash
+  *         record of the previous run, if any.
+  * @param none
+  * @return none
+  */
+void Fault_ready(void)
+{
+    if(!Fault_recordValid() || faultRecord.reported)
+        return;
+
+    faultRecord.readyUs = Clock_getTicks() * Clock_tickPeriod;
+    faultRecord.reported = 1;
+    faultDumpLine = 0;
+}
+
+#ifdef TLOG_ENABLE
+/**
+  * @brief  Send one line of the crash record to the token log.
+  * @param line : line number, below FAULT_LINE_COUNT.
+  * @return none
+  */
+static void Fault_dumpLine(uint8_t line)
+{
+    const TraceEntry *entry;
+
+    switch(line)
+    {
+        case 0:
+            TLOG3(TLOG_FAULT, faultRecord.count, faultRecord.vector, faultRecord.threadType);
+            break;
+        case 1:
+            TLOG3(TLOG_FAULT_STATUS, faultRecord.cfsr, faultRecord.hfsr, faultRecord.address);
+            break;
+        case 2:
+            TLOG2(TLOG_FAULT_TASK, faultRecord.task, faultRecord.excReturn);
+            break;
+        case 3:
+            TLOG3(TLOG_FAULT_TIME, faultRecord.safeCycles, faultRecord.resetUs, faultRecord.readyUs);
+            break;
+        default:
+            if(line < FAULT_LINE_STACK)
+            {
+                TLOG2(TLOG_FAULT_REG, line - FAULT_LINE_REGS, faultRecord.regs[line - FAULT_LINE_REGS]);
+            }
+            else if(line < FAULT_LINE_TRACE)
+            {
+                TLOG2(TLOG_FAULT_STACK, line - FAULT_LINE_STACK, faultRecord.stack[line - FAULT_LINE_STACK]);
+            }
+            else
+            {
+                entry = &faultRecord.trace[line - FAULT_LINE_TRACE];
+                TLOG3(TLOG_FAULT_TRACE, entry->tick, entry->event, entry->arg);
+            }
+            break;
+    }
+}
+#endif
+
+/**
+  * @brief  Send the crash record to the token log, a few lines per call,
+  *         called when the system is idle.
+  * @param none
+  * @return none
+  */
+void Fault_idle(void)
+{
+#ifdef TLOG_ENABLE
+    uint8_t count = 0;
+
+    while((faultDumpLine < FAULT_LINE_COUNT) && (count++ < FAULT_DUMP_PER_IDLE))
+        Fault_dumpLine(faultDumpLine++);
+#endif
+}
@@ -0,0 +1,42 @@
+#ifndef _FAULT_H_
+#define _FAULT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Stack words above the faulting frame kept in the record */
+#define FAULT_STACK_WORDS       8
+/* Latest trace events kept in the record */
+#define FAULT_TRACE_LEN         8
+
+/* Record lines sent to the token log per Fault_idle() call */
+#define FAULT_DUMP_PER_IDLE     8
+
+/* Vector of a fatal error of the Error module, not an exception */
+#define FAULT_VECTOR_ABORT      0
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void Fault_init(void);
+extern void Fault_ready(void);
+extern void Fault_idle(void);
+
+/* Hooked in mutex.cfg */
+extern void Fault_excHandler(uint32_t *excStack, uint32_t excReturn);
+extern void Fault_abort(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_FAULT_H_
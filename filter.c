@@ -0,0 +1,456 @@
+/*
+ *  ======== filter.c ========
+ *  Fixed-point filter kernels for ADC sample blocks.
+ *
+ *  Sums and the IIR low-pass use the Cortex-M4 DSP instructions on target:
+ *  SADD16 adds two samples per instruction into halfword lanes, which are
+ *  folded into the 32-bit sum by SMLAD every FILTER_SIMD_CHUNK words while
+ *  12-bit values can't overflow a lane. SMLAD also computes both taps of
+ *  the low-pass in one instruction. The portable reference versions give
+ *  the same results bit for bit, they are used on other compilers or when
+ *  FILTER_REFERENCE is defined.
+ *
+ *  FILTER_HOST builds the SIMD kernels on the host with the two
+ *  instructions written in C, and times the benchmark in nanoseconds, so
+ *  the host tests (tests/test_filter.c) can check them against the
+ *  reference versions.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+
+#if defined(FILTER_BENCHMARK) && defined(FILTER_HOST)
+#include <time.h>
+#elif defined(FILTER_BENCHMARK)
+#include <ti/devices/cc13x2_cc26x2/inc/hw_types.h>
+#include <ti/devices/cc13x2_cc26x2/inc/hw_memmap.h>
+#include <ti/devices/cc13x2_cc26x2/inc/hw_cpu_dwt.h>
+#include <ti/devices/cc13x2_cc26x2/inc/hw_cpu_scs.h>
+#endif
+
+#include "filter.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#if !defined(FILTER_REFERENCE) && defined(__TI_COMPILER_VERSION__) && defined(__TI_ARM_V7M4__)
+#define FILTER_SIMD
+#define FILTER_SADD16(a, b)         ((uint32_t)_sadd16((int)(a), (int)(b)))
+#define FILTER_SMLAD(a, b, acc)     ((uint32_t)_smlad((int)(a), (int)(b), (int)(acc)))
+#elif !defined(FILTER_REFERENCE) && defined(__GNUC__) && defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#define FILTER_SIMD
+#define FILTER_SADD16(a, b)         ((uint32_t)__sadd16((int16x2_t)(a), (int16x2_t)(b)))
+#define FILTER_SMLAD(a, b, acc)     ((uint32_t)__smlad((int16x2_t)(a), (int16x2_t)(b), (int32_t)(acc)))
+#elif !defined(FILTER_REFERENCE) && defined(FILTER_HOST)
+#define FILTER_SIMD
+#define FILTER_SADD16(a, b)         Filter_sadd16((a), (b))
+#define FILTER_SMLAD(a, b, acc)     Filter_smlad((a), (b), (acc))
+#endif
+
+/* Words added into the halfword lanes before folding, 8 * 0x0FFF < 0x8000 */
+#define FILTER_SIMD_CHUNK           8
+
+/* Fraction bits of the low-pass state, 0x0FFF << 3 still fits a signed halfword */
+#define FILTER_LOWPASS_FRAC         3
+#define FILTER_LOWPASS_SHIFT        14
+
+#define FILTER_EMA_FRAC             8
+
+#ifdef FILTER_BENCHMARK
+#define FILTER_BENCHMARK_SAMPLES    256
+#ifdef FILTER_HOST
+#define FILTER_BENCHMARK_UNIT       "ns"
+#else
+#define FILTER_BENCHMARK_UNIT       "cycles"
+#endif
+#endif
+
+#if defined(FILTER_HOST) && defined(FILTER_SIMD)
+/**
+  * @brief  SADD16 in C: two signed halfword adds, each wrapping in its
+  *         lane.
+  * @param a : first halfword pair.
+  * @param b : second halfword pair.
+  * @return lane sums
+  */
+static uint32_t Filter_sadd16(uint32_t a, uint32_t b)
+{
+    uint32_t low = (a + b) & 0xFFFF;
+    uint32_t high = ((a >> 16) + (b >> 16)) & 0xFFFF;
+
+    return (high << 16) | low;
+}
+
+/**
+  * @brief  SMLAD in C: both signed halfword products added to the
+  *         accumulator.
+  * @param a : first halfword pair.
+  * @param b : second halfword pair.
+  * @param acc : accumulator.
+  * @return acc + a.low * b.low + a.high * b.high
+  */
+static uint32_t Filter_smlad(uint32_t a, uint32_t b, uint32_t acc)
+{
+    int32_t low = (int32_t)(int16_t)(a & 0xFFFF) * (int16_t)(b & 0xFFFF);
+    int32_t high = (int32_t)(int16_t)(a >> 16) * (int16_t)(b >> 16);
+
+    return acc + (uint32_t)low + (uint32_t)high;
+}
+#endif
+
+#if !defined(FILTER_SIMD) || defined(FILTER_BENCHMARK)
+/**
+  * @brief  Sum a block, reference version.
+  * @param samples : sample block.
+  * @param count : number of samples.
+  * @return sum
+  */
+static uint32_t Filter_sumReference(const uint16_t *samples, uint16_t count)
+{
+    uint32_t sum = 0;
+    uint16_t i;
+
+    for(i = 0; i < count; i++)
+    {
+        sum += samples[i];
+    }
+    return sum;
+}
+
+/**
+  * @brief  Run the low-pass over a block, reference version.
+  * @param lowpass : filter state, primed.
+  * @param samples : sample block.
+  * @param count : number of samples.
+  * @return none
+  */
+static void Filter_lowpassReference(FilterLowpass *lowpass, const uint16_t *samples, uint16_t count)
+{
+    int32_t alpha = lowpass->alpha;
+    int32_t beta = FILTER_LOWPASS_ONE - lowpass->alpha;
+    int32_t value = lowpass->value;
+    uint16_t i;
+
+    for(i = 0; i < count; i++)
+    {
+        value = (alpha * ((int32_t)samples[i] << FILTER_LOWPASS_FRAC) + beta * value +
+                 (1 << (FILTER_LOWPASS_SHIFT - 1))) >> FILTER_LOWPASS_SHIFT;
+    }
+    lowpass->value = (uint16_t)value;
+}
+#endif
+
+#ifdef FILTER_SIMD
+/**
+  * @brief  Sum a block with SADD16 and SMLAD.
+  * @param samples : sample block.
+  * @param count : number of samples.
+  * @return sum
+  */
+static uint32_t Filter_sumSimd(const uint16_t *samples, uint16_t count)
+{
+    const uint32_t *words;
+    uint32_t sum = 0;
+    uint32_t lanes;
+    uint16_t pairs;
+    uint16_t chunk;
+
+    /* Word align the block */
+    if(((uintptr_t)samples & 0x2) && count)
+    {
+        sum = *samples++;
+        count--;
+    }
+
+    words = (const uint32_t *)samples;
+    pairs = count / 2;
+    while(pairs)
+    {
+        chunk = (pairs > FILTER_SIMD_CHUNK) ? FILTER_SIMD_CHUNK : pairs;
+        pairs -= chunk;
+        lanes = 0;
+        while(chunk--)
+        {
+            lanes = FILTER_SADD16(lanes, *words++);
+        }
+        sum = FILTER_SMLAD(lanes, 0x00010001, sum);
+    }
+
+    if(count & 1)
+        sum += samples[count - 1];
+    return sum;
+}
+
+/**
+  * @brief  Run the low-pass over a block, both taps by one SMLAD.
+  * @param lowpass : filter state, primed.
+  * @param samples : sample block.
+  * @param count : number of samples.
+  * @return none
+  */
+static void Filter_lowpassSimd(FilterLowpass *lowpass, const uint16_t *samples, uint16_t count)
+{
+    uint32_t coefficients = ((uint32_t)(FILTER_LOWPASS_ONE - lowpass->alpha) << 16) | lowpass->alpha;
+    uint32_t value = lowpass->value;
+    uint16_t i;
+
+    for(i = 0; i < count; i++)
+    {
+        value = FILTER_SMLAD((value << 16) | ((uint32_t)samples[i] << FILTER_LOWPASS_FRAC), coefficients,
+                             1 << (FILTER_LOWPASS_SHIFT - 1)) >> FILTER_LOWPASS_SHIFT;
+    }
+    lowpass->value = (uint16_t)value;
+}
+#endif
+
+/**
+  * @brief  Sort a block in place, insertion sort for the small blocks
+  *         used here.
+  * @param samples : sample block.
+  * @param count : number of samples.
+  * @return none
+  */
+static void Filter_sort(uint16_t *samples, uint16_t count)
+{
+    uint16_t i;
+    uint16_t j;
+    uint16_t value;
+
+    for(i = 1; i < count; i++)
+    {
+        value = samples[i];
+        for(j = i; (j > 0) && (samples[j - 1] > value); j--)
+        {
+            samples[j] = samples[j - 1];
+        }
+        samples[j] = value;
+    }
+}
+
+/**
+  * @brief  Sum a block.
+  * @param samples : sample block, values up to FILTER_SAMPLE_MAX.
+  * @param count : number of samples.
+  * @return sum
+  */
+uint32_t Filter_sum(const uint16_t *samples, uint16_t count)
+{
+#ifdef FILTER_SIMD
+    return Filter_sumSimd(samples, count);
+#else
+    return Filter_sumReference(samples, count);
+#endif
+}
+
+/**
+  * @brief  Mean of a block, rounded.
+  * @param samples : sample block, values up to FILTER_SAMPLE_MAX.
+  * @param count : number of samples.
+  * @return mean, 0 for an empty block
+  */
+uint16_t Filter_mean(const uint16_t *samples, uint16_t count)
+{
+    if(count == 0)
+        return 0;
+    return (uint16_t)((Filter_sum(samples, count) + count / 2) / count);
+}
+
+/**
+  * @brief  Mean of a block without its trim lowest and trim highest
+  *         samples. The block is sorted in place.
+  * @param samples : sample block, values up to FILTER_SAMPLE_MAX.
+  * @param count : number of samples.
+  * @param trim : samples dropped at each end.
+  * @return trimmed mean, the median when nothing is left
+  */
+uint16_t Filter_trimmedMean(uint16_t *samples, uint16_t count, uint16_t trim)
+{
+    if(2 * trim >= count)
+        return Filter_median(samples, count);
+
+    Filter_sort(samples, count);
+    return Filter_mean(samples + trim, count - 2 * trim);
+}
+
+/**
+  * @brief  Median of a block, the lower one for an even count. The block
+  *         is sorted in place.
+  * @param samples : sample block.
+  * @param count : number of samples.
+  * @return median, 0 for an empty block
+  */
+uint16_t Filter_median(uint16_t *samples, uint16_t count)
+{
+    if(count == 0)
+        return 0;
+
+    Filter_sort(samples, count);
+    return samples[(count - 1) / 2];
+}
+
+/**
+  * @brief  Initialize an exponential moving average.
+  * @param ema : filter state.
+  * @param shift : weight of a new sample is 1 / 2^shift.
+  * @return none
+  */
+void Filter_emaInit(FilterEma *ema, uint8_t shift)
+{
+    ema->value = 0;
+    ema->shift = shift;
+    ema->primed = false;
+}
+
+/**
+  * @brief  Add a sample to an exponential moving average, the first one
+  *         sets the average.
+  * @param ema : filter state.
+  * @param sample : new sample.
+  * @return average, rounded
+  */
+uint16_t Filter_ema(FilterEma *ema, uint16_t sample)
+{
+    int32_t delta;
+
+    if(!ema->primed)
+    {
+        ema->value = (uint32_t)sample << FILTER_EMA_FRAC;
+        ema->primed = true;
+    }
+    else
+    {
+        delta = (int32_t)((uint32_t)sample << FILTER_EMA_FRAC) - (int32_t)ema->value;
+        ema->value += delta >> ema->shift;
+    }
+    return (uint16_t)((ema->value + (1 << (FILTER_EMA_FRAC - 1))) >> FILTER_EMA_FRAC);
+}
+
+/**
+  * @brief  Initialize a first order IIR low-pass.
+  * @param lowpass : filter state.
+  * @param alpha : weight of a new sample, Q14, 1 ~ FILTER_LOWPASS_ONE.
+  * @return none
+  */
+void Filter_lowpassInit(FilterLowpass *lowpass, uint16_t alpha)
+{
+    if(alpha == 0)
+        alpha = 1;
+    if(alpha > FILTER_LOWPASS_ONE)
+        alpha = FILTER_LOWPASS_ONE;
+    lowpass->alpha = alpha;
+    lowpass->value = 0;
+    lowpass->primed = false;
+}
+
+/**
+  * @brief  Run a block through a low-pass, the first sample ever sets the
+  *         output.
+  * @param lowpass : filter state.
+  * @param samples : sample block, values up to FILTER_SAMPLE_MAX.
+  * @param count : number of samples.
+  * @return output after the last sample, rounded
+  */
+uint16_t Filter_lowpass(FilterLowpass *lowpass, const uint16_t *samples, uint16_t count)
+{
+    if(count && !lowpass->primed)
+    {
+        lowpass->value = samples[0] << FILTER_LOWPASS_FRAC;
+        lowpass->primed = true;
+    }
+
+#ifdef FILTER_SIMD
+    Filter_lowpassSimd(lowpass, samples, count);
+#else
+    Filter_lowpassReference(lowpass, samples, count);
+#endif
+    return (lowpass->value + (1 << (FILTER_LOWPASS_FRAC - 1))) >> FILTER_LOWPASS_FRAC;
+}
+
+#ifdef FILTER_BENCHMARK
+/**
+  * @brief  Start the cycle counter.
+  * @param none
+  * @return cycle count, ns with FILTER_HOST
+  */
+static uint32_t Filter_cycles(void)
+{
+#ifdef FILTER_HOST
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000 + now.tv_nsec);
+#else
+    HWREG(CPU_SCS_BASE + CPU_SCS_O_DEMCR) |= CPU_SCS_DEMCR_TRCENA;
+    HWREG(CPU_DWT_BASE + CPU_DWT_O_CTRL) |= CPU_DWT_CTRL_CYCCNTENA;
+    return HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT);
+#endif
+}
+
+/**
+  * @brief  Compare the kernels with the reference versions on a noisy
+  *         block and print the cycles per sample.
+  * @param none
+  * @return true when the kernels match the reference versions
+  */
+bool Filter_benchmark(void)
+{
+    static uint16_t samples[FILTER_BENCHMARK_SAMPLES];
+    FilterLowpass lowpass;
+    FilterLowpass reference;
+    uint32_t seed = 1;
+    uint32_t start;
+    uint32_t sumCycles;
+    uint32_t sumReferenceCycles;
+    uint32_t lowpassCycles;
+    uint32_t lowpassReferenceCycles;
+    uint32_t sum;
+    uint32_t sumReference;
+    bool match = true;
+    uint16_t i;
+
+    for(i = 0; i < FILTER_BENCHMARK_SAMPLES; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        samples[i] = (i < 2) ? FILTER_SAMPLE_MAX : (2000 + ((seed >> 16) & 0x1FF));
+    }
+
+    /* Unaligned start and odd count take the scalar paths too */
+    start = Filter_cycles();
+    sum = Filter_sum(samples + 1, FILTER_BENCHMARK_SAMPLES - 2);
+    sumCycles = Filter_cycles() - start;
+    start = Filter_cycles();
+    sumReference = Filter_sumReference(samples + 1, FILTER_BENCHMARK_SAMPLES - 2);
+    sumReferenceCycles = Filter_cycles() - start;
+    if(sum != sumReference)
+    {
+        System_printf("filter benchmark: sum mismatch\r\n");
+        match = false;
+    }
+
+    Filter_lowpassInit(&lowpass, 1000);
+    Filter_lowpassInit(&reference, 1000);
+    lowpass.primed = reference.primed = true;
+    start = Filter_cycles();
+    Filter_lowpass(&lowpass, samples, FILTER_BENCHMARK_SAMPLES);
+    lowpassCycles = Filter_cycles() - start;
+    start = Filter_cycles();
+    Filter_lowpassReference(&reference, samples, FILTER_BENCHMARK_SAMPLES);
+    lowpassReferenceCycles = Filter_cycles() - start;
+    if(lowpass.value != reference.value)
+    {
+        System_printf("filter benchmark: lowpass mismatch\r\n");
+        match = false;
+    }
+
+    /* Cycles per 100 samples */
+    System_printf("filter " FILTER_BENCHMARK_UNIT "/100 samples: sum %d (reference %d), lowpass %d (reference %d)\r\n",
+                  sumCycles * 100 / (FILTER_BENCHMARK_SAMPLES - 2),
+                  sumReferenceCycles * 100 / (FILTER_BENCHMARK_SAMPLES - 2),
+                  lowpassCycles * 100 / FILTER_BENCHMARK_SAMPLES,
+                  lowpassReferenceCycles * 100 / FILTER_BENCHMARK_SAMPLES);
+    return match;
+}
+#endif
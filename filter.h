@@ -0,0 +1,59 @@
+#ifndef _FILTER_H_
+#define _FILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Kernels work on 12-bit ADC values, packed in signed halfwords on target */
+#define FILTER_SAMPLE_MAX       0x0FFF
+
+/* Low-pass coefficient 1.0, Q14 */
+#define FILTER_LOWPASS_ONE      16384
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/* Exponential moving average, value += (sample - value) / 2^shift */
+typedef struct _filterEma {
+    uint32_t value;         //Q8
+    uint8_t shift;
+    bool primed;
+} FilterEma;
+
+/* First order IIR low-pass, value = alpha * sample + (1 - alpha) * value */
+typedef struct _filterLowpass {
+    uint16_t alpha;         //Q14, 1 ~ FILTER_LOWPASS_ONE
+    uint16_t value;         //Q3
+    bool primed;
+} FilterLowpass;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern uint32_t Filter_sum(const uint16_t *samples, uint16_t count);
+extern uint16_t Filter_mean(const uint16_t *samples, uint16_t count);
+extern uint16_t Filter_trimmedMean(uint16_t *samples, uint16_t count, uint16_t trim);
+extern uint16_t Filter_median(uint16_t *samples, uint16_t count);
+extern void Filter_emaInit(FilterEma *ema, uint8_t shift);
+extern uint16_t Filter_ema(FilterEma *ema, uint16_t sample);
+extern void Filter_lowpassInit(FilterLowpass *lowpass, uint16_t alpha);
+extern uint16_t Filter_lowpass(FilterLowpass *lowpass, const uint16_t *samples, uint16_t count);
+#ifdef FILTER_BENCHMARK
+extern bool Filter_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_FILTER_H_
@@ -0,0 +1,264 @@
+/*
+ *  ======== fuel_gauge.c ========
+ *  Battery state of charge estimator.
+ *
+ *  The cached battery voltage is scaled to one cell, corrected for the
+ *  temperature and looked up in the discharge table of the battery
+ *  chemistry. The sag seen during a motor move gives the internal
+ *  resistance of the pack, which tells whether the pack still holds up
+ *  under the motor load: a worn or cold pack can read a fair voltage at
+ *  rest and still brown out when the motor starts. Everything is integer
+ *  arithmetic on cached values, an update takes a few microseconds.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+#include "tlog.h"
+#include "fuel_gauge.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Temperature of the discharge tables, 1/100 degree C */
+#define FUEL_GAUGE_TABLE_TEMP       2500
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/* Point of a discharge table, cell voltage at rest for a charge */
+typedef struct _fuelGaugePoint {
+    uint16_t milliVolt;
+    uint8_t percent;
+} FuelGaugePoint;
+
+typedef struct _fuelGaugeTable {
+    const FuelGaugePoint *points;       //by decreasing voltage
+    uint8_t count;
+    uint16_t cutoffMilliVolt;           //lowest cell voltage under motor load
+    uint16_t tempCoeffMicroVolt;        //rest voltage drop per degree C below the table temperature
+} FuelGaugeTable;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static const FuelGaugePoint fuelGaugeAlkaline[] = {
+    {1580, 100}, {1500, 90}, {1440, 80}, {1390, 70}, {1350, 60}, {1310, 50},
+    {1270, 40}, {1230, 30}, {1180, 20}, {1120, 10}, {1050, 5}, {1000, 0},
+};
+
+/* Lithium iron disulfide AA, flat until close to the end */
+static const FuelGaugePoint fuelGaugeLithium[] = {
+    {1780, 100}, {1720, 95}, {1680, 85}, {1640, 70}, {1600, 50}, {1560, 30},
+    {1500, 15}, {1440, 8}, {1350, 3}, {1100, 0},
+};
+
+static const FuelGaugeTable fuelGaugeTables[FUEL_GAUGE_CHEMISTRY_COUNT] = {
+    [FUEL_GAUGE_ALKALINE] = {fuelGaugeAlkaline, sizeof(fuelGaugeAlkaline) / sizeof(FuelGaugePoint), 1000, 1000},
+    [FUEL_GAUGE_LITHIUM] = {fuelGaugeLithium, sizeof(fuelGaugeLithium) / sizeof(FuelGaugePoint), 1050, 300},
+};
+
+static const FuelGaugeTable *fuelGaugeTable = &fuelGaugeTables[FUEL_GAUGE_ALKALINE];
+
+static int16_t fuelGaugeTemperature;    //1/100 degree C
+static uint16_t fuelGaugeResistance;    //pack, milliohm, 0 when not known
+static uint16_t fuelGaugeCellMilliVolt;
+static uint8_t fuelGaugePercent;
+static bool fuelGaugeValid;
+static bool fuelGaugeLow;
+
+/**
+  * @brief  Convert a voltage at the ADC input to one cell.
+  * @param microVolt : ADC input voltage.
+  * @return cell micro volt
+  */
+static uint32_t FuelGauge_toCell(uint32_t microVolt)
+{
+    return microVolt * FUEL_GAUGE_DIVIDER_NUM / FUEL_GAUGE_DIVIDER_DEN / FUEL_GAUGE_CELLS;
+}
+
+/**
+  * @brief  Look a cell voltage up in the discharge table.
+  * @param milliVolt : cell voltage at rest.
+  * @return state of charge in percent
+  */
+static uint8_t FuelGauge_lookup(uint16_t milliVolt)
+{
+    const FuelGaugePoint *points = fuelGaugeTable->points;
+    uint8_t last = fuelGaugeTable->count - 1;
+    uint8_t i;
+
+    if(milliVolt >= points[0].milliVolt)
+        return points[0].percent;
+    if(milliVolt <= points[last].milliVolt)
+        return points[last].percent;
+
+    for(i = 1; milliVolt < points[i].milliVolt; i++);
+
+    /* Linear between points[i] and points[i - 1] */
+    return points[i].percent +
+           (uint32_t)(milliVolt - points[i].milliVolt) * (points[i - 1].percent - points[i].percent) /
+           (points[i - 1].milliVolt - points[i].milliVolt);
+}
+
+/**
+  * @brief  Initialize the fuel gauge.
+  * @param chemistry : battery chemistry.
+  * @return none
+  */
+void FuelGauge_init(FuelGaugeChemistry chemistry)
+{
+    if(chemistry >= FUEL_GAUGE_CHEMISTRY_COUNT)
+        chemistry = FUEL_GAUGE_ALKALINE;
+    fuelGaugeTable = &fuelGaugeTables[chemistry];
+
+    fuelGaugeTemperature = FUEL_GAUGE_TEMP_NONE;
+    fuelGaugeResistance = 0;
+    fuelGaugeCellMilliVolt = 0;
+    fuelGaugePercent = 0;
+    fuelGaugeValid = false;
+    fuelGaugeLow = false;
+}
+
+/**
+  * @brief  Set the battery temperature used by the next updates.
+  * @param centiCelsius : temperature in 1/100 degree C, FUEL_GAUGE_TEMP_NONE
+  *                       when not known.
+  * @return none
+  */
+void FuelGauge_setTemperature(int16_t centiCelsius)
+{
+    fuelGaugeTemperature = centiCelsius;
+}
+
+/**
+  * @brief  Update the state of charge from a battery measurement at rest.
+  * @param microVolt : battery voltage at the ADC input.
+  * @return none
+  */
+void FuelGauge_update(uint32_t microVolt)
+{
+    uint32_t cellMicroVolt = FuelGauge_toCell(microVolt);
+    uint32_t loadMilliVolt;
+    uint8_t percent;
+    bool low;
+
+    fuelGaugeCellMilliVolt = cellMicroVolt / 1000;
+
+    /* A cold cell reads low at rest for the same charge */
+    if((fuelGaugeTemperature != FUEL_GAUGE_TEMP_NONE) && (fuelGaugeTemperature < FUEL_GAUGE_TABLE_TEMP))
+        cellMicroVolt += (uint32_t)(FUEL_GAUGE_TABLE_TEMP - fuelGaugeTemperature) * fuelGaugeTable->tempCoeffMicroVolt / 100;
+
+    percent = FuelGauge_lookup(cellMicroVolt / 1000);
+
+    /* Don't follow the recovery after a move or the noise */
+    if(!fuelGaugeValid ||
+       (percent >= fuelGaugePercent + FUEL_GAUGE_STEP_PERCENT) ||
+       (percent + FUEL_GAUGE_STEP_PERCENT <= fuelGaugePercent) ||
+       (percent == 0))
+        fuelGaugePercent = percent;
+    fuelGaugeValid = true;
+
+    /* Cell voltage expected while the motor runs, mA * milliohm = uV */
+    loadMilliVolt = fuelGaugeCellMilliVolt;
+    if(fuelGaugeResistance)
+    {
+        uint32_t dropMilliVolt = (uint32_t)FUEL_GAUGE_MOTOR_MA * fuelGaugeResistance / 1000 / FUEL_GAUGE_CELLS;
+
+        loadMilliVolt = (loadMilliVolt > dropMilliVolt) ? (loadMilliVolt - dropMilliVolt) : 0;
+    }
+
+    if(fuelGaugeLow)
+        low = (fuelGaugePercent < FUEL_GAUGE_LOW_PERCENT + FUEL_GAUGE_HYSTERESIS_PERCENT) ||
+              (loadMilliVolt < fuelGaugeTable->cutoffMilliVolt);
+    else
+        low = (fuelGaugePercent <= FUEL_GAUGE_LOW_PERCENT) ||
+              (loadMilliVolt < fuelGaugeTable->cutoffMilliVolt);
+
+    if(low && !fuelGaugeLow)
+        TLOG3(TLOG_BATTERY_LOW, fuelGaugePercent, fuelGaugeCellMilliVolt, loadMilliVolt);
+    else if(!low && fuelGaugeLow)
+        TLOG3(TLOG_BATTERY_OK, fuelGaugePercent, fuelGaugeCellMilliVolt, loadMilliVolt);
+    fuelGaugeLow = low;
+}
+
+/**
+  * @brief  Update the internal resistance from a motor move.
+  * @param restMicroVolt : battery voltage at the ADC input before the move.
+  * @param loadMicroVolt : lowest battery voltage at the ADC input during the move.
+  * @return none
+  */
+void FuelGauge_updateSag(uint32_t restMicroVolt, uint32_t loadMicroVolt)
+{
+    uint32_t dropMicroVolt;
+    uint32_t resistance;
+
+    if(loadMicroVolt >= restMicroVolt)
+        return;
+
+    /* Pack voltage drop over the motor current, uV / mA = milliohm */
+    dropMicroVolt = (restMicroVolt - loadMicroVolt) * FUEL_GAUGE_DIVIDER_NUM / FUEL_GAUGE_DIVIDER_DEN;
+    resistance = dropMicroVolt / FUEL_GAUGE_MOTOR_MA;
+    if(resistance > 0xFFFF)
+        resistance = 0xFFFF;
+
+    /* Smooth over moves, the start current varies with the door */
+    if(fuelGaugeResistance == 0)
+        fuelGaugeResistance = resistance;
+    else
+        fuelGaugeResistance = (3 * (uint32_t)fuelGaugeResistance + resistance) / 4;
+}
+
+/**
+  * @brief  Check whether the state of charge is available.
+  * @param none
+  * @return true after the first update
+  */
+bool FuelGauge_isValid(void)
+{
+    return fuelGaugeValid;
+}
+
+/**
+  * @brief  State of charge.
+  * @param none
+  * @return percent
+  */
+uint8_t FuelGauge_getPercent(void)
+{
+    return fuelGaugePercent;
+}
+
+/**
+  * @brief  Check whether the battery should be replaced: low charge, or
+  *         not able to hold the motor load any more.
+  * @param none
+  * @return true when low
+  */
+bool FuelGauge_isLow(void)
+{
+    return fuelGaugeLow;
+}
+
+/**
+  * @brief  Cell voltage of the last update, before temperature correction.
+  * @param none
+  * @return milli volt
+  */
+uint16_t FuelGauge_getCellMilliVolt(void)
+{
+    return fuelGaugeCellMilliVolt;
+}
+
+/**
+  * @brief  Pack internal resistance seen during motor moves.
+  * @param none
+  * @return milliohm, 0 when no move seen yet
+  */
+uint16_t FuelGauge_getResistance(void)
+{
+    return fuelGaugeResistance;
+}
@@ -0,0 +1,67 @@
+#ifndef _FUEL_GAUGE_H_
+#define _FUEL_GAUGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Battery pack: cells in series, and the divider between the pack and the
+   ADC input, pack voltage = input voltage * NUM / DEN */
+#define FUEL_GAUGE_CELLS                4
+#define FUEL_GAUGE_DIVIDER_NUM          3
+#define FUEL_GAUGE_DIVIDER_DEN          1
+
+/* Motor current used to turn the sag into an internal resistance */
+#define FUEL_GAUGE_MOTOR_MA             300
+
+/* Low battery below this charge, cleared again above it plus the hysteresis */
+#define FUEL_GAUGE_LOW_PERCENT          15
+#define FUEL_GAUGE_HYSTERESIS_PERCENT   5
+
+/* The reported charge only moves by steps of at least this much */
+#define FUEL_GAUGE_STEP_PERCENT         2
+
+/* Battery chemistry fitted, FUEL_GAUGE_ALKALINE or FUEL_GAUGE_LITHIUM */
+#ifndef FUEL_GAUGE_CHEMISTRY
+#define FUEL_GAUGE_CHEMISTRY            FUEL_GAUGE_ALKALINE
+#endif
+
+/* Temperature not known, no correction */
+#define FUEL_GAUGE_TEMP_NONE            ((int16_t)0x8000)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum _fuelGaugeChemistry {
+    FUEL_GAUGE_ALKALINE,
+    FUEL_GAUGE_LITHIUM,
+    FUEL_GAUGE_CHEMISTRY_COUNT,
+} FuelGaugeChemistry;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void FuelGauge_init(FuelGaugeChemistry chemistry);
+extern void FuelGauge_setTemperature(int16_t centiCelsius);
+extern void FuelGauge_update(uint32_t microVolt);
+extern void FuelGauge_updateSag(uint32_t restMicroVolt, uint32_t loadMicroVolt);
+extern bool FuelGauge_isValid(void);
+extern uint8_t FuelGauge_getPercent(void);
+extern bool FuelGauge_isLow(void);
+extern uint16_t FuelGauge_getCellMilliVolt(void);
+extern uint16_t FuelGauge_getResistance(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_FUEL_GAUGE_H_
@@ -0,0 +1,382 @@
+/*
+ *  ======== keypad_auth.c ========
+ *  Authenticated keypad frames.
+ *
+ *  KEYPAD_MSG_SECURE frames carry an AES-128 CCM encrypted inner message
+ *  and a counter. The CCM operation runs on the AESCCM crypto engine, or
+ *  in software (aes_ccm.c) when the engine can't be opened or when built
+ *  with KEYPAD_AUTH_SOFTWARE. Both give the same result.
+ *
+ *  A frame is only accepted when its counter is above the last accepted
+ *  one. The last counter is appended to a log in the Board_NVSKEYPADAUTH
+ *  region so a recorded frame can't be replayed after a reset either.
+ *  The log uses two sectors in turn: when the current one is full the
+ *  other is erased and continues the log, and the highest counter of
+ *  both is the one restored at init.
+ */
+
+#include <string.h>
+
+/* XDC module Headers */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/drivers/NVS.h>
+#ifndef KEYPAD_AUTH_SOFTWARE
+#include <ti/drivers/AESCCM.h>
+#include <ti/drivers/cryptoutils/cryptokey/CryptoKeyPlaintext.h>
+#endif
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "aes_ccm.h"
+#include "tlog.h"
+#include "keypad_auth.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define KEYPAD_AUTH_AAD_SIZE        2
+
+/* Counter log records, an erased record reads as KEYPAD_AUTH_RECORD_FREE */
+#define KEYPAD_AUTH_RECORD_FREE     0xFFFFFFFF
+#define KEYPAD_AUTH_RECORD_SIZE     sizeof(uint32_t)
+#define KEYPAD_AUTH_SCAN_RECORDS    16
+
+#ifdef KEYPAD_AUTH_BENCHMARK
+#define KEYPAD_AUTH_BENCHMARK_LOOPS 100
+#endif
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static AesCcmContext keypadAuthContext;
+#ifndef KEYPAD_AUTH_SOFTWARE
+static uint8_t keypadAuthKey[AES_CCM_KEY_SIZE] = KEYPAD_AUTH_KEY;   //in RAM for the crypto DMA
+static CryptoKey keypadAuthCryptoKey;
+static AESCCM_Handle keypadAuthAesccm = NULL;
+#endif
+
+static NVS_Handle keypadAuthNvs = NULL;
+static size_t keypadAuthSectorSize;
+static uint8_t keypadAuthSector;        //sector holding the newest record
+static size_t keypadAuthWriteOffset;    //next free record in that sector
+
+static uint32_t keypadAuthCounter;      //last accepted counter
+static uint32_t keypadAuthRejectCount;
+
+/**
+  * @brief  Read a little endian 32-bit value from a frame payload.
+  * @param frame : frame.
+  * @param index : payload index of the first byte.
+  * @return value
+  */
+static uint32_t KeypadAuth_payloadWord(const KeypadLinkFrame *frame, uint8_t index)
+{
+    return (uint32_t)KeypadLink_payloadByte(frame, index) |
+           ((uint32_t)KeypadLink_payloadByte(frame, index + 1) << 8) |
+           ((uint32_t)KeypadLink_payloadByte(frame, index + 2) << 16) |
+           ((uint32_t)KeypadLink_payloadByte(frame, index + 3) << 24);
+}
+
+/**
+  * @brief  Build the nonce of a frame.
+  * @param counter : frame counter.
+  * @param nonce : output, KEYPAD_AUTH_NONCE_SIZE bytes.
+  * @return none
+  */
+static void KeypadAuth_nonce(uint32_t counter, uint8_t *nonce)
+{
+    memset(nonce, 0, KEYPAD_AUTH_NONCE_SIZE);
+    nonce[0] = (uint8_t)counter;
+    nonce[1] = (uint8_t)(counter >> 8);
+    nonce[2] = (uint8_t)(counter >> 16);
+    nonce[3] = (uint8_t)(counter >> 24);
+    nonce[4] = KEYPAD_AUTH_DIR_KEYPAD;
+}
+
+/**
+  * @brief  Find the last record of one log sector.
+  * @param sector : sector number, 0 or 1.
+  * @param last : output, last counter, 0 when the sector is empty.
+  * @return offset of the first free record, keypadAuthSectorSize when full
+  */
+static size_t KeypadAuth_scanSector(uint8_t sector, uint32_t *last)
+{
+    uint32_t records[KEYPAD_AUTH_SCAN_RECORDS];
+    size_t base = sector * keypadAuthSectorSize;
+    size_t offset;
+    uint8_t i;
+
+    *last = 0;
+    for(offset = 0; offset < keypadAuthSectorSize; offset += sizeof(records))
+    {
+        if(NVS_read(keypadAuthNvs, base + offset, records, sizeof(records)) != NVS_STATUS_SUCCESS)
+            return keypadAuthSectorSize;
+        for(i = 0; i < KEYPAD_AUTH_SCAN_RECORDS; i++)
+        {
+            if(records[i] == KEYPAD_AUTH_RECORD_FREE)
+                return offset + i * KEYPAD_AUTH_RECORD_SIZE;
+            *last = records[i];
+        }
+    }
+    return keypadAuthSectorSize;
+}
+
+/**
+  * @brief  Restore the last accepted counter from the log.
+  * @param none
+  * @return none
+  */
+static void KeypadAuth_loadCounter(void)
+{
+    uint32_t last[2];
+    size_t next[2];
+
+    next[0] = KeypadAuth_scanSector(0, &last[0]);
+    next[1] = KeypadAuth_scanSector(1, &last[1]);
+
+    keypadAuthSector = (last[1] > last[0]) ? 1 : 0;
+    keypadAuthWriteOffset = next[keypadAuthSector];
+    keypadAuthCounter = last[keypadAuthSector];
+}
+
+/**
+  * @brief  Append the last accepted counter to the log.
+  * @param counter : counter to save.
+  * @return true when success
+  */
+static bool KeypadAuth_saveCounter(uint32_t counter)
+{
+    if(keypadAuthNvs == NULL)
+        return false;
+
+    if(keypadAuthWriteOffset >= keypadAuthSectorSize)
+    {
+        /* The full sector keeps the previous counters until the next switch */
+        keypadAuthSector ^= 1;
+        keypadAuthWriteOffset = 0;
+        if(NVS_erase(keypadAuthNvs, keypadAuthSector * keypadAuthSectorSize,
+                     keypadAuthSectorSize) != NVS_STATUS_SUCCESS)
+            return false;
+    }
+
+    if(NVS_write(keypadAuthNvs, keypadAuthSector * keypadAuthSectorSize + keypadAuthWriteOffset,
+                 &counter, KEYPAD_AUTH_RECORD_SIZE, NVS_WRITE_POST_VERIFY) != NVS_STATUS_SUCCESS)
+        return false;
+    keypadAuthWriteOffset += KEYPAD_AUTH_RECORD_SIZE;
+    return true;
+}
+
+/**
+  * @brief  CCM decrypt and verify, on the crypto engine when available.
+  * @param nonce : KEYPAD_AUTH_NONCE_SIZE bytes nonce.
+  * @param aad : KEYPAD_AUTH_AAD_SIZE bytes additional data.
+  * @param input : ciphertext.
+  * @param output : output, plaintext.
+  * @param length : ciphertext length.
+  * @param mac : KEYPAD_AUTH_MAC_SIZE bytes MAC.
+  * @param hardware : true to use the crypto engine.
+  * @return KEYPAD_AUTH_OK when the MAC is valid
+  */
+static KeypadAuthStatus KeypadAuth_decrypt(uint8_t *nonce, uint8_t *aad, uint8_t *input,
+                                           uint8_t *output, uint8_t length, uint8_t *mac, bool hardware)
+{
+#ifndef KEYPAD_AUTH_SOFTWARE
+    AESCCM_Operation operation;
+    int_fast16_t status;
+
+    if(hardware && keypadAuthAesccm)
+    {
+        AESCCM_Operation_init(&operation);
+        operation.key = &keypadAuthCryptoKey;
+        operation.aad = aad;
+        operation.aadLength = KEYPAD_AUTH_AAD_SIZE;
+        operation.input = input;
+        operation.output = output;
+        operation.inputLength = length;
+        operation.nonce = nonce;
+        operation.nonceLength = KEYPAD_AUTH_NONCE_SIZE;
+        operation.mac = mac;
+        operation.macLength = KEYPAD_AUTH_MAC_SIZE;
+
+        status = AESCCM_oneStepDecrypt(keypadAuthAesccm, &operation);
+        if(status == AESCCM_STATUS_SUCCESS)
+            return KEYPAD_AUTH_OK;
+        memset(output, 0, length);
+        return (status == AESCCM_STATUS_MAC_INVALID) ? KEYPAD_AUTH_MAC_INVALID : KEYPAD_AUTH_ERROR;
+    }
+#endif
+
+    if(AesCcm_decrypt(&keypadAuthContext, nonce, KEYPAD_AUTH_NONCE_SIZE, aad, KEYPAD_AUTH_AAD_SIZE,
+                      input, output, length, mac, KEYPAD_AUTH_MAC_SIZE))
+        return KEYPAD_AUTH_OK;
+    return KEYPAD_AUTH_MAC_INVALID;
+}
+
+/**
+  * @brief  Initialize authenticated keypad frames.
+  * @param none
+  * @return true when the replay counter store is available
+  */
+bool KeypadAuth_init(void)
+{
+    const uint8_t key[AES_CCM_KEY_SIZE] = KEYPAD_AUTH_KEY;
+    NVS_Params nvsParams;
+    NVS_Attrs nvsAttrs;
+#ifndef KEYPAD_AUTH_SOFTWARE
+    AESCCM_Params aesccmParams;
+#endif
+
+    AesCcm_setKey(&keypadAuthContext, key);
+    keypadAuthCounter = 0;
+    keypadAuthRejectCount = 0;
+
+#ifndef KEYPAD_AUTH_SOFTWARE
+    CryptoKeyPlaintext_initKey(&keypadAuthCryptoKey, keypadAuthKey, sizeof(keypadAuthKey));
+    AESCCM_Params_init(&aesccmParams);
+    aesccmParams.returnBehavior = AESCCM_RETURN_BEHAVIOR_POLLING;
+    keypadAuthAesccm = AESCCM_open(Board_AESCCM0, &aesccmParams);
+    if(keypadAuthAesccm == NULL)
+        TLOG0(TLOG_AESCCM_FAILED);
+#endif
+
+    NVS_Params_init(&nvsParams);
+    keypadAuthNvs = NVS_open(Board_NVSKEYPADAUTH, &nvsParams);
+    if(keypadAuthNvs == NULL)
+    {
+        TLOG0(TLOG_KEYPAD_COUNTER_FAILED);
+        return false;
+    }
+    NVS_getAttrs(keypadAuthNvs, &nvsAttrs);
+    keypadAuthSectorSize = nvsAttrs.sectorSize;
+
+    KeypadAuth_loadCounter();
+    TLOG1(TLOG_KEYPAD_COUNTER, keypadAuthCounter);
+    return true;
+}
+
+/**
+  * @brief  Verify and decrypt a KEYPAD_MSG_SECURE frame.
+  * @param frame : frame returned by KeypadLink_parse().
+  * @param message : output, inner message (type, payload), KEYPAD_AUTH_MAX_MESSAGE bytes.
+  * @param length : output, inner message length.
+  * @return KEYPAD_AUTH_OK when the frame is authentic and new
+  */
+KeypadAuthStatus KeypadAuth_open(const KeypadLinkFrame *frame, uint8_t *message, uint8_t *length)
+{
+    uint8_t nonce[KEYPAD_AUTH_NONCE_SIZE];
+    uint8_t aad[KEYPAD_AUTH_AAD_SIZE];
+    uint8_t input[KEYPAD_AUTH_MAX_MESSAGE];
+    uint8_t mac[KEYPAD_AUTH_MAC_SIZE];
+    uint8_t size;
+    uint32_t counter;
+    KeypadAuthStatus status;
+    uint8_t i;
+
+    *length = 0;
+    if((frame->type != KEYPAD_MSG_SECURE) || (frame->length <= KEYPAD_AUTH_OVERHEAD))
+    {
+        keypadAuthRejectCount++;
+        return KEYPAD_AUTH_MALFORMED;
+    }
+    size = frame->length - KEYPAD_AUTH_OVERHEAD;
+
+    /* Replays are dropped before spending time on the MAC */
+    counter = KeypadAuth_payloadWord(frame, 0);
+    if(counter == KEYPAD_AUTH_RECORD_FREE)
+    {
+        keypadAuthRejectCount++;
+        return KEYPAD_AUTH_MALFORMED;
+    }
+    if(counter <= keypadAuthCounter)
+    {
+        keypadAuthRejectCount++;
+        return KEYPAD_AUTH_REPLAY;
+    }
+
+    for(i = 0; i < size; i++)
+    {
+        input[i] = KeypadLink_payloadByte(frame, KEYPAD_AUTH_COUNTER_SIZE + i);
+    }
+    for(i = 0; i < KEYPAD_AUTH_MAC_SIZE; i++)
+    {
+        mac[i] = KeypadLink_payloadByte(frame, KEYPAD_AUTH_COUNTER_SIZE + size + i);
+    }
+    aad[0] = frame->type;
+    aad[1] = frame->length;
+    KeypadAuth_nonce(counter, nonce);
+
+    status = KeypadAuth_decrypt(nonce, aad, input, message, size, mac, true);
+    if(status != KEYPAD_AUTH_OK)
+    {
+        keypadAuthRejectCount++;
+        return status;
+    }
+
+    keypadAuthCounter = counter;
+    if(!KeypadAuth_saveCounter(counter))
+        TLOG0(TLOG_KEYPAD_COUNTER_UNSAVED);
+    *length = size;
+    return KEYPAD_AUTH_OK;
+}
+
+#ifdef KEYPAD_AUTH_BENCHMARK
+/**
+  * @brief  Print the time to open one full size frame on the crypto engine
+  *         and in software.
+  * @param none
+  * @return none
+  */
+void KeypadAuth_benchmark(void)
+{
+    uint8_t nonce[KEYPAD_AUTH_NONCE_SIZE];
+    uint8_t aad[KEYPAD_AUTH_AAD_SIZE] = {KEYPAD_MSG_SECURE, KEYPAD_LINK_MAX_PAYLOAD};
+    uint8_t plain[KEYPAD_AUTH_MAX_MESSAGE];
+    uint8_t cipher[KEYPAD_AUTH_MAX_MESSAGE];
+    uint8_t output[KEYPAD_AUTH_MAX_MESSAGE];
+    uint8_t mac[KEYPAD_AUTH_MAC_SIZE];
+    uint32_t start;
+    uint32_t hardwareTicks = 0;
+    uint32_t softwareTicks;
+    uint16_t i;
+
+    memset(plain, '5', sizeof(plain));
+    plain[0] = KEYPAD_MSG_KEY;
+    KeypadAuth_nonce(1, nonce);
+    AesCcm_encrypt(&keypadAuthContext, nonce, KEYPAD_AUTH_NONCE_SIZE, aad, KEYPAD_AUTH_AAD_SIZE,
+                   plain, cipher, sizeof(cipher), mac, KEYPAD_AUTH_MAC_SIZE);
+
+#ifndef KEYPAD_AUTH_SOFTWARE
+    if(keypadAuthAesccm)
+    {
+        start = Clock_getTicks();
+        for(i = 0; i < KEYPAD_AUTH_BENCHMARK_LOOPS; i++)
+        {
+            KeypadAuth_decrypt(nonce, aad, cipher, output, sizeof(cipher), mac, true);
+        }
+        hardwareTicks = Clock_getTicks() - start;
+        if(memcmp(output, plain, sizeof(plain)))
+            System_printf("keypad auth benchmark: hardware mismatch\r\n");
+    }
+#endif
+
+    start = Clock_getTicks();
+    for(i = 0; i < KEYPAD_AUTH_BENCHMARK_LOOPS; i++)
+    {
+        KeypadAuth_decrypt(nonce, aad, cipher, output, sizeof(cipher), mac, false);
+    }
+    softwareTicks = Clock_getTicks() - start;
+    if(memcmp(output, plain, sizeof(plain)))
+        System_printf("keypad auth benchmark: software mismatch\r\n");
+
+    /* Per frame time in us */
+    System_printf("keypad auth frame: hardware %u us, software %u us\r\n",
+                  hardwareTicks * Clock_tickPeriod / KEYPAD_AUTH_BENCHMARK_LOOPS,
+                  softwareTicks * Clock_tickPeriod / KEYPAD_AUTH_BENCHMARK_LOOPS);
+}
+#endif
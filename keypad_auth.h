@@ -0,0 +1,77 @@
+#ifndef _KEYPAD_AUTH_H_
+#define _KEYPAD_AUTH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keypad_link.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/*
+ * Payload of a KEYPAD_MSG_SECURE frame:
+ *
+ *  COUNTER[4] | CIPHERTEXT[n] | MAC[4]
+ *
+ * COUNTER is little endian and must increase with every frame. The
+ * plaintext is an inner message, its type byte followed by its payload.
+ * AES-128 CCM with a 13-byte nonce (COUNTER | KEYPAD_AUTH_DIR_KEYPAD |
+ * 8 zero bytes) and the frame TYPE and LEN bytes as additional data.
+ */
+#define KEYPAD_AUTH_COUNTER_SIZE    4
+#define KEYPAD_AUTH_MAC_SIZE        4
+#define KEYPAD_AUTH_NONCE_SIZE      13
+#define KEYPAD_AUTH_OVERHEAD        (KEYPAD_AUTH_COUNTER_SIZE + KEYPAD_AUTH_MAC_SIZE)
+#define KEYPAD_AUTH_MAX_MESSAGE     (KEYPAD_LINK_MAX_PAYLOAD - KEYPAD_AUTH_OVERHEAD)
+
+/* Main task stack added for opening a frame: KeypadAuth_open() and the
+ * software CCM below it take about 300 bytes of locals, saved registers
+ * and the AESCCM operation, rounded up for margin */
+#define KEYPAD_AUTH_STACK_SIZE      512
+
+/* Nonce direction byte of frames sent by the keypad */
+#define KEYPAD_AUTH_DIR_KEYPAD      0x01
+
+/* Link key shared with the keypad, set from the build:
+ * -DKEYPAD_AUTH_KEY="{0x.., ...}" (16 bytes). The readable default is for
+ * debug builds only */
+#if defined(KEYPAD_AUTH) && !defined(DEBUG) && !defined(KEYPAD_AUTH_KEY)
+#error "KEYPAD_AUTH_KEY must be set outside debug builds"
+#endif
+#ifndef KEYPAD_AUTH_KEY
+#define KEYPAD_AUTH_KEY     {0x4B, 0x61, 0x70, 0x74, 0x75, 0x72, 0x65, 0x44, \
+                             0x32, 0x2D, 0x6B, 0x65, 0x79, 0x70, 0x61, 0x64}
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum _keypadAuthStatus {
+    KEYPAD_AUTH_OK,
+    KEYPAD_AUTH_MALFORMED,      //bad length or counter
+    KEYPAD_AUTH_REPLAY,         //counter not newer than the last accepted frame
+    KEYPAD_AUTH_MAC_INVALID,
+    KEYPAD_AUTH_ERROR,          //crypto engine failure
+} KeypadAuthStatus;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern bool KeypadAuth_init(void);
+extern KeypadAuthStatus KeypadAuth_open(const KeypadLinkFrame *frame, uint8_t *message, uint8_t *length);
+#ifdef KEYPAD_AUTH_BENCHMARK
+extern void KeypadAuth_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_KEYPAD_AUTH_H_
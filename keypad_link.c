@@ -0,0 +1,215 @@
+/*
+ *  ======== keypad_link.c ========
+ *  Framed keypad link parser.
+ *
+ *  The parser works in place on the receive FIFO: bytes are only peeked
+ *  until a whole frame with a good CRC is at the head, then the caller
+ *  reads the payload in place and consumes the frame. On a bad sync byte,
+ *  length or CRC a single byte is dropped and the search restarts, so a
+ *  valid frame following garbage is found as soon as it is received.
+ */
+
+#include <stdbool.h>
+
+/* XDC module Headers */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/knl/Clock.h>
+
+#include "keypad_link.h"
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+/* CRC-8 (poly 0x07) nibble table */
+static const uint8_t keypadLinkCrcTable[16] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+};
+
+static bool keypadLinkPending;          //incomplete frame at the FIFO head
+static uint32_t keypadLinkPendingTick;  //time the incomplete frame was seen
+
+static uint32_t keypadLinkFrameCount;
+static uint32_t keypadLinkErrorCount;
+
+/**
+  * @brief  Update CRC-8 with one byte.
+  * @param crc : current CRC.
+  * @param data : byte to add.
+  * @return updated CRC
+  */
+static uint8_t KeypadLink_crc8(uint8_t crc, uint8_t data)
+{
+    crc ^= data;
+    crc = (crc << 4) ^ keypadLinkCrcTable[crc >> 4];
+    crc = (crc << 4) ^ keypadLinkCrcTable[crc >> 4];
+    return crc;
+}
+
+/**
+  * @brief  Peek one byte of the FIFO as unsigned.
+  * @param fifo : FIFO buffer.
+  * @param offset : position counted from the oldest byte.
+  * @return byte value
+  */
+static uint8_t KeypadLink_peek(FIFO_Buf *fifo, int offset)
+{
+    char byte = 0;
+
+    FIFOPeekByte(fifo, offset, &byte);
+    return (uint8_t)byte;
+}
+
+/**
+  * @brief  Drop the byte at the FIFO head and restart the frame search.
+  * @param fifo : FIFO buffer.
+  * @return none
+  */
+static void KeypadLink_resync(FIFO_Buf *fifo)
+{
+    FIFODiscardBytes(fifo, 1);
+    keypadLinkPending = false;
+    keypadLinkErrorCount++;
+}
+
+/**
+  * @brief  Initialize keypad link parser.
+  * @param none
+  * @return none
+  */
+void KeypadLink_init(void)
+{
+    keypadLinkPending = false;
+    keypadLinkFrameCount = 0;
+    keypadLinkErrorCount = 0;
+}
+
+/**
+  * @brief  Look for a complete frame at the head of the FIFO.
+  *         Garbage in front of it is dropped. An incomplete frame is left
+  *         in the FIFO and parsed again on the next call.
+  * @param fifo : receive FIFO.
+  * @param frame : output, view of the frame when found.
+  * @return true when a valid frame is at the FIFO head
+  */
+bool KeypadLink_parse(FIFO_Buf *fifo, KeypadLinkFrame *frame)
+{
+    int filled;
+    uint8_t length;
+    uint8_t crc;
+    int i;
+
+    for(;;)
+    {
+        filled = FIFOFilledNumber(fifo);
+
+        /* Skip to the next sync byte */
+        while((filled > 0) && (KeypadLink_peek(fifo, 0) != KEYPAD_LINK_SYNC))
+        {
+            KeypadLink_resync(fifo);
+            filled--;
+        }
+        if(filled < KEYPAD_LINK_HEADER_SIZE)
+            break;
+
+        length = KeypadLink_peek(fifo, 2);
+        if(length > KEYPAD_LINK_MAX_PAYLOAD)
+        {
+            KeypadLink_resync(fifo);
+            continue;
+        }
+
+        if(filled < KEYPAD_LINK_HEADER_SIZE + length + KEYPAD_LINK_CRC_SIZE)
+            break;
+
+        crc = 0;
+        for(i = 1; i < KEYPAD_LINK_HEADER_SIZE + length; i++)
+        {
+            crc = KeypadLink_crc8(crc, KeypadLink_peek(fifo, i));
+        }
+        if(crc != KeypadLink_peek(fifo, KEYPAD_LINK_HEADER_SIZE + length))
+        {
+            KeypadLink_resync(fifo);
+            continue;
+        }
+
+        keypadLinkPending = false;
+        keypadLinkFrameCount++;
+        frame->fifo = fifo;
+        frame->type = KeypadLink_peek(fifo, 1);
+        frame->length = length;
+        return true;
+    }
+
+    /* A false sync byte must not stall the link until more bytes arrive */
+    if(FIFOFilledNumber(fifo) > 0)
+    {
+        if(!keypadLinkPending)
+        {
+            keypadLinkPending = true;
+            keypadLinkPendingTick = Clock_getTicks();
+        }
+        else if((Clock_getTicks() - keypadLinkPendingTick) > (KEYPAD_LINK_FRAME_TIMEOUT_MS * 1000 / Clock_tickPeriod))
+        {
+            KeypadLink_resync(fifo);
+        }
+    }
+    return false;
+}
+
+/**
+  * @brief  Read one payload byte of a frame in place.
+  * @param frame : frame returned by KeypadLink_parse().
+  * @param index : payload byte index.
+  * @return payload byte, 0 when out of range
+  */
+uint8_t KeypadLink_payloadByte(const KeypadLinkFrame *frame, uint8_t index)
+{
+    if(index >= frame->length)
+        return 0;
+
+    return KeypadLink_peek(frame->fifo, KEYPAD_LINK_HEADER_SIZE + index);
+}
+
+/**
+  * @brief  Payload of a frame in place, when it doesn't wrap around the
+  *         end of the FIFO buffer. Valid until KeypadLink_consume().
+  * @param frame : frame returned by KeypadLink_parse().
+  * @return payload, NULL when it wraps
+  */
+const uint8_t *KeypadLink_payload(const KeypadLinkFrame *frame)
+{
+    FIFO_Buf *fifo = frame->fifo;
+    int index = fifo->readIndex + KEYPAD_LINK_HEADER_SIZE;
+
+    if(index >= fifo->size)
+        index -= fifo->size;
+    if(index + frame->length > fifo->size)
+        return NULL;
+    return (const uint8_t *)&fifo->buffer[index];
+}
+
+/**
+  * @brief  Release a frame from the FIFO.
+  * @param frame : frame returned by KeypadLink_parse().
+  * @return none
+  */
+void KeypadLink_consume(KeypadLinkFrame *frame)
+{
+    FIFODiscardBytes(frame->fifo, KEYPAD_LINK_HEADER_SIZE + frame->length + KEYPAD_LINK_CRC_SIZE);
+    frame->length = 0;
+}
+
+/**
+  * @brief  Check whether a byte is a valid key code.
+  * @param key : key code.
+  * @return true for '0'~'9', '*' and '#'
+  */
+bool KeypadLink_isKey(char key)
+{
+    return ((('0' <= key) && ('9' >= key)) || ('*' == key) || ('#' == key));
+}
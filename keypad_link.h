@@ -0,0 +1,68 @@
+#ifndef _KEYPAD_LINK_H_
+#define _KEYPAD_LINK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FIFO.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/*
+ * Frame layout on the keypad UART:
+ *
+ *  SYNC (0xA5) | TYPE | LEN | PAYLOAD[LEN] | CRC-8
+ *
+ * The CRC (poly 0x07, init 0x00) covers TYPE, LEN and PAYLOAD.
+ */
+#define KEYPAD_LINK_SYNC            0xA5
+#define KEYPAD_LINK_HEADER_SIZE     3
+#define KEYPAD_LINK_CRC_SIZE        1
+#define KEYPAD_LINK_MAX_PAYLOAD     16
+
+/* A started frame is dropped when it is not complete within this time */
+#define KEYPAD_LINK_FRAME_TIMEOUT_MS    50
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum _keypadMsgType {
+    KEYPAD_MSG_KEY = 0x01,          //payload: one or more key codes '0'~'9', '*', '#'
+    KEYPAD_MSG_PROXIMITY = 0x02,    //payload: 1 byte, 0: away, 1: near
+    KEYPAD_MSG_TOUCH = 0x03,        //payload: touch panel status bytes
+    KEYPAD_MSG_SECURE = 0x10,       //payload: authenticated inner message, see keypad_auth.h
+} KeypadMsgType;
+
+/*
+ * View of a validated frame still held in the receive FIFO. The payload is
+ * read in place with KeypadLink_payload() or KeypadLink_payloadByte() and
+ * released with KeypadLink_consume().
+ */
+typedef struct _keypadLinkFrame {
+    FIFO_Buf *fifo;
+    uint8_t type;
+    uint8_t length;
+} KeypadLinkFrame;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void KeypadLink_init(void);
+extern bool KeypadLink_parse(FIFO_Buf *fifo, KeypadLinkFrame *frame);
+extern uint8_t KeypadLink_payloadByte(const KeypadLinkFrame *frame, uint8_t index);
+extern const uint8_t *KeypadLink_payload(const KeypadLinkFrame *frame);
+extern void KeypadLink_consume(KeypadLinkFrame *frame);
+extern bool KeypadLink_isKey(char key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_KEYPAD_LINK_H_
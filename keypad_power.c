@@ -0,0 +1,197 @@
+/*
+ *  ======== keypad_power.c ========
+ *  Keypad controller power manager.
+ *
+ *  The keypad/touch controller is powered through Board_DIO11_KEYPAD_PWR.
+ *  Any keypad activity restarts an idle clock; when it expires the power
+ *  is cut. Opening the key cover (or KeypadPower_activity() from another
+ *  wake source) powers the controller again, and the owner is told once
+ *  the controller has warmed up so the first keypress isn't lost.
+ *  While the power is off the controller can't report proximity, so the
+ *  cover is the wake source in that state.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/drivers/PIN.h>
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "util.h"
+#include "tlog.h"
+#include "keypad_power.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#if KEYPAD_PWR_ON_LEVEL
+#define KEYPAD_PWR_PIN_ON       PIN_GPIO_HIGH
+#else
+#define KEYPAD_PWR_PIN_ON       PIN_GPIO_LOW
+#endif
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static PIN_Config keypadPowerPinTable[] = {
+    Board_DIO11_KEYPAD_PWR | PIN_GPIO_OUTPUT_EN | KEYPAD_PWR_PIN_ON | PIN_PUSHPULL |
+    PIN_DRVSTR_MAX,
+    Board_DIO1_COVER_DETECT | PIN_INPUT_EN | PIN_NOPULL | PIN_IRQ_BOTHEDGES,
+    PIN_TERMINATE
+};
+
+static PIN_Handle keypadPowerPinHandle = NULL;
+static PIN_State keypadPowerPinState;
+
+static Clock_Struct keypadWarmupClockStruct;
+static Clock_Struct keypadIdleClockStruct;
+
+static KeypadPowerCallback keypadPowerCallback = NULL;
+static uint32_t keypadIdleMs;
+static volatile bool keypadPowered;
+static volatile bool keypadReady;
+
+/**
+  * @brief  Drive the keypad power switch.
+  * @param on : true to power the controller.
+  * @return none
+  */
+static void KeypadPower_set(bool on)
+{
+    PIN_setOutputValue(keypadPowerPinHandle, Board_DIO11_KEYPAD_PWR,
+                       on ? KEYPAD_PWR_ON_LEVEL : !KEYPAD_PWR_ON_LEVEL);
+    keypadPowered = on;
+}
+
+/**
+  * @brief  Warm-up CLOCK callback function.
+  * @param arg0: input parameter for warm-up CLOCK callback function
+  * @return none
+  */
+static void KeypadPower_warmupFxn(UArg arg0)
+{
+    keypadReady = true;
+    if(keypadPowerCallback)
+        keypadPowerCallback(true);
+}
+
+/**
+  * @brief  Idle CLOCK callback function, cuts the keypad power. Runs with
+  *         interrupts disabled so that a cover or INT edge either restarts
+  *         the idle time before the check or powers the keypad on again
+  *         after the power is cut.
+  * @param arg0: input parameter for idle CLOCK callback function
+  * @return none
+  */
+static void KeypadPower_idleFxn(UArg arg0)
+{
+    UInt key;
+
+    key = Hwi_disable();
+    /* Activity since the clock expired restarted it */
+    if(!keypadPowered || Util_isActive(&keypadIdleClockStruct))
+    {
+        Hwi_restore(key);
+        return;
+    }
+
+    keypadReady = false;
+    Util_stopClock(&keypadWarmupClockStruct);
+    if(keypadPowerCallback)
+        keypadPowerCallback(false);
+    KeypadPower_set(false);
+    Hwi_restore(key);
+    TLOG0(TLOG_KEYPAD_POWER_OFF);
+}
+
+/**
+  * @brief  Cover detect pin interrupt callback.
+  * @param handle : PIN handle.
+  * @param pinId : pin that generated the interrupt.
+  * @return none
+  */
+static void KeypadPower_coverFxn(PIN_Handle handle, PIN_Id pinId)
+{
+    if(KeypadPower_isCoverOpen())
+        KeypadPower_activity();
+}
+
+/**
+  * @brief  Initialize keypad power manager, the keypad is powered on.
+  * @param callback : warm-up/power-off notification, may be NULL.
+  * @param idleMs : idle time before the power is cut, 0 to keep it on.
+  * @return none
+  */
+void KeypadPower_init(KeypadPowerCallback callback, uint32_t idleMs)
+{
+    keypadPowerCallback = callback;
+    keypadIdleMs = idleMs;
+    keypadPowered = true;
+    keypadReady = false;
+
+    Util_constructClock(&keypadWarmupClockStruct, KeypadPower_warmupFxn, KEYPAD_PWR_WARMUP_MS, 0, false, 0);
+    Util_constructClock(&keypadIdleClockStruct, KeypadPower_idleFxn, idleMs ? idleMs : 1, 0, false, 0);
+
+    keypadPowerPinHandle = PIN_open(&keypadPowerPinState, keypadPowerPinTable);
+    if(!keypadPowerPinHandle)
+    {
+        TLOG0(TLOG_KEYPAD_POWER_FAILED);
+        return;
+    }
+    PIN_registerIntCb(keypadPowerPinHandle, &KeypadPower_coverFxn);
+
+    Util_startClock(&keypadWarmupClockStruct);
+    if(idleMs)
+        Util_startClock(&keypadIdleClockStruct);
+}
+
+/**
+  * @brief  Report keypad activity: restarts the idle time and powers the
+  *         keypad on when it was off. Can be called from any context.
+  * @param none
+  * @return none
+  */
+void KeypadPower_activity(void)
+{
+    UInt key;
+
+    if(!keypadPowerPinHandle)
+        return;
+
+    key = Hwi_disable();
+    if(!keypadPowered)
+    {
+        KeypadPower_set(true);
+        Util_restartClock(&keypadWarmupClockStruct, KEYPAD_PWR_WARMUP_MS);
+        TLOG0(TLOG_KEYPAD_POWER_ON);
+    }
+    if(keypadIdleMs)
+        Util_restartClock(&keypadIdleClockStruct, keypadIdleMs);
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Check whether the keypad is powered and warmed up.
+  * @param none
+  * @return true when the keypad can report keys
+  */
+bool KeypadPower_isReady(void)
+{
+    return keypadReady;
+}
+
+/**
+  * @brief  Check whether the key cover is open.
+  * @param none
+  * @return true when the cover is open
+  */
+bool KeypadPower_isCoverOpen(void)
+{
+    return (PIN_getInputValue(Board_DIO1_COVER_DETECT) == KEYPAD_COVER_OPEN_LEVEL);
+}
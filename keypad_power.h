@@ -0,0 +1,51 @@
+#ifndef _KEYPAD_POWER_H_
+#define _KEYPAD_POWER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Level of Board_DIO11_KEYPAD_PWR that powers the keypad controller */
+#define KEYPAD_PWR_ON_LEVEL         0
+
+/* Level of Board_DIO1_COVER_DETECT when the keypad cover is open, active
+   low like the key cover check of the main loop */
+#define KEYPAD_COVER_OPEN_LEVEL     0
+
+/* Time from power on until the controller reports keys */
+#define KEYPAD_PWR_WARMUP_MS        150
+
+/* Keypad power is cut after this long without activity */
+#define KEYPAD_PWR_IDLE_MS          (5 * 60 * 1000)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*
+ * Called from a clock callback with true once the controller has warmed
+ * up after power on, and with false right before the power is cut.
+ */
+typedef void (*KeypadPowerCallback)(bool ready);
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void KeypadPower_init(KeypadPowerCallback callback, uint32_t idleMs);
+extern void KeypadPower_activity(void);
+extern bool KeypadPower_isReady(void);
+extern bool KeypadPower_isCoverOpen(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_KEYPAD_POWER_H_
@@ -0,0 +1,216 @@
+/*
+ *  ======== keypad_stats.c ========
+ *  Keypad receive path statistics.
+ *
+ *  Counts the bytes received from the keypad UART and the ones dropped
+ *  because the FIFO was full, keeps the FIFO high-water mark and measures
+ *  the latency from a UART read callback to the task processing the data,
+ *  as well as the delay from a keypad wake up to the UART being open.
+ *  Latencies go to a histogram so percentiles can be reported without
+ *  keeping samples. Used to tune FIFOSIZE and the UART read strategy,
+ *  with the host harness tests/keypad_sim.c that drives the same receive
+ *  path from a simulated keypad.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "tlog.h"
+#include "keypad_stats.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define KEYPAD_STATS_BUCKETS    9
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+/* Upper bound of each latency bucket in us, the last one is open */
+static const uint32_t keypadStatsBucketUs[KEYPAD_STATS_BUCKETS] = {
+    100, 500, 1000, 2000, 5000, 10000, 20000, 50000, 0xFFFFFFFF,
+};
+
+static uint32_t keypadStatsReceived;
+static uint32_t keypadStatsDropped;
+static int keypadStatsHighWater;
+static uint32_t keypadStatsLatencyMaxUs;
+static uint32_t keypadStatsHistogram[KEYPAD_STATS_BUCKETS];
+static uint32_t keypadStatsOpens;
+static uint32_t keypadStatsLateOpens;
+static uint32_t keypadStatsOpenMaxMs;
+
+static volatile bool keypadStatsPending;    //data waiting for the task
+static volatile uint32_t keypadStatsRxTick; //time the oldest waiting data came in
+static uint32_t keypadStatsReportTick;
+
+/**
+  * @brief  Clear the statistics.
+  * @param none
+  * @return none
+  */
+static void KeypadStats_clear(void)
+{
+    UInt key;
+    uint8_t i;
+
+    key = Hwi_disable();
+    keypadStatsReceived = 0;
+    keypadStatsDropped = 0;
+    keypadStatsHighWater = 0;
+    Hwi_restore(key);
+
+    keypadStatsLatencyMaxUs = 0;
+    keypadStatsOpens = 0;
+    keypadStatsLateOpens = 0;
+    keypadStatsOpenMaxMs = 0;
+    for(i = 0; i < KEYPAD_STATS_BUCKETS; i++)
+    {
+        keypadStatsHistogram[i] = 0;
+    }
+}
+
+/**
+  * @brief  Latency below which a share of the samples falls.
+  * @param total : number of samples.
+  * @param permille : share of the samples in 1/1000.
+  * @return bucket upper bound in us
+  */
+static uint32_t KeypadStats_percentile(uint32_t total, uint32_t permille)
+{
+    uint32_t target = (total * permille + 999) / 1000;
+    uint32_t sum = 0;
+    uint8_t i;
+
+    for(i = 0; i < KEYPAD_STATS_BUCKETS - 1; i++)
+    {
+        sum += keypadStatsHistogram[i];
+        if(sum >= target)
+            break;
+    }
+    return (i < KEYPAD_STATS_BUCKETS - 1) ? keypadStatsBucketUs[i] : keypadStatsLatencyMaxUs;
+}
+
+/**
+  * @brief  Initialize keypad statistics.
+  * @param none
+  * @return none
+  */
+void KeypadStats_init(void)
+{
+    KeypadStats_clear();
+    keypadStatsPending = false;
+    keypadStatsReportTick = Clock_getTicks();
+}
+
+/**
+  * @brief  Account for one UART read, called from the read callback.
+  * @param count : bytes received.
+  * @param queued : bytes put into the FIFO.
+  * @param fifoFilled : FIFO fill level after queuing.
+  * @return none
+  */
+void KeypadStats_received(size_t count, size_t queued, int fifoFilled)
+{
+    keypadStatsReceived += count;
+    if(queued < count)
+        keypadStatsDropped += count - queued;
+    if(fifoFilled > keypadStatsHighWater)
+        keypadStatsHighWater = fifoFilled;
+
+    if(count && !keypadStatsPending)
+    {
+        keypadStatsRxTick = Clock_getTicks();
+        keypadStatsPending = true;
+    }
+}
+
+/**
+  * @brief  Task side, the received data is being processed.
+  * @param none
+  * @return none
+  */
+void KeypadStats_processed(void)
+{
+    uint32_t latencyUs;
+    uint8_t i;
+
+    if(!keypadStatsPending)
+        return;
+
+    latencyUs = (Clock_getTicks() - keypadStatsRxTick) * Clock_tickPeriod;
+    keypadStatsPending = false;
+
+    if(latencyUs > keypadStatsLatencyMaxUs)
+        keypadStatsLatencyMaxUs = latencyUs;
+    for(i = 0; i < KEYPAD_STATS_BUCKETS - 1; i++)
+    {
+        if(latencyUs < keypadStatsBucketUs[i])
+            break;
+    }
+    keypadStatsHistogram[i]++;
+}
+
+/**
+  * @brief  Account for one keypad UART open after a wake up.
+  * @param delayMs : time from the wake up to the UART being open.
+  * @param late : the keypad may have started sending before the open.
+  * @return none
+  */
+void KeypadStats_uartOpened(uint32_t delayMs, bool late)
+{
+    keypadStatsOpens++;
+    if(late)
+        keypadStatsLateOpens++;
+    if(delayMs > keypadStatsOpenMaxMs)
+        keypadStatsOpenMaxMs = delayMs;
+}
+
+/**
+  * @brief  Check whether a report period elapsed.
+  * @param none
+  * @return true when KeypadStats_report() should be called
+  */
+bool KeypadStats_reportDue(void)
+{
+    return ((Clock_getTicks() - keypadStatsReportTick) >= (KEYPAD_STATS_REPORT_MS * (1000 / Clock_tickPeriod)));
+}
+
+/**
+  * @brief  Log the statistics and start a new period. The messages are
+  *         KEYPAD INFO, build with -DTLOG_LEVEL_KEYPAD=TLOG_LEVEL_INFO
+  *         in Release to get them.
+  * @param none
+  * @return none
+  */
+void KeypadStats_report(void)
+{
+    uint32_t total = 0;
+    uint8_t i;
+
+    keypadStatsReportTick = Clock_getTicks();
+    for(i = 0; i < KEYPAD_STATS_BUCKETS; i++)
+    {
+        total += keypadStatsHistogram[i];
+    }
+
+    if(keypadStatsReceived || total)
+    {
+        TLOG3(TLOG_KEYPAD_RX_STATS, keypadStatsReceived, keypadStatsDropped, keypadStatsHighWater);
+        if(total)
+        {
+            TLOG3(TLOG_KEYPAD_LATENCY, KeypadStats_percentile(total, 500), KeypadStats_percentile(total, 900),
+                  KeypadStats_percentile(total, 990));
+            TLOG2(TLOG_KEYPAD_LATENCY_MAX, keypadStatsLatencyMaxUs, total);
+        }
+    }
+    if(keypadStatsOpens)
+        TLOG3(TLOG_KEYPAD_UART_OPENS, keypadStatsOpens, keypadStatsLateOpens, keypadStatsOpenMaxMs);
+    KeypadStats_clear();
+}
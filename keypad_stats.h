@@ -0,0 +1,34 @@
+#ifndef _KEYPAD_STATS_H_
+#define _KEYPAD_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Statistics are printed and restarted with this period */
+#define KEYPAD_STATS_REPORT_MS      10000
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void KeypadStats_init(void);
+extern void KeypadStats_received(size_t count, size_t queued, int fifoFilled);
+extern void KeypadStats_processed(void);
+extern void KeypadStats_uartOpened(uint32_t delayMs, bool late);
+extern bool KeypadStats_reportDue(void);
+extern void KeypadStats_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_KEYPAD_STATS_H_
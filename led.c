@@ -0,0 +1,435 @@
+/*
+ *  ======== led.c ========
+ *  Status LED driver.
+ *
+ *  Brightness is given as a perceptual level (0 - LED_LEVEL_MAX) and mapped
+ *  through a gamma table. With LED_PWM defined the four red/green LEDs are
+ *  dimmed by PWM, so indications can run at a fraction of the full current,
+ *  and fades/breathing are stepped from a clock callback without any task
+ *  work. Without LED_PWM (and for the low power LED, whose PWM7 timer half
+ *  is taken by the buzzer tone sequencer) any non zero level is full on.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/drivers/PIN.h>
+#ifdef LED_PWM
+#include <ti/drivers/PWM.h>
+#endif
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "util.h"
+#include "led.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* PWM frequency of the dimmed LEDs, high enough to be flicker free */
+#define LED_PWM_FREQ        1000
+
+/* Fade step interval */
+#define LED_FADE_TICK_MS    10
+
+/* Level fixed point format used while fading (8.8) */
+#define LED_LEVEL_SHIFT     8
+
+/* Gamma 2.2 curve sampled every 8 levels, 16-bit output */
+#define LED_GAMMA_POINTS    32
+
+static const uint16_t ledGamma[LED_GAMMA_POINTS + 1] = {
+    0, 32, 147, 359, 676, 1104, 1648, 2314, 3104, 4022, 5072,
+    6255, 7574, 9033, 10632, 12375, 14263, 16298, 18482, 20816, 23303,
+    25943, 28739, 31692, 34802, 38072, 41503, 45097, 48853, 52774, 56860,
+    61114, 65535
+};
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct _ledState {
+    int32_t level;      //current level, 8.8 fixed point
+    int32_t target;     //level at the end of the fade, 8.8 fixed point
+    int32_t step;       //level change per fade tick, 0 when not fading
+    bool breathe;       //restart the fade in the other direction at the end
+} LedState;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static const PIN_Id ledPin[LED_COUNT] = {
+    Board_DIO22_FRONT_RLED,
+    Board_DIO21_FRONT_GLED,
+    Board_DIO19_BACK_RLED,
+    Board_DIO18_BACK_GLED,
+    Board_DIO0_LOWPOWER_LED,
+};
+
+static PIN_Config ledPinTable[] = {
+#ifndef LED_PWM
+    Board_DIO22_FRONT_RLED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
+    PIN_DRVSTR_MAX,
+    Board_DIO21_FRONT_GLED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
+    PIN_DRVSTR_MAX,
+    Board_DIO19_BACK_RLED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
+    PIN_DRVSTR_MAX,
+    Board_DIO18_BACK_GLED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
+    PIN_DRVSTR_MAX,
+#endif
+    Board_DIO0_LOWPOWER_LED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
+    PIN_DRVSTR_MAX,
+    PIN_TERMINATE
+};
+
+static PIN_Handle ledPinHandle = NULL;
+static PIN_State ledPinState;
+
+#ifdef LED_PWM
+static const uint_least8_t ledPwmIndex[LED_COUNT - 1] = {
+    Board_PWM_LED_FR,
+    Board_PWM_LED_FG,
+    Board_PWM_LED_BR,
+    Board_PWM_LED_BG,
+};
+
+static PWM_Handle ledPwm[LED_COUNT] = {NULL};
+static bool ledPwmRunning[LED_COUNT];
+#endif
+
+static LedState ledState[LED_COUNT];
+static uint8_t ledOnLevel = LED_LEVEL_ON_DEFAULT;
+
+static Clock_Struct ledFadeClockStruct;
+
+#ifdef LED_PWM
+/**
+  * @brief  Convert perceptual level to PWM duty through the gamma table.
+  * @param level : brightness level (0 - LED_LEVEL_MAX).
+  * @return duty in PWM_DUTY_FRACTION units
+  */
+static uint32_t Led_levelToDuty(uint8_t level)
+{
+    uint32_t pos = (uint32_t)level * LED_GAMMA_POINTS;
+    uint32_t idx = pos / LED_LEVEL_MAX;
+    uint32_t frac = pos % LED_LEVEL_MAX;
+    uint32_t gamma = ledGamma[idx];
+
+    if(frac)
+        gamma += (ledGamma[idx + 1] - gamma) * frac / LED_LEVEL_MAX;
+
+    /* 0xFFFF * 0x10001 = PWM_DUTY_FRACTION_MAX */
+    return gamma * 0x10001;
+}
+#endif
+
+/**
+  * @brief  Drive an LED output at a level.
+  * @param led : LED_FR ~ LED_LOWPOWER.
+  * @param level : brightness level (0 - LED_LEVEL_MAX).
+  * @return none
+  */
+static void Led_output(SetLED led, uint8_t level)
+{
+#ifdef LED_PWM
+    if(ledPwm[led])
+    {
+        /* A running PWM keeps the device out of standby, stop it when dark */
+        if(level == 0)
+        {
+            if(ledPwmRunning[led])
+            {
+                PWM_stop(ledPwm[led]);
+                ledPwmRunning[led] = false;
+            }
+        }
+        else
+        {
+            PWM_setDuty(ledPwm[led], Led_levelToDuty(level));
+            if(!ledPwmRunning[led])
+            {
+                PWM_start(ledPwm[led]);
+                ledPwmRunning[led] = true;
+            }
+        }
+        return;
+    }
+#endif
+    if(ledPinHandle)
+        PIN_setOutputValue(ledPinHandle, ledPin[led], level ? Board_GPIO_LED_ON : Board_GPIO_LED_OFF);
+}
+
+/**
+  * @brief  Set the level of an LED, cancelling any fade on it.
+  *         Caller must hold the Hwi lock.
+  * @param led : LED_FR ~ LED_LOWPOWER.
+  * @param level : brightness level (0 - LED_LEVEL_MAX).
+  * @return none
+  */
+static void Led_apply(SetLED led, uint8_t level)
+{
+    ledState[led].level = (int32_t)level << LED_LEVEL_SHIFT;
+    ledState[led].target = ledState[led].level;
+    ledState[led].step = 0;
+    ledState[led].breathe = false;
+    Led_output(led, level);
+}
+
+/**
+  * @brief  Start a fade of an LED from its current level.
+  *         Caller must hold the Hwi lock.
+  * @param led : LED_FR ~ LED_LOWPOWER.
+  * @param level : brightness level at the end of the fade.
+  * @param durationMs : fade time.
+  * @return none
+  */
+static void Led_startFade(SetLED led, uint8_t level, uint16_t durationMs)
+{
+    LedState *state = &ledState[led];
+    int32_t ticks = durationMs / LED_FADE_TICK_MS;
+
+    state->target = (int32_t)level << LED_LEVEL_SHIFT;
+    if(ticks == 0)
+    {
+        ticks = 1;
+    }
+    state->step = (state->target - state->level) / ticks;
+    if(state->step == 0)
+    {
+        state->step = (state->target > state->level) ? 1 : -1;
+    }
+    if(state->target == state->level)
+    {
+        state->step = 0;
+    }
+
+    if(!Util_isActive(&ledFadeClockStruct))
+        Util_startClock(&ledFadeClockStruct);
+}
+
+/**
+  * @brief  Fade CLOCK callback function, steps every fading LED.
+  * @param arg0: input parameter for fade CLOCK callback function
+  * @return none
+  */
+static void Led_fadeFxn(UArg arg0)
+{
+    LedState *state;
+    bool active = false;
+    int i;
+
+    for(i = 0; i < LED_COUNT; i++)
+    {
+        state = &ledState[i];
+        if(state->step == 0)
+            continue;
+
+        state->level += state->step;
+        if(((state->step > 0) && (state->level >= state->target)) ||
+           ((state->step < 0) && (state->level <= state->target)))
+        {
+            state->level = state->target;
+            if(state->breathe)
+            {
+                state->target = state->target ? 0 : ((int32_t)ledOnLevel << LED_LEVEL_SHIFT);
+                state->step = -state->step;
+            }
+            else
+            {
+                state->step = 0;
+            }
+        }
+        Led_output((SetLED)i, state->level >> LED_LEVEL_SHIFT);
+
+        if(state->step)
+            active = true;
+    }
+
+    if(!active)
+        Util_stopClock(&ledFadeClockStruct);
+}
+
+/**
+  * @brief  Initialize LED pins, PWM channels and fade clock.
+  * @param none
+  * @return none
+  */
+void Led_init(void)
+{
+#ifdef LED_PWM
+    PWM_Params params;
+    int i;
+#endif
+
+    ledPinHandle = PIN_open(&ledPinState, ledPinTable);
+#ifdef DEBUG
+    if(!ledPinHandle)
+        System_printf("led open failed...\r\n");
+#endif
+
+#ifdef LED_PWM
+    PWM_Params_init(&params);
+    params.idleLevel = PWM_IDLE_LOW;
+    params.dutyUnits = PWM_DUTY_FRACTION;
+    params.dutyValue = 0;
+    params.periodUnits = PWM_PERIOD_HZ;
+    params.periodValue = LED_PWM_FREQ;
+    for(i = 0; i < LED_COUNT - 1; i++)
+    {
+        ledPwm[i] = PWM_open(ledPwmIndex[i], &params);
+        ledPwmRunning[i] = false;
+#ifdef DEBUG
+        if(!ledPwm[i])
+            System_printf("led pwm %d open failed...\r\n", i);
+#endif
+    }
+#endif
+
+    Util_constructClock(&ledFadeClockStruct, (Clock_FuncPtr) Led_fadeFxn, LED_FADE_TICK_MS, LED_FADE_TICK_MS, false, 0);
+}
+
+/**
+  * @brief  Set led.
+  * @param led : which led to action.
+  * @param value : to set led value.
+  * @return none
+  */
+void Led_set(SetLED led, bool value)
+{
+    UInt key;
+    int i;
+
+    key = Hwi_disable();
+    switch(led)
+    {
+        case LED_ALL_ON:
+            for(i = 0; i < LED_COUNT; i++)
+                Led_apply((SetLED)i, ledOnLevel);
+        break;
+
+        case LED_ALL_OFF:
+            for(i = 0; i < LED_COUNT; i++)
+                Led_apply((SetLED)i, 0);
+        break;
+
+        default:
+            if(led < LED_COUNT)
+                Led_apply(led, value ? ledOnLevel : 0);
+        break;
+    }
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Toggle led between off and the on level.
+  * @param led : LED_FR ~ LED_LOWPOWER.
+  * @return none
+  */
+void Led_toggle(SetLED led)
+{
+    if(led < LED_COUNT)
+        Led_set(led, !Led_isOn(led));
+}
+
+/**
+  * @brief  Check whether led is lit.
+  * @param led : LED_FR ~ LED_LOWPOWER.
+  * @return true when led level is not zero
+  */
+bool Led_isOn(SetLED led)
+{
+    if(led >= LED_COUNT)
+        return false;
+
+    return (ledState[led].level != 0);
+}
+
+/**
+  * @brief  Set the level used when a led is switched on.
+  * @param level : brightness level (1 - LED_LEVEL_MAX).
+  * @return none
+  */
+void Led_setOnLevel(uint8_t level)
+{
+    ledOnLevel = level ? level : 1;
+}
+
+/**
+  * @brief  Get the level used when a led is switched on.
+  * @param none
+  * @return brightness level (1 - LED_LEVEL_MAX)
+  */
+uint8_t Led_getOnLevel(void)
+{
+    return ledOnLevel;
+}
+
+/**
+  * @brief  Fade led from its current brightness to a level in the background.
+  * @param led : LED_FR ~ LED_LOWPOWER.
+  * @param level : brightness level at the end of the fade.
+  * @param durationMs : fade time, 0 to set the level immediately.
+  * @return none
+  */
+void Led_fade(SetLED led, uint8_t level, uint16_t durationMs)
+{
+    UInt key;
+
+    if(led >= LED_COUNT)
+        return;
+
+    key = Hwi_disable();
+    ledState[led].breathe = false;
+    if(durationMs < LED_FADE_TICK_MS)
+        Led_apply(led, level);
+    else
+        Led_startFade(led, level, durationMs);
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Breathe led between off and the on level until it is set again.
+  * @param led : LED_FR ~ LED_LOWPOWER.
+  * @param periodMs : time of one full off-on-off cycle.
+  * @return none
+  */
+void Led_breathe(SetLED led, uint16_t periodMs)
+{
+    UInt key;
+    LedState *state;
+    int32_t onLevel = (int32_t)ledOnLevel << LED_LEVEL_SHIFT;
+    int32_t ticks = periodMs / 2 / LED_FADE_TICK_MS;
+    int32_t step;
+
+    if(led >= LED_COUNT)
+        return;
+
+    /* Same speed in both directions, whatever the level it starts from */
+    step = onLevel / (ticks ? ticks : 1);
+    if(step == 0)
+        step = 1;
+
+    key = Hwi_disable();
+    state = &ledState[led];
+    state->breathe = true;
+    if(state->level >= onLevel)
+    {
+        state->target = 0;
+        state->step = -step;
+    }
+    else
+    {
+        state->target = onLevel;
+        state->step = step;
+    }
+    if(!Util_isActive(&ledFadeClockStruct))
+        Util_startClock(&ledFadeClockStruct);
+    Hwi_restore(key);
+}
@@ -0,0 +1,59 @@
+#ifndef _LED_H_
+#define _LED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define LED_LEVEL_MAX           255
+
+/* Brightness of an LED that is simply switched on */
+#ifdef LED_PWM
+#define LED_LEVEL_ON_DEFAULT    160     /* ~36% duty after gamma correction */
+#define LED_LEVEL_ON_LOW_BATTERY 96     /* ~12% duty, while the battery is low */
+#else
+#define LED_LEVEL_ON_DEFAULT    LED_LEVEL_MAX
+#define LED_LEVEL_ON_LOW_BATTERY LED_LEVEL_MAX
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum _setLed {
+    LED_FR,
+    LED_FG,
+    LED_BR,
+    LED_BG,
+    LED_LOWPOWER,
+    LED_ALL_ON,
+    LED_ALL_OFF,
+} SetLED;
+
+#define LED_COUNT   (LED_LOWPOWER + 1)
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void Led_init(void);
+extern void Led_set(SetLED led, bool value);
+extern void Led_toggle(SetLED led);
+extern bool Led_isOn(SetLED led);
+extern void Led_setOnLevel(uint8_t level);
+extern uint8_t Led_getOnLevel(void);
+extern void Led_fade(SetLED led, uint8_t level, uint16_t durationMs);
+extern void Led_breathe(SetLED led, uint16_t periodMs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_LED_H_
@@ -45,8 +45,17 @@
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/drivers/PWM.h>
 #include <ti/drivers/UART.h>
+#include <ti/drivers/uart/UARTCC26XX.h>
 #include <ti/drivers/PIN.h>
 #include <ti/drivers/ADC.h>
+#include <ti/drivers/ADCBuf.h>
+#include <ti/drivers/NVS.h>
+#ifdef TEMPERATURE_TMP116
+#include <ti/drivers/I2C.h>
+#endif
+#ifdef KEYPAD_AUTH
+#include <ti/drivers/AESCCM.h>
+#endif
 //#include <ti/drivers/Board.h>
 #include <ti/devices/cc13x2_cc26x2/driverlib/cpu.h>
 
@@ -55,6 +64,32 @@
 #include "uart_printf.h"
 #include "FIFO.h"
 #include "util.h"
+#include "ui.h"
+#include "buzzer.h"
+#include "led.h"
+#include "button.h"
+#include "keypad_link.h"
+#include "pin_entry.h"
+#include "credstore.h"
+#include "keypad_power.h"
+#include "battery.h"
+#include "fuel_gauge.h"
+#include "temperature.h"
+#include "tlog.h"
+#include "trace.h"
+#include "fault.h"
+#ifdef FILTER_BENCHMARK
+#include "filter.h"
+#endif
+#ifdef CLOSE_TOUCH_PANEL
+#include "pulse_train.h"
+#endif
+#ifdef KEYPAD_AUTH
+#include "keypad_auth.h"
+#endif
+#ifdef KEYPAD_LINK_STATS
+#include "keypad_stats.h"
+#endif
 
 /*********************************************************************
  * MACROS
@@ -71,7 +106,7 @@
                            PWM_start(motor2PWM); \
                       } while(0)
 
-#define stopMotor() do { \
+#define motorOff() do { \
                         if (motor1PWM) { \
                             PWM_stop(motor1PWM); \
                         } \
@@ -90,13 +125,18 @@
                            PIN_setOutputValue(motorDRPinHandle, CC26X2R1_JANUS_L1_MOTOR2_PWMPIN1, 1); \
                       } while(0)
 
-#define stopMotor() do { \
+#define motorOff() do { \
                         PIN_setOutputValue(motorDRPinHandle, CC26X2R1_JANUS_L1_MOTOR1_PWMPIN0, 0); \
                         PIN_setOutputValue(motorDRPinHandle, CC26X2R1_JANUS_L1_MOTOR2_PWMPIN1, 0); \
                     } while(0)
 
 #endif
 
+#define stopMotor() do { \
+                        motorOff(); \
+                        Trace_log(TRACE_MOTOR_STOP, 0); \
+                    } while(0)
+
 #define motorSWPreparation() do { \
                                  PIN_setInterrupt(motorSWPinHandle, Board_DIO14_MOTOR_SW1 | PIN_IRQ_DIS); \
                                  PIN_setInterrupt(motorSWPinHandle, Board_DIO15_MOTOR_SW2 | PIN_IRQ_DIS); \
@@ -110,21 +150,62 @@
  * CONSTANTS
  */
 
-#define TASKSTACKSIZE   512
-#define FIFOSIZE   32
+/* Main task stack, the peak use is logged with TLOG_STACK_PEAK */
+#define TASKSTACKSIZE_BASE  512
+#ifdef KEYPAD_AUTH
+#ifndef KEYPAD_LINK_FRAMED
+#error "KEYPAD_AUTH needs KEYPAD_LINK_FRAMED"
+#endif
+/* Frame decryption runs on the main task stack */
+#define TASKSTACKSIZE   (TASKSTACKSIZE_BASE + KEYPAD_AUTH_STACK_SIZE)
+#else
+#define TASKSTACKSIZE   TASKSTACKSIZE_BASE
+#endif
+#define FIFOSIZE   64
+
+/* Keypad UART reception, double buffered. A read returns when the buffer is
+   full or, with partial return enabled, when the line goes idle */
+#define KEYPAD_RX_SIZE   16
+
+/* Production builds only keep the keypad UART open (which blocks standby)
+   while the keypad is in use: a proximity edge on the keypad INT pin opens
+   it and it is closed again after KEYPAD_UART_IDLE_MS without data. After
+   KEYPAD_PWR_IDLE_MS the keypad controller itself is powered off.
+   UART_open() needs task context, so the UART is opened by the main task
+   and not by the INT callback. Protocol constraint: the keypad must not
+   send its first byte earlier than KEYPAD_UART_WAKE_DELAY_MS after raising
+   INT. The main task can't meet that while it waits on a motor move, such
+   late opens are counted by the KEYPAD_LINK_STATS statistics */
+#if !defined(CYCLE_TEST) && !defined(CLOSE_TOUCH_PANEL)
+#define KEYPAD_UART_WAKE
+#define KEYPAD_UART_IDLE_MS         10000
+#define KEYPAD_UART_WAKE_DELAY_MS   20
+#endif
 
 /* 200ms */
 #define UI_CLOCK_PERIOD 200
 
-#define CLOSE_TOUCH_CLOCK_PERIOD 35
-
-#define BUZZER_PWM_FREQ     2730
+/* With LED_PWM the UI leds fade in and out instead of switching, and an
+   endless flash breathes from the led fade clock without uiFxn() work.
+   A fade ends before the next UI tick, so Led_isOn() sees its end level */
+#ifdef LED_PWM
+#define UI_LED_FADE_MS  80
+#else
+#define UI_LED_FADE_MS  0
+#endif
+#if UI_LED_FADE_MS >= UI_CLOCK_PERIOD
+#error "UI_LED_FADE_MS must be shorter than UI_CLOCK_PERIOD"
+#endif
 
-#define DUTY_VOLUME_HIGH     PWM_DUTY_FRACTION_MAX * 0.5
-//#define DUTY_VOLUME_HIGH    100
-#define DUTY_VOLUME_MEDIUM  60
-#define DUTY_VOLUME_LOW     20
-#define DUTY_VOLUME_OFF     0
+/* Touch panel close handshake on the keypad INT pin (us) */
+#define CLOSE_TOUCH_LOW_US      70000
+#define CLOSE_TOUCH_HIGH_US     35000
+/* The motor PWMs need GPTimer 0A and 3A. The battery monitor leaves 0A to
+   them by sampling without ADCBuf (BATTERY_ADC_SOFTWARE), but 3A is the
+   pulse train generator playing the touch panel close handshake */
+#if defined(MOTOR_PWM) && defined(CLOSE_TOUCH_PANEL)
+#error "MOTOR_PWM needs GPTimer 3A, used by the CLOSE_TOUCH_PANEL pulse train"
+#endif
 
 #define MOTOR_PWM_FREQ     10000
 #define MOTOR_PWM_DUTY     PWM_DUTY_FRACTION_MAX
@@ -141,12 +222,19 @@
 #define BEEP_FOREVER -1
 #define LED_FLASH_FOREVER -1
 
-#define EVENT_PRESS         0x01
-#define EVENT_PRESS_LONG    0x02
-#define EVENT_RELEASE       0x04
+/* Index of the buttons in buttonConfig */
+#define BUTTON_FACTORY      0
+#define BUTTON_PRIVACY      1
+#define BUTTON_COUNT        2
+
+/* Unit of the motor timeout counts */
+#define MOTOR_TIMEOUT_UNIT_MS   20
 
-/* ADC sample count */
-#define ADC_SAMPLE_COUNT  (20)
+/* The motor slows down in the cold, its timeouts are widened by
+   MOTOR_COLD_PERCENT_PER_C for each degree below MOTOR_COLD_CENTI (1/100 C) */
+#define MOTOR_COLD_CENTI            1000
+#define MOTOR_COLD_PERCENT_PER_C    2
+#define MOTOR_COLD_MAX_PERCENT      60
 
 #ifdef OLD_ME
 #define MOTOR_DELAY_STOP_TIME 270000 / Clock_tickPeriod   //nice 150000  //250000
@@ -178,40 +266,7 @@ typedef enum {
     UNLOCK_STATE,
 } LockState;
 
-typedef enum _lowPowerLedType {
-    LOWPOWER_LED_NONE,
-    LOWPOWER_LED_ON,
-    LOWPOWER_LED_FLASH,
-} LowPowerLedType;
-
-typedef enum _setLed {
-    LED_FR,
-    LED_FG,
-    LED_BR,
-    LED_BG,
-    LED_LOWPOWER,
-    LED_ALL_ON,
-    LED_ALL_OFF,
-} SetLED;
-
-typedef enum _beepType {
-    BEEP_NONE,
-    BEEP_ON,
-    BEEP_SHORT,
-} BeepType;
-
-typedef enum _led {
-    LED_NONE,
-    LED_R,
-    LED_G,
-} LED;
-
-typedef enum _ledType {
-    LED_ON,
-    LED_FLASH,
-} LedType;
-
-typedef struct _uiMsg {
+typedef struct _uiState {
     LED led[2];  //which led to action; first element: front led, second element: back led
     LedType ledType[2];  //which action for led; first element: front led, second element: back led
     int32_t ledTimes[2]; //the times for the action of led (unit 200ms);  first element: front led, second element: back led
@@ -219,7 +274,7 @@ typedef struct _uiMsg {
     int32_t lowPowerTimes; //the times for the action of low power led (unit 200ms)
     BeepType beepType; //which action for buzzer
     int32_t beepTimes; //the times for the action of buzzer (unit 200ms)
-} UIMsg;
+} UIState;
 
 /*********************************************************************
  * GLOBAL VARIABLES
@@ -230,21 +285,8 @@ Task_Struct maintaskStruct;
 Char maintaskStack[TASKSTACKSIZE];
 FIFO_Buf FIFOBuf;
 Char FIFOStack[FIFOSIZE];
-Char KeyBuffer[FIFOSIZE];
+Char KeyBuffer[2][KEYPAD_RX_SIZE];
 
-PIN_Config ledPinTable[] = {
-    Board_DIO22_FRONT_RLED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
-    PIN_DRVSTR_MAX,
-    Board_DIO21_FRONT_GLED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
-    PIN_DRVSTR_MAX,
-    Board_DIO19_BACK_RLED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
-    PIN_DRVSTR_MAX,
-    Board_DIO18_BACK_GLED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
-    PIN_DRVSTR_MAX,
-    Board_DIO0_LOWPOWER_LED | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
-    PIN_DRVSTR_MAX,
-    PIN_TERMINATE
-};
 #ifdef CLOSE_TOUCH_PANEL
 PIN_Config keypadIntPinTable[] = {
     Board_DIO28_KEYPAD_INT | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL,
@@ -256,27 +298,11 @@ PIN_Config keypadIntPinTable[] = {
     PIN_TERMINATE
 };
 #endif
-PIN_Config batteryCntPinTable[] = {
-    Board_DIO13_BAT_CTRL | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
-    PIN_DRVSTR_MAX,
-    PIN_TERMINATE
-};
-
-PIN_Config buttonPinTable[] = {
-    Board_DIO12_FACTORY_BTN | PIN_INPUT_EN | PIN_PULLUP | PIN_IRQ_DIS,
-    Board_DIO4_PRIVACY_BTN | PIN_INPUT_EN | PIN_PULLUP | PIN_IRQ_DIS,
-    PIN_TERMINATE
-};
-
-PIN_Config keyPadPowerPinTable[] = {
-    Board_DIO11_KEYPAD_PWR | PIN_GPIO_OUTPUT_EN | PIN_GPIO_LOW | PIN_PUSHPULL |
-    PIN_DRVSTR_MAX,
-    PIN_TERMINATE
-};
 
-static PIN_Config coverDetectPinTable[] = {
-    Board_DIO1_COVER_DETECT | PIN_INPUT_EN | PIN_NOPULL | PIN_IRQ_DIS,
-    PIN_TERMINATE
+/* pin, debounce (press), long press, hold repeat, double click window (ms) */
+static const ButtonConfig buttonConfig[BUTTON_COUNT] = {
+    {Board_DIO12_FACTORY_BTN, 200, 2000, 0, 400},
+    {Board_DIO4_PRIVACY_BTN, 200, 2000, 0, 400},
 };
 
 static PIN_Config motorSWPinTable[] = {
@@ -304,23 +330,9 @@ static PIN_Config tsetTable[] = {
 };
 #endif
 
-static PIN_Handle ledPinHandle;
-static PIN_State ledPinState;
-
 static PIN_Handle keypadIntPinHandle;
 static PIN_State keypadIntPinState;
 
-static PIN_Handle batteryCntPinHandle;
-static PIN_State batteryCntPinState;
-
-static PIN_Handle buttonPinHandle;
-static PIN_State buttonPinState;
-
-static PIN_Handle keypadPwrPinHandle;
-static PIN_State keypadPwrPinState;
-
-static PIN_Handle coverDetectPinHandle;
-static PIN_State coverDetectPinState;
 
 static PIN_Handle motorSWPinHandle;  //Pin driver handles
 static PIN_State motorSWPinState;  //Global memory storage for a PIN_Config table
@@ -335,8 +347,6 @@ static PIN_Handle testPinHandle;
 static PIN_State testPinState;
 #endif
 
-static PWM_Handle buzzerPWM;
-
 #ifdef MOTOR_PWM
 static PWM_Handle motor1PWM; //counterclockwise
 static PWM_Handle motor2PWM; //clockwise
@@ -345,13 +355,7 @@ static PWM_Handle motor2PWM; //clockwise
 static Clock_Struct uiClockStruct;
 static Clock_Handle uiClock;
 
-#ifdef CLOSE_TOUCH_PANEL
-static Clock_Struct touchClockStruct;
-static Clock_Handle touchClock;
-#endif
-
-static Clock_Struct buttonClockStruct;
-static Clock_Handle buttonClockHandle;
+static Clock_Struct motorTimeoutClockStruct;
 
 static Clock_Struct lockDelayedStopMotorClock;
 static Clock_Handle lockDelayedStopMotorClockHandle;
@@ -361,10 +365,26 @@ static Semaphore_Struct semStruct;
 static Semaphore_Handle semHandle;
 #endif
 
-static UIMsg UI;
+static UIState UI;
 
 UART_Params uartParams;
 UART_Handle keyPadUart;
+static volatile uint8_t keyBufferIndex;  //buffer the UART is receiving into
+static volatile bool keyPadUartActive;  //reception re-armed from the callback
+
+/* Wakes the main task before its poll period on keypad activity */
+static Semaphore_Struct maintaskSemStruct;
+static Semaphore_Handle maintaskSem;
+
+/* Low battery indication on the low power LED, outside of UI patterns */
+static bool lowBattery;
+
+#ifdef KEYPAD_UART_WAKE
+static Clock_Struct keypadIdleClockStruct;
+static volatile bool keypadWake;  //proximity edge, open the UART
+static volatile bool keypadIdle;  //no data for KEYPAD_UART_IDLE_MS, close the UART
+static volatile uint32_t keypadWakeTick;  //time the keypad may start sending
+#endif
 
 #ifdef CYCLE_TEST
 int Count;
@@ -378,10 +398,12 @@ static volatile PIN_Id firstTriggeredSW;
 static volatile PIN_Id secondTriggeredSW;
 static volatile PIN_Id motorSW;
 static volatile LockState lockState;
-static volatile int button1Event;
-static volatile int button2Event;
 #ifdef CLOSE_TOUCH_PANEL
-volatile uint16_t touchCount;
+static const PulseStep closeTouchSteps[] = {
+    {0, CLOSE_TOUCH_LOW_US},
+    {1, CLOSE_TOUCH_HIGH_US},
+    {0, 0},
+};
 #endif
 
 /**
@@ -391,8 +413,9 @@ volatile uint16_t touchCount;
   */
 void startMotorClockwise(void)
 {
-    stopMotor();
+    motorOff();
     startMotor2();
+    Trace_log(TRACE_MOTOR_START, 2);
 }
 
 /**
@@ -402,8 +425,9 @@ void startMotorClockwise(void)
   */
 void startMotorCounterclockwise(void)
 {
-    stopMotor();
+    motorOff();
     startMotor1();
+    Trace_log(TRACE_MOTOR_START, 1);
 }
 
 /**
@@ -452,6 +476,39 @@ PIN_Id GetMotorSW()
     return motorSW;
 }
 
+/**
+  * @brief  Motor timeout CLOCK callback function.
+  * @param arg0: input parameter for motor timeout CLOCK callback function
+  * @return none
+  */
+static void motorTimeoutFxn(UArg arg)
+{
+    lockOrientationClockCount = 0;
+}
+
+/**
+  * @brief  Start the timeout of a motor action. lockOrientationClockCount
+  *         stays non zero until it expires.
+  * @param count : timeout at room temperature (unit 20ms).
+  * @return none
+  */
+static void StartMotorTimeout(uint16_t count)
+{
+    int16_t temperature = Temperature_getCentiCelsius();
+    uint32_t percent;
+
+    if(Temperature_isValid() && (temperature < MOTOR_COLD_CENTI))
+    {
+        percent = (uint32_t)(MOTOR_COLD_CENTI - temperature) * MOTOR_COLD_PERCENT_PER_C / 100;
+        if(percent > MOTOR_COLD_MAX_PERCENT)
+            percent = MOTOR_COLD_MAX_PERCENT;
+        count += (uint32_t)count * percent / 100;
+    }
+
+    lockOrientationClockCount = count;
+    Util_restartClock(&motorTimeoutClockStruct, (uint32_t)count * MOTOR_TIMEOUT_UNIT_MS);
+}
+
 /**
   * @brief unlock door.
   * @param wait: true: to wait the action of unlock finish; false: not wait the action of unlock finish
@@ -459,9 +516,8 @@ PIN_Id GetMotorSW()
   */
 void UnLock(bool wait)
 {
-#ifdef DEBUG
-    System_printf("UnLocking ...\r\n");
-#endif
+    TLOG0(TLOG_UNLOCKING);
+    Trace_log(TRACE_UNLOCK, 0);
     /*
     if(GetLockState() == UNLOCK_STATE)
     {
@@ -471,10 +527,11 @@ void UnLock(bool wait)
     */
     motorSWPreparation();
 #ifdef OLD_ME
-    lockOrientationClockCount = 70; //1.4sec, unit = 20ms //50 //60
+    StartMotorTimeout(70); //1.4sec, unit = 20ms //50 //60
 #else
-    lockOrientationClockCount = 75;
+    StartMotorTimeout(75);
 #endif
+    Battery_sagStart();
     MotorUnlock();
     do {
         if(firstTriggeredSW == Board_DIO14_MOTOR_SW1)
@@ -497,6 +554,8 @@ void UnLock(bool wait)
     else
     {
         stopMotor();
+        Trace_log(TRACE_MOTOR_TIMEOUT, 0);
+        Buzzer_play(Buzzer_melodyFailure, BUZZER_VOLUME_HIGH);
     }
 }
 
@@ -507,9 +566,8 @@ void UnLock(bool wait)
   */
 void Lock(bool wait)
 {
-#ifdef DEBUG
-    System_printf("Locking ...\r\n");
-#endif
+    TLOG0(TLOG_LOCKING);
+    Trace_log(TRACE_LOCK, 0);
     /*
     if(GetLockState() == LOCK_STATE)
     {
@@ -519,10 +577,11 @@ void Lock(bool wait)
     */
     motorSWPreparation();
 #ifdef OLD_ME
-    lockOrientationClockCount = 70; //1.4sec, unit = 20ms //50ms //60
+    StartMotorTimeout(70); //1.4sec, unit = 20ms //50ms //60
 #else
-    lockOrientationClockCount = 75;
+    StartMotorTimeout(75);
 #endif
+    Battery_sagStart();
     MotorLock();
     do {
         if(firstTriggeredSW == Board_DIO15_MOTOR_SW2)
@@ -545,6 +604,8 @@ void Lock(bool wait)
     else
     {
         stopMotor();
+        Trace_log(TRACE_MOTOR_TIMEOUT, 0);
+        Buzzer_play(Buzzer_melodyFailure, BUZZER_VOLUME_HIGH);
     }
 }
 
@@ -559,6 +620,7 @@ void InitDebugPort()
 
     // Enable System_printf(..) UART output
     UART_Params_init(&uartParams);
+    UartPrintf_setParams(&uartParams);
     UartPrintf_init(UART_open(Board_UART0, &uartParams));
 }
 
@@ -593,14 +655,12 @@ RLCheckResult RLCheck()
     RLCheckResult result = NOT_FOUND;
 
     motorSWPreparation();
-#ifdef DEBUG
-    System_printf("start motor clockwise\r\n");
-#endif
+    TLOG0(TLOG_MOTOR_CLOCKWISE);
     startMotorClockwise();
 #ifdef OLD_ME
-    lockOrientationClockCount = 50;  //1 sec , unit = 20ms  //50 //75
+    StartMotorTimeout(50);  //1 sec , unit = 20ms  //50 //75
 #else
-    lockOrientationClockCount = 50;
+    StartMotorTimeout(50);
 #endif
 #ifdef CYCLE_TEST
     Count++;
@@ -608,9 +668,7 @@ RLCheckResult RLCheck()
     do {
         if((Board_DIO15_MOTOR_SW2 == firstTriggeredSW) && (Board_DIO14_MOTOR_SW1 == secondTriggeredSW))
         {
-#ifdef DEBUG
-            System_printf("C: SW2--SW1\r\n");
-#endif
+            TLOG0(TLOG_C_SW2_SW1);
             lockOrientation = ORIENTATION_LEFT;
             Task_sleep(MOTOR_DELAY_STOP_TIME);
             stopMotor();
@@ -621,9 +679,7 @@ RLCheckResult RLCheck()
         }
         else if ((Board_DIO14_MOTOR_SW1 == firstTriggeredSW) && (Board_DIO15_MOTOR_SW2 == secondTriggeredSW))
         {
-#ifdef DEBUG
-            System_printf("C: SW1--SW2\r\n");
-#endif
+            TLOG0(TLOG_C_SW1_SW2);
             lockOrientation = ORIENTATION_RIGHT;
             Task_sleep(MOTOR_DELAY_STOP_TIME);
             stopMotor();
@@ -642,21 +698,17 @@ RLCheckResult RLCheck()
         Count++;
 #endif
         motorSWPreparation();
-#ifdef DEBUG
-        System_printf("start motor counterclockwise\r\n");
-#endif
+        TLOG0(TLOG_MOTOR_COUNTERCLOCKWISE);
         startMotorCounterclockwise();
 #ifdef OLD_ME
-        lockOrientationClockCount = 100; //2sec, unit = 20ms 100 //150
+        StartMotorTimeout(100); //2sec, unit = 20ms 100 //150
 #else
-        lockOrientationClockCount = 150;
+        StartMotorTimeout(150);
 #endif
         do {
             if((Board_DIO15_MOTOR_SW2 == firstTriggeredSW) && (Board_DIO14_MOTOR_SW1 == secondTriggeredSW))
             {
-#ifdef DEBUG
-                System_printf("CC: SW2--SW1\r\n");
-#endif
+                TLOG0(TLOG_CC_SW2_SW1);
                 lockOrientation = ORIENTATION_RIGHT;
                 Task_sleep(MOTOR_DELAY_STOP_TIME);
                 stopMotor();
@@ -667,9 +719,7 @@ RLCheckResult RLCheck()
             }
             else if((Board_DIO14_MOTOR_SW1 == firstTriggeredSW) && (Board_DIO15_MOTOR_SW2 == secondTriggeredSW))
             {
-#ifdef DEBUG
-                System_printf("CC: SW1--SW2\r\n");
-#endif
+                TLOG0(TLOG_CC_SW1_SW2);
                 lockOrientation = ORIENTATION_LEFT;
                 Task_sleep(MOTOR_DELAY_STOP_TIME);
                 result = LOCK;
@@ -692,21 +742,15 @@ RLCheckResult RLCheck()
 
     if(lockOrientation == ORIENTATION_NOT_FOUND)
     {
-#ifdef DEBUG
-        System_printf("Not Found Direction\r\n");
-#endif
+        TLOG0(TLOG_DIRECTION_NOT_FOUND);
     }
     else if(lockOrientation == ORIENTATION_RIGHT)
     {
-#ifdef DEBUG
-        System_printf("Direction = Right\r\n");
-#endif
+        TLOG0(TLOG_DIRECTION_RIGHT);
     }
     else
     {
-#ifdef DEBUG
-        System_printf("Direction = left\r\n");
-#endif
+        TLOG0(TLOG_DIRECTION_LEFT);
     }
     return result;
 }
@@ -743,6 +787,54 @@ void DoRLCheck()
     }
 */
 }
+/**
+  * @brief  Get the led driven by a UI led slot.
+  * @param i : 0: front led, 1: back led
+  * @return LED_FR ~ LED_BG
+  */
+static SetLED UiLed(int i)
+{
+    if(i)  //back led
+        return (UI.led[i] == LED_R) ? LED_BR : LED_BG;
+    else  //front led
+        return (UI.led[i] == LED_R) ? LED_FR : LED_FG;
+}
+
+/**
+  * @brief  Check whether a UI led slot breathes instead of flashing.
+  * @param i : 0: front led, 1: back led
+  * @return true for an endless flash with LED_PWM
+  */
+static bool UiLedBreathes(int i)
+{
+#ifdef LED_PWM
+    return (UI.led[i] != LED_NONE) && (LED_FLASH == UI.ledType[i]) && (LED_FLASH_FOREVER == UI.ledTimes[i]);
+#else
+    return false;
+#endif
+}
+
+/**
+  * @brief  Switch a UI led slot on or off, fading with LED_PWM.
+  * @param i : 0: front led, 1: back led
+  * @param on : true: on, false: off
+  * @return none
+  */
+static void UiLedSet(int i, bool on)
+{
+    Led_fade(UiLed(i), on ? Led_getOnLevel() : 0, UI_LED_FADE_MS);
+}
+
+/**
+  * @brief  Toggle a UI led slot, fading with LED_PWM.
+  * @param i : 0: front led, 1: back led
+  * @return none
+  */
+static void UiLedToggle(int i)
+{
+    UiLedSet(i, !Led_isOn(UiLed(i)));
+}
+
 /**
   * @brief  UI CLOCK callback function.
   * @param arg0: input parameter for UI CLOCK callback function
@@ -755,107 +847,37 @@ static void uiFxn(UArg arg0)
 
     if((0 == UI.beepTimes) && (UI.beepType != BEEP_NONE))
     {
-        PWM_stop(buzzerPWM);
-       // PWM_close(buzzerPWM);
-       // buzzerPWM = NULL;
+        Buzzer_off();
     }
 
     if((0 == UI.lowPowerTimes) && (UI.lowPower != LOWPOWER_LED_NONE))
     {
-        PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, Board_GPIO_LED_OFF);
+        Led_set(LED_LOWPOWER, lowBattery);
     }
 
     for(i = 0; i < 2; i++)
     {
         if((0 == UI.ledTimes[i]) && (UI.led[i] != LED_NONE))
         {
-            if(i)  //back led
-            {
-                if(UI.led[i] == LED_R)
-                    PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, Board_GPIO_LED_OFF);
-                else
-                    PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, Board_GPIO_LED_OFF);
-            }
-            else  //front led
-            {
-                if(UI.led[i] == LED_R)
-                    PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, Board_GPIO_LED_OFF);
-                else
-                    PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, Board_GPIO_LED_OFF);
-            }
+            UiLedSet(i, false);
         }
 
-        if((LED_FLASH_FOREVER == UI.ledTimes[i]) && (LED_FLASH == UI.ledType[i]))
+        if((LED_FLASH_FOREVER == UI.ledTimes[i]) && (LED_FLASH == UI.ledType[i]) && (UI.led[i] != LED_NONE) &&
+           !UiLedBreathes(i))
         {
-            if(i)  //back led
-            {
-                if(UI.led[i] == LED_R)
-                {
-                    if(PIN_getOutputValue(Board_DIO19_BACK_RLED))
-                    {
-                        PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, 0);
-                    }
-                    else
-                    {
-                        PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, 1);
-                    }
-                }
-                else if(UI.led[i] == LED_G)
-                {
-                    if(PIN_getOutputValue(Board_DIO18_BACK_GLED))
-                    {
-                        PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, 0);
-                    }
-                    else
-                    {
-                        PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, 1);
-                    }
-                }
-            }
-            else  //front led
-            {
-                if(UI.led[i] == LED_R)
-                {
-                    if(PIN_getOutputValue(Board_DIO22_FRONT_RLED))
-                    {
-                        PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, 0);
-                    }
-                    else
-                    {
-                        PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, 1);
-                    }
-                }
-                else if(UI.led[i] == LED_G)
-                {
-                    if(PIN_getOutputValue(Board_DIO21_FRONT_GLED))
-                    {
-                        PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, 0);
-                    }
-                    else
-                    {
-                        PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, 1);
-                    }
-                }
-            }
+            UiLedToggle(i);
         }
     }
 
     if((LED_FLASH_FOREVER == UI.lowPowerTimes) && (LOWPOWER_LED_FLASH == UI.lowPower))
     {
-        if(PIN_getOutputValue(Board_DIO0_LOWPOWER_LED))
-        {
-            PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, 0);
-        }
-        else
-        {
-            PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, 1);
-        }
+        Led_toggle(LED_LOWPOWER);
     }
 
     if((BEEP_FOREVER == UI.beepTimes) && (BEEP_SHORT == UI.beepType))
     {
         nonStopBeepFlag = !nonStopBeepFlag;
-        (nonStopBeepFlag) ? PWM_stop(buzzerPWM) : PWM_start(buzzerPWM);
+        (nonStopBeepFlag) ? Buzzer_off() : Buzzer_on();
     }
 
     if ((0 == UI.beepTimes) && (0 == UI.ledTimes[0]) && (0 == UI.ledTimes[1]) && (0 == UI.lowPowerTimes))
@@ -864,7 +886,7 @@ static void uiFxn(UArg arg0)
     if((UI.beepType != BEEP_NONE) && (UI.beepTimes > 0))
     {
         if (BEEP_SHORT == UI.beepType)
-            (UI.beepTimes-- & 0x1) ? PWM_start(buzzerPWM) : PWM_stop(buzzerPWM);
+            (UI.beepTimes-- & 0x1) ? Buzzer_on() : Buzzer_off();
         else
             UI.beepTimes--;
     }
@@ -873,14 +895,7 @@ static void uiFxn(UArg arg0)
     {
         if (LOWPOWER_LED_FLASH == UI.lowPower)
         {
-            if(PIN_getOutputValue(Board_DIO0_LOWPOWER_LED))
-            {
-                PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, 0);
-            }
-            else
-            {
-                PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, 1);
-            }
+            Led_toggle(LED_LOWPOWER);
         }
         UI.lowPowerTimes --;
     }
@@ -891,56 +906,7 @@ static void uiFxn(UArg arg0)
         {
             if (LED_FLASH == UI.ledType[i])
             {
-                if(i)  //back led
-                {
-                    if(UI.led[i] == LED_R)
-                    {
-                        if(PIN_getOutputValue(Board_DIO19_BACK_RLED))
-                        {
-                            PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, 0);
-                        }
-                        else
-                        {
-                            PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, 1);
-                        }
-                    }
-                    else
-                    {
-                        if(PIN_getOutputValue(Board_DIO18_BACK_GLED))
-                        {
-                            PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, 0);
-                        }
-                        else
-                        {
-                            PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, 1);
-                        }
-                    }
-                }
-                else  //front led
-                {
-                    if(UI.led[i] == LED_R)
-                    {
-                        if(PIN_getOutputValue(Board_DIO22_FRONT_RLED))
-                        {
-                            PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, 0);
-                        }
-                        else
-                        {
-                            PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, 1);
-                        }
-                    }
-                    else
-                    {
-                        if(PIN_getOutputValue(Board_DIO21_FRONT_GLED))
-                        {
-                            PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, 0);
-                        }
-                        else
-                        {
-                            PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, 1);
-                        }
-                    }
-                }
+                UiLedToggle(i);
             }
             UI.ledTimes[i] --;
         }
@@ -961,6 +927,10 @@ static void motorSWCallbackFxn(PIN_Handle handle, PIN_Id pinId)
 {
     static PIN_Id lastSW = 0;
 
+    /* End of the motor load for the battery sag capture */
+    Battery_sagStop();
+    Trace_log(TRACE_MOTOR_SW, pinId);
+
   //  System_printf("PRE-SW : %d \r\n", pinId);
    // if(!PIN_getInputValue(pinId))
 //    {
@@ -990,20 +960,14 @@ static void motorSWCallbackFxn(PIN_Handle handle, PIN_Id pinId)
         if(!firstTriggeredSW)
         {
             firstTriggeredSW = pinId;
-#ifdef DEBUG
-            System_printf("firstTriggeredSW: %d\r\n", firstTriggeredSW);
-#endif
+            TLOG1(TLOG_FIRST_SW, firstTriggeredSW);
         }
         else if ((!secondTriggeredSW) && (firstTriggeredSW != pinId))
         {
             secondTriggeredSW = pinId;
-#ifdef DEBUG
-            System_printf("secondTriggeredSW: %d\r\n", secondTriggeredSW);
-#endif
+            TLOG1(TLOG_SECOND_SW, secondTriggeredSW);
         }
-#ifdef DEBUG
-        System_printf("kidd : %d \r\n", motorSW);
-#endif
+        TLOG1(TLOG_MOTOR_SW, motorSW);
         lastSW = motorSW;
     }
     else
@@ -1038,121 +1002,55 @@ static void motorSWCallbackFxn(PIN_Handle handle, PIN_Id pinId)
 /**
   * @brief  Get battery ADC.
   * @param microVolt : output battery micro volt; if microVolt = NULL, it doesn't output battery micro volt
+  * @param ageMs : output age of the measurement; may be NULL
   * @return battery raw ADC value
   */
-uint16_t GetBatteryADC(uint32_t *microVolt)
+uint16_t GetBatteryADC(uint32_t *microVolt, uint32_t *ageMs)
 {
-    uint16_t     i = 0;
-    ADC_Handle   adc;
-    ADC_Params   params;
-    int_fast16_t res;
-    uint16_t adcValue[ADC_SAMPLE_COUNT];
-    uint32_t adcvalue = 0;
-
-    /* Turn on Battery voltage detect */
- //   PIN_setOutputValue(batteryCntPinHandle, Board_DIO13_BAT_CTRL, 1);
-    ADC_Params_init(&params);
-    adc = ADC_open(Board_POWER_ADC, &params);
-
-    if (adc == NULL)
-    {
-#ifdef DEBUG
-        System_printf("Open power ADC fail\r\n");
-#endif
-        /* Turn off Battery voltage detect */
- //       PIN_setOutputValue(batteryCntPinHandle, Board_DIO13_BAT_CTRL, 0);
-        return 0;
-    }
-
-    while(i < ADC_SAMPLE_COUNT)
-    {
-        res = ADC_convert(adc, &adcValue[i]);
-        if (res == ADC_STATUS_SUCCESS)
-        {
-           // System_printf("raw result: %d\r\n", adcValue[i]);
-            i++;
-           // System_flush();
-        }
-    }
-
-    /* Turn off Battery voltage detect */
-//    PIN_setOutputValue(batteryCntPinHandle, Board_DIO13_BAT_CTRL, 0);
-
-    /* Skip the front 4 ADC value */
-    for(i = 0; i < 16; i++)
-    {
-        adcvalue = adcvalue + adcValue[ADC_SAMPLE_COUNT - i - 1];
-    }
-
-    adcvalue = adcvalue >> 4;
-    adcValue[0] = adcvalue;
-#ifdef DEBUG
-    System_printf("Ave ADC: %d\r\n", adcValue[0]);
-#endif
-    if(microVolt != NULL)
-    {
-        *microVolt = ADC_convertRawToMicroVolts(adc, adcValue[0]);
-#ifdef DEBUG
-        System_printf("Volt result: %d\r\n", *microVolt);
-#endif
-    }
-    ADC_close(adc);
-
-    return adcValue[0];
+    /* Cached measurement, only measured again when older than BATTERY_MAX_AGE_MS */
+    Battery_get(BATTERY_MAX_AGE_MS, microVolt, ageMs);
+    return Battery_getRaw();
 }
 
-#ifdef CLOSE_TOUCH_PANEL
 /**
-  * @brief  touch CLOCK callback function.
-  * @param arg0: input parameter for touch CLOCK callback function
+  * @brief  Update the fuel gauge from the cached battery measurements and
+  *         show a low battery on the low power LED.
+  * @param sagDone : a sag capture has just been processed.
   * @return none
   */
-static void touchFxn(UArg arg0)
+static void UpdateFuelGauge(bool sagDone)
 {
-    touchCount ++;
-/*
-    if(touchCount == 1)
-    {
-        PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 0);
-    }
-    else if(touchCount >= 2)
-    {
-        PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 1);
-        Clock_stop(touchClock);
-    }
-    */
-    if(touchCount == 2)
-    {
-        PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 1);
-    }
-    else if(touchCount >= 3)
-    {
-        PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 0);
-        Clock_stop(touchClock);
-    }
+    BatterySag sag;
 
-}
+    if(sagDone && Battery_getSag(&sag))
+        FuelGauge_updateSag(sag.baselineMicroVolt, sag.minMicroVolt);
 
-/**
-  * @brief  Initialize clock for closing touch.
-  * @param none
-  * @return none
-  */
-void InitCloseTouchClock()
-{
-    touchClock = Util_constructClock(&touchClockStruct, (Clock_FuncPtr) touchFxn, CLOSE_TOUCH_CLOCK_PERIOD, CLOSE_TOUCH_CLOCK_PERIOD, false, 0);
+    if(!Battery_isValid())
+        return;
+    FuelGauge_setTemperature(Temperature_isValid() ? Temperature_getCentiCelsius() : FUEL_GAUGE_TEMP_NONE);
+    FuelGauge_update(Battery_getMicroVolt());
+
+    if(FuelGauge_isLow() != lowBattery)
+    {
+        lowBattery = FuelGauge_isLow();
+        /* Save the battery on every indication while it is low */
+        Led_setOnLevel(lowBattery ? LED_LEVEL_ON_LOW_BATTERY : LED_LEVEL_ON_DEFAULT);
+        /* A UI pattern owns the LED until it ends */
+        if((UI.lowPower == LOWPOWER_LED_NONE) || (UI.lowPowerTimes == 0))
+            Led_set(LED_LOWPOWER, lowBattery);
+    }
 }
 
+#ifdef CLOSE_TOUCH_PANEL
 /**
-  * @brief  Close Touch.
+  * @brief  Close Touch, plays the handshake on the keypad INT pin.
   * @param none
   * @return none
   */
 void CloseTouch()
 {
-    StopClock(&touchClockStruct, false);
-    touchCount = 0;
-    Util_startClock(&touchClockStruct);
+    PulseTrain_stop();
+    PulseTrain_play(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, closeTouchSteps, NULL);
 }
 #endif
 /**
@@ -1166,7 +1064,7 @@ void InitUI()
 }
 /**
   * @brief  Set UI.
-  * @param ui : UI action.
+  * @param ui : UI action, see UI_MSG() in ui.h.
   * @param wait : true: To wait the last UI finish, false: Not wait the last UI finish
   * @return none
   */
@@ -1175,61 +1073,59 @@ void SetUI(UIMsg ui, bool wait)
     int i;
 
     if ((BEEP_FOREVER == UI.beepTimes) || (LED_FLASH_FOREVER == UI.ledTimes[0]) || (LED_FLASH_FOREVER == UI.ledTimes[1]) || (LED_FLASH_FOREVER == UI.lowPowerTimes))
+    {
         StopClock(&uiClockStruct, false);  //force stop the last UI
+        for(i = 0; i < 2; i++)
+        {
+            /* The fade clock would keep it breathing */
+            if(UiLedBreathes(i))
+                Led_set(UiLed(i), false);
+        }
+    }
     else
         StopClock(&uiClockStruct, wait);
 
-    UI.beepType = ui.beepType;
+    UI.beepType = UI_MSG_GET_BEEP(ui);
     if(UI.beepType == BEEP_NONE)
     {
         UI.beepTimes = 0;
     }
     else
     {
-        UI.beepTimes = ui.beepTimes;
+        UI.beepTimes = UI_MSG_GET_BEEPTIMES(ui);
     }
 
-    UI.lowPower = ui.lowPower;
+    UI.lowPower = UI_MSG_GET_LOWPOWER(ui);
     if(UI.lowPower == LOWPOWER_LED_NONE)
     {
         UI.lowPowerTimes = 0;
     }
     else
     {
-        UI.lowPowerTimes = ui.lowPowerTimes;
-        PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, Board_GPIO_LED_ON);
+        UI.lowPowerTimes = UI_MSG_GET_LOWPOWERTIMES(ui);
+        Led_set(LED_LOWPOWER, true);
     }
 
     for(i = 0; i < 2; i++)
     {
-        UI.led[i] = ui.led[i];
-        UI.ledType[i] = ui.ledType[i];
+        UI.led[i] = UI_MSG_GET_LED(ui, i);
+        UI.ledType[i] = UI_MSG_GET_LEDTYPE(ui, i);
         if(UI.led[i] == LED_NONE)
         {
             UI.ledTimes[i] = 0;
         }
         else
         {
-            UI.ledTimes[i] = ui.ledTimes[i];
-            if(i)  //back led
-            {
-                if(UI.led[i] == LED_R)
-                    PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, Board_GPIO_LED_ON);
-                else
-                    PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, Board_GPIO_LED_ON);
-            }
-            else  //front led
-            {
-                if(UI.led[i] == LED_R)
-                    PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, Board_GPIO_LED_ON);
-                else
-                    PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, Board_GPIO_LED_ON);
-            }
+            UI.ledTimes[i] = UI_MSG_GET_LEDTIMES(ui, i);
+            if(UiLedBreathes(i))
+                Led_breathe(UiLed(i), 2 * UI_CLOCK_PERIOD);
+            else
+                UiLedSet(i, true);
         }
     }
 
     if((UI.beepType == BEEP_ON))
-        PWM_start(buzzerPWM);
+        Buzzer_on();
 
     Util_startClock(&uiClockStruct);
 }
@@ -1250,20 +1146,7 @@ void StopUI()
     {
         if(UI.led[i] != LED_NONE)
         {
-            if(i)  //back led
-            {
-                if(UI.led[i] == LED_R)
-                    PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, Board_GPIO_LED_OFF);
-                else
-                    PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, Board_GPIO_LED_OFF);
-            }
-            else  //front led
-            {
-                if(UI.led[i] == LED_R)
-                    PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, Board_GPIO_LED_OFF);
-                else
-                    PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, Board_GPIO_LED_OFF);
-            }
+            Led_set(UiLed(i), false);
             UI.led[i] = LED_NONE;
         }
         UI.ledTimes[i] = 0;
@@ -1272,12 +1155,12 @@ void StopUI()
     if(UI.lowPower != LOWPOWER_LED_NONE)
     {
         UI.lowPower = LOWPOWER_LED_NONE;
-        PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, Board_GPIO_LED_OFF);
+        Led_set(LED_LOWPOWER, lowBattery);
     }
 
     if(UI.beepType != BEEP_NONE)
     {
-        PWM_stop(buzzerPWM);
+        Buzzer_off();
         UI.beepType = BEEP_NONE;
     }
 
@@ -1285,73 +1168,6 @@ void StopUI()
     UI.beepTimes = 0;
 }
 
-/**
-  * @brief  Set led.
-  * @param led : which led to action.
-  * @param value : to set led value.
-  * @return none
-  */
-void SetLed(SetLED led, bool value)
-{
-    switch(led)
-    {
-        case LED_FR:
-            if(value)
-                PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, Board_GPIO_LED_ON);
-            else
-                PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, Board_GPIO_LED_OFF);
-        break;
-
-        case LED_FG:
-            if(value)
-                PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, Board_GPIO_LED_ON);
-            else
-                PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, Board_GPIO_LED_OFF);
-        break;
-
-        case LED_BR:
-            if(value)
-                PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, Board_GPIO_LED_ON);
-            else
-                PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, Board_GPIO_LED_OFF);
-        break;
-
-        case LED_BG:
-            if(value)
-                PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, Board_GPIO_LED_ON);
-            else
-                PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, Board_GPIO_LED_OFF);
-        break;
-
-
-        case LED_LOWPOWER:
-            if(value)
-                PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, Board_GPIO_LED_ON);
-            else
-                PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, Board_GPIO_LED_OFF);
-        break;
-
-        case LED_ALL_ON:
-            PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, Board_GPIO_LED_ON);
-            PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, Board_GPIO_LED_ON);
-            PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, Board_GPIO_LED_ON);
-            PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, Board_GPIO_LED_ON);
-            PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, Board_GPIO_LED_ON);
-        break;
-
-        case LED_ALL_OFF:
-            PIN_setOutputValue(ledPinHandle, Board_DIO22_FRONT_RLED, Board_GPIO_LED_OFF);
-            PIN_setOutputValue(ledPinHandle, Board_DIO21_FRONT_GLED, Board_GPIO_LED_OFF);
-            PIN_setOutputValue(ledPinHandle, Board_DIO19_BACK_RLED, Board_GPIO_LED_OFF);
-            PIN_setOutputValue(ledPinHandle, Board_DIO18_BACK_GLED, Board_GPIO_LED_OFF);
-            PIN_setOutputValue(ledPinHandle, Board_DIO0_LOWPOWER_LED, Board_GPIO_LED_OFF);
-        break;
-
-        default:
-        break;
-    }
-}
-
 /**
   * @brief  lock delayed stop motor callback function.
   * @param arg0: input parameter for lock delayed stop motor callback function
@@ -1359,34 +1175,11 @@ void SetLed(SetLED led, bool value)
   */
 static void lockDelayedStopMotorFxn(UArg arg) {
     stopMotor();
-#ifdef DEBUG
-    System_printf("Stopped motor \r\n");
-#endif
+    TLOG0(TLOG_MOTOR_STOPPED);
 }
 
 /**
-  * @brief  Initialize puzzer.
-  * @param none
-  * @return none
-  */
-void InitPuzzer()
-{
-    PWM_Params params;
-
-    PWM_Params_init(&params);
-    params.dutyUnits = PWM_DUTY_FRACTION;
-    params.dutyValue = DUTY_VOLUME_HIGH;
-    params.periodUnits = PWM_PERIOD_HZ;
-    params.periodValue = BUZZER_PWM_FREQ;
-    buzzerPWM = PWM_open(Board_PWM_PUZZER, &params);
-#ifdef DEBUG
-    if (!buzzerPWM)
-        System_printf("buzzer pwm open failed...\r\n");
-#endif
-}
-
-/**
-  * @brief  Initialize motor.
+  * @brief  Initialize motor.
   * @param none
   * @return none
   */
@@ -1397,6 +1190,7 @@ void InitMotor()
 #endif
 
     lockDelayedStopMotorClockHandle = Util_constructClock(&lockDelayedStopMotorClock, lockDelayedStopMotorFxn, MOTOR_DELAY_UNLOCK_STOP_MS, 0, FALSE, 0);
+    Util_constructClock(&motorTimeoutClockStruct, motorTimeoutFxn, MOTOR_TIMEOUT_UNIT_MS, 0, FALSE, 0);
 
 #ifdef MOTOR_PWM
     PWM_Params_init(&pwmParams);
@@ -1408,15 +1202,15 @@ void InitMotor()
     motor2PWM = PWM_open(Board_PWM_MOTOR2, &pwmParams);
 #ifdef DEBUG
     if (!motor1PWM)
-        System_printf("motor1PWM open failed...\r\n");
+        TLOG0(TLOG_MOTOR1_PWM_FAILED);
     if (!motor2PWM)
-        System_printf("motor2PWM open failed...\r\n");
+        TLOG0(TLOG_MOTOR2_PWM_FAILED);
 #endif
 #else
     motorDRPinHandle = PIN_open(&motorDRPinState, motorDRPinTable);
 #ifdef DEBUG
     if(!motorDRPinHandle)
-           System_printf("motor dr pin open failed...\r\n");
+           TLOG0(TLOG_MOTOR_DR_PIN_FAILED);
 #endif
 #endif
 
@@ -1424,10 +1218,10 @@ void InitMotor()
     motorSWPinHandle = PIN_open(&motorSWPinState, motorSWPinTable);
 #ifdef DEBUG
     if(!motorSWPinHandle)
-        System_printf("motor sw pin open failed...\r\n");
+        TLOG0(TLOG_MOTOR_SW_PIN_FAILED);
 
     if(PIN_registerIntCb(motorSWPinHandle, &motorSWCallbackFxn) != 0)
-        System_printf("register motor sw callback failed...\r\n");
+        TLOG0(TLOG_MOTOR_SW_CB_FAILED);
 #endif
 }
 
@@ -1438,22 +1232,23 @@ void InitMotor()
   */
 void InitGlobalParameter()
 {
+    Semaphore_Params semParams;
+
     /* Initial FIFO buffer */
     InitialFIFO(FIFOSIZE, FIFOStack, &FIFOBuf);
+    KeypadLink_init();
     /* We want to sleep for 10000 microseconds */
     sleepTickCount = 500000 / Clock_tickPeriod;
+    Semaphore_Params_init(&semParams);
+    semParams.mode = Semaphore_Mode_BINARY;
+    Semaphore_construct(&maintaskSemStruct, 0, &semParams);
+    maintaskSem = Semaphore_handle(&maintaskSemStruct);
     lockOrientation = ORIENTATION_NOT_FOUND;
     lockOrientationClockCount = 0;
     firstTriggeredSW = 0;
     secondTriggeredSW = 0;
     motorSW = 0;
-    button1Event = 0;
-    button2Event = 0;
-#ifdef CLOSE_TOUCH_PANEL
-    touchCount = 0;
-#endif
     lockState = UNKNOW_STATE;
-    buzzerPWM = NULL;
 #ifdef MOTOR_PWM
     motor1PWM = NULL; //counterclockwise
     motor2PWM = NULL; //clockwise
@@ -1465,12 +1260,13 @@ void InitGlobalParameter()
     testPinHandle = NULL;
 #endif
     keyPadUart = NULL;
-    ledPinHandle = NULL;
+    keyPadUartActive = false;
+#ifdef KEYPAD_UART_WAKE
+    keypadWake = false;
+    keypadIdle = false;
+    keypadWakeTick = 0;
+#endif
     keypadIntPinHandle = NULL;
-    batteryCntPinHandle = NULL;
-    buttonPinHandle = NULL;
-    keypadPwrPinHandle = NULL;
-    coverDetectPinHandle = NULL;
     motorSWPinHandle = NULL;
 #ifdef CYCLE_TEST
     Count = 0;
@@ -1494,24 +1290,23 @@ static void keypadIntCallbackFxn(PIN_Handle handle, PIN_Id pinId)
     if(PIN_getInputValue(PIN_ID(Board_DIO28_KEYPAD_INT)))
     {
 #ifdef CYCLE_TEST
-      //  keyPadUart = UART_open(Board_UART1, &uartParams);
-      //  UART_read(keyPadUart, KeyBuffer, 1);
         Proximity = true;
         UartOn = true;
 #endif
-#ifdef DEBUG
-        System_printf("positive edge\r\n");
+#ifdef KEYPAD_UART_WAKE
+        KeypadPower_activity();
+        keypadWakeTick = Clock_getTicks();
+        keypadWake = true;
+        Semaphore_post(maintaskSem);
 #endif
+        TLOG0(TLOG_KEYPAD_POSITIVE_EDGE);
     }
     else
     {
 #ifdef CYCLE_TEST
-      //  UART_close(keyPadUart);
         UartOn = false;
 #endif
-#ifdef DEBUG
-        System_printf("negative edge\r\n");
-#endif
+        TLOG0(TLOG_KEYPAD_NEGATIVE_EDGE);
     }
 }
 #endif
@@ -1528,90 +1323,185 @@ static void keypadIntCallbackFxn(PIN_Handle handle, PIN_Id pinId)
  */
 void keyPadCallback(UART_Handle handle, void *buf, size_t count)
 {
+#ifndef KEYPAD_LINK_FRAMED
     char input;
     int i;
-    UIMsg ui;
+#endif
+#ifdef KEYPAD_LINK_STATS
+    int queued = 0;
+#endif
 
+    /* Keep receiving into the other buffer while this one is consumed */
+    if(keyPadUartActive)
+    {
+        keyBufferIndex ^= 1;
+        UART_read(handle, KeyBuffer[keyBufferIndex], KEYPAD_RX_SIZE);
+    }
+
+#ifdef KEYPAD_LINK_FRAMED
+    /* Frames are checked and parsed in place by the task */
+#ifdef KEYPAD_LINK_STATS
+    queued = FIFOPutBytes(&FIFOBuf, (char *) buf, count);
+    KeypadStats_received(count, (queued > 0) ? queued : 0, FIFOFilledNumber(&FIFOBuf));
+#else
+    FIFOPutBytes(&FIFOBuf, (char *) buf, count);
+#endif
+#else
     for(i = 0; i < count; i++)
     {
         input = ((char *) buf)[i];
      //  System_printf("keyPadCallback: Keypad data = %c\r\n", input);
-        if((('0' <= input) && ('9' >= input)) || ('*' == input) || ('#' == input))
+        if(KeypadLink_isKey(input))
         {
-            ui.led[0] = LED_NONE;
-            ui.led[1] = LED_NONE;
-            ui.ledTimes[0] = 0;  // 1sec
-            ui.ledTimes[1] = 0;
-            ui.ledType[0] = LED_FLASH;
-            ui.ledType[1] = LED_FLASH;
-            ui.lowPower = LOWPOWER_LED_NONE;
-            ui.lowPowerTimes = 0;
-            ui.beepType = BEEP_ON;
-            ui.beepTimes = 1;
-            SetUI(ui, true);
+            Buzzer_play(Buzzer_melodyKey, BUZZER_VOLUME_MEDIUM);
+#ifdef KEYPAD_LINK_STATS
+            if(FIFOPutByte(&FIFOBuf, input))
+                queued++;
+#else
+            FIFOPutByte(&FIFOBuf, input);
+#endif
         }
-        FIFOPutByte(&FIFOBuf, input);
     }
+#ifdef KEYPAD_LINK_STATS
+    KeypadStats_received(count, queued, FIFOFilledNumber(&FIFOBuf));
+#endif
+#endif
+#ifdef KEYPAD_UART_WAKE
+    if(count)
+    {
+        Util_restartClock(&keypadIdleClockStruct, KEYPAD_UART_IDLE_MS);
+        KeypadPower_activity();
+    }
+#endif
+    Semaphore_post(maintaskSem);
 #ifdef BATTERY_TEST
         Semaphore_post(semHandle);
 #endif
 }
 /**
-  * @brief  button CLOCK callback function.
-  * @param arg0: input parameter for button CLOCK callback function
+  * @brief  Open keypad UART and start continuous reception.
+  * @param none
+  * @return none
+  */
+void KeypadUartOpen()
+{
+    keyPadUart = UART_open(Board_UART1, &uartParams);
+#ifdef DEBUG
+    if (keyPadUart)
+        TLOG0(TLOG_UART1_OPENED);
+    else
+        TLOG0(TLOG_UART1_FAILED);
+#endif
+    if(keyPadUart == NULL)
+        return;
+
+    /* Deliver a burst in one callback as soon as the line goes idle */
+    UART_control(keyPadUart, UARTCC26XX_CMD_RETURN_PARTIAL_ENABLE, NULL);
+
+    /* reads data from a UART with interrupt enabled */
+    keyBufferIndex = 0;
+    keyPadUartActive = true;
+    UART_read(keyPadUart, KeyBuffer[keyBufferIndex], KEYPAD_RX_SIZE);
+}
+
+/**
+  * @brief  Stop reception and close keypad UART.
+  * @param none
+  * @return none
+  */
+void KeypadUartClose()
+{
+    if(keyPadUart == NULL)
+        return;
+
+    /* The cancel completes the pending read through the callback, don't re-arm */
+    keyPadUartActive = false;
+    UART_readCancel(keyPadUart);
+    UART_close(keyPadUart);
+    keyPadUart = NULL;
+}
+
+#ifdef KEYPAD_UART_WAKE
+/**
+  * @brief  Keypad idle CLOCK callback function.
+  * @param arg0: input parameter for keypad idle CLOCK callback function
   * @return none
   */
-static void buttonClockFxn(UArg arg)
+static void keypadIdleFxn(UArg arg0)
 {
-    static int btn1_status = 0, btn2_status = 0;
+    keypadIdle = true;
+    Semaphore_post(maintaskSem);
+}
 
-    if(PIN_getInputValue(PIN_ID(Board_DIO12_FACTORY_BTN)))
-   // if(PIN_getInputValue(PIN_ID(Board_DIO13_MOTOR_SW1)))
+/**
+  * @brief  Keypad power callback function.
+  * @param ready: true when the keypad warmed up, false before power off
+  * @return none
+  */
+static void keypadPowerFxn(bool ready)
+{
+    if(ready)
     {
-        if(btn1_status >= 10)
-            button1Event |= EVENT_RELEASE;
-        btn1_status = 0;
+        /* Open the UART right away so the first key isn't lost */
+        PIN_setInterrupt(keypadIntPinHandle, Board_DIO28_KEYPAD_INT | PIN_IRQ_BOTHEDGES);
+        keypadWakeTick = Clock_getTicks();
+        keypadWake = true;
     }
-    else  // press Board_DIO12_FACTORY_BTN
+    else
     {
-        if(btn1_status >= 0)
-            btn1_status ++;
-        if(btn1_status == 10) //0.2 sec
-        {
-            button1Event |= EVENT_PRESS;
-        }
-        else if(btn1_status == 100) // 2sec
-        {
-            button1Event |= EVENT_PRESS_LONG;
-          //  btn1_status = -1;
-        }
+        /* The INT pin floats while the keypad is off */
+        PIN_setInterrupt(keypadIntPinHandle, Board_DIO28_KEYPAD_INT | PIN_IRQ_DIS);
+        keypadIdle = true;
     }
+    Semaphore_post(maintaskSem);
+}
 
-    if(PIN_getInputValue(PIN_ID(Board_DIO4_PRIVACY_BTN)))
-    //if(PIN_getInputValue(PIN_ID(Board_DIO14_MOTOR_SW2)))
+/**
+  * @brief  Open keypad UART on proximity and close it when idle.
+  * @param none
+  * @return none
+  */
+void ManageKeypadUart()
+{
+#ifdef KEYPAD_LINK_STATS
+    uint32_t delayMs;
+#endif
+
+    if(keypadWake)
     {
-        if( btn2_status >= 10 )
-            button2Event |= EVENT_RELEASE;
-        btn2_status = 0;
+        keypadWake = false;
+        keypadIdle = false;
+        /* Still warming up, keypadPowerFxn() wakes us again */
+        if(!KeypadPower_isReady())
+            return;
+        if(keyPadUart == NULL)
+        {
+            KeypadUartOpen();
+#ifdef KEYPAD_LINK_STATS
+            delayMs = (Clock_getTicks() - keypadWakeTick) * Clock_tickPeriod / 1000;
+            KeypadStats_uartOpened(delayMs, delayMs > KEYPAD_UART_WAKE_DELAY_MS);
+#endif
+        }
+        Util_restartClock(&keypadIdleClockStruct, KEYPAD_UART_IDLE_MS);
     }
-    else  // press Board_DIO4_PRIVACY_BTN
+    else if(keypadIdle)
     {
-        if(btn2_status >= 0)
-            btn2_status ++;
-        if(btn2_status == 10)  //0.2 sec
+        keypadIdle = false;
+        /* Somebody is still in front of the keypad */
+        if(KeypadPower_isReady() && PIN_getInputValue(PIN_ID(Board_DIO28_KEYPAD_INT)))
         {
-            button2Event |= EVENT_PRESS;
+            Util_restartClock(&keypadIdleClockStruct, KEYPAD_UART_IDLE_MS);
+            KeypadPower_activity();
         }
-        else if(btn2_status == 100) // 2sec
+        else if(keyPadUart)
         {
-            //btn2_status = -1;
-            button2Event |= EVENT_PRESS_LONG;
+            KeypadUartClose();
+            TLOG0(TLOG_UART1_CLOSED);
         }
     }
-
-    if(lockOrientationClockCount)
-        lockOrientationClockCount--;
 }
+#endif
+
 /**
   * @brief  Initialize maintask.
   * @param none
@@ -1621,44 +1511,34 @@ void InitMaintask()
 {
    // UART_Params uartParams;
    // char data;
-    UIMsg ui;
 
     InitUI();
-    InitPuzzer();
+    Buzzer_init();
+    if(Credstore_init() && (Credstore_count(NULL) == 0))
+        TLOG0(TLOG_CREDSTORE_EMPTY);
+#ifdef KEYPAD_AUTH
+    KeypadAuth_init();
+#ifdef KEYPAD_AUTH_BENCHMARK
+    KeypadAuth_benchmark();
+#endif
+#endif
+    PinEntry_init();
 #ifdef CLOSE_TOUCH_PANEL
-    InitCloseTouchClock();
+    PulseTrain_init();
 #endif
 
     /* Open led */
-    ledPinHandle = PIN_open(&ledPinState, ledPinTable);
-#ifdef DEBUG
-    if(!ledPinHandle)
-        System_printf("led open failed...\r\n");
-#endif
-    /* Open keypad power */
-    keypadPwrPinHandle = PIN_open(&keypadPwrPinState, keyPadPowerPinTable);
-#ifdef DEBUG
-    if(!keypadPwrPinHandle)
-        System_printf("keypad power open failed...\r\n");
-#endif
-    /* Open battery control */
-    batteryCntPinHandle = PIN_open(&batteryCntPinState, batteryCntPinTable);
-#ifdef DEBUG
-    if(!batteryCntPinHandle)
-        System_printf("battery control open failed...\r\n");
-#endif
-    /* Open key cover */
-    coverDetectPinHandle = PIN_open(&coverDetectPinState, coverDetectPinTable);
-#ifdef DEBUG
-    if(!coverDetectPinHandle)
-        System_printf("key cover open failed...\r\n");
-#endif
+    Led_init();
+    /* Start battery monitor */
+#ifdef FILTER_BENCHMARK
+    Filter_benchmark();
+#endif
+    Battery_init();
+    Temperature_init();
+    FuelGauge_init(FUEL_GAUGE_CHEMISTRY);
+    lowBattery = false;
     /* Open Button */
-    buttonPinHandle = PIN_open(&buttonPinState, buttonPinTable);
-#ifdef DEBUG
-    if(!buttonPinHandle)
-        System_printf("button open failed...\r\n");
-#endif
+    Button_init(buttonConfig, BUTTON_COUNT);
 
 #ifdef CLOSE_TOUCH_PANEL
     keypadIntPinHandle = PIN_open(&keypadIntPinState, keypadIntPinTable);
@@ -1679,7 +1559,7 @@ void InitMaintask()
     testPinHandle = PIN_open(&testPinState, tsetTable);
 #ifdef DEBUG
     if(!testPinHandle)
-        System_printf("test pin open failed...\r\n");
+        TLOG0(TLOG_TEST_PIN_FAILED);
 #endif
 #endif
     /* Enable keypad uart to read */
@@ -1693,57 +1573,221 @@ void InitMaintask()
    // uartParams.writeMode = UART_MODE_CALLBACK;
     uartParams.readCallback = keyPadCallback;
 
-
-    /* Enable detect button event clock */
-    buttonClockHandle = Util_constructClock(&buttonClockStruct, buttonClockFxn, 20, 20, TRUE, 0);
-
     /* Test led and buzzer */
-    ui.led[0] = LED_G;
-    ui.led[1] = LED_G;
-    ui.ledTimes[0] = 15;  // 3sec
-    ui.ledTimes[1] = 15;
-    ui.ledType[0] = LED_FLASH;
-    ui.ledType[1] = LED_FLASH;
-    ui.lowPower = LOWPOWER_LED_FLASH;
-    ui.lowPowerTimes = 15;
-    ui.beepType = BEEP_ON;
-    ui.beepTimes = 15;
-    SetUI(ui, false);
-
-    ui.led[0] = LED_R;
-    ui.led[1] = LED_R;
-    ui.ledTimes[0] = 10;  // 2sec
-    ui.ledTimes[1] = 10;
-    ui.ledType[0] = LED_FLASH;
-    ui.ledType[1] = LED_FLASH;
-    ui.lowPower = LOWPOWER_LED_NONE;
-    ui.lowPowerTimes = 0;
-    ui.beepType = BEEP_NONE;
-    ui.beepTimes = 0;
-    SetUI(ui, true);
-#ifdef DEBUG
+    SetUI(UI_MSG(LED_G, LED_FLASH, 15, LED_G, LED_FLASH, 15, LOWPOWER_LED_FLASH, 15, BEEP_ON, 15), false);  // 3sec
+
+    SetUI(UI_MSG_BOTH_FLASH(LED_R, 10, 0), true);  // 2sec
 #ifdef CYCLE_TEST
-    System_printf("Cycle test version = %d\r\n", CYCLE_TEST_VERSION);
+    TLOG1(TLOG_CYCLE_TEST_VERSION, CYCLE_TEST_VERSION);
 #else
-    System_printf("Function test version = %d\r\n", FUNCTION_TEST_VERSION);
-#endif
+    TLOG1(TLOG_FUNCTION_TEST_VERSION, FUNCTION_TEST_VERSION);
 #endif
 
     DoRLCheck();
+#ifdef KEYPAD_UART_WAKE
+    /* Start with the UART open, it is closed after the first idle period */
+    Util_constructClock(&keypadIdleClockStruct, keypadIdleFxn, KEYPAD_UART_IDLE_MS, 0, TRUE, 0);
+    /* Keypad power and key cover */
+    KeypadPower_init(keypadPowerFxn, KEYPAD_PWR_IDLE_MS);
+#else
+    KeypadPower_init(NULL, 0);
+#endif
+#ifdef KEYPAD_LINK_STATS
+    KeypadStats_init();
+#endif
 #ifndef CYCLE_TEST
-    keyPadUart = UART_open(Board_UART1, &uartParams);
- #ifdef DEBUG
-    if (keyPadUart)
-        System_printf("uart1 initialized\r\n");
-    else
-        System_printf("uart1 initialized failed...\r\n");
- #endif
+    KeypadUartOpen();
+#endif
+}
 
-    /* reads data from a UART with interrupt enabled */
-    UART_read(keyPadUart, KeyBuffer, 1);
+/**
+  * @brief  Process one key from the keypad.
+  * @param key : valid key code.
+  * @return true when the key triggered a lock action
+  */
+bool ProcessKey(char key)
+{
+    bool action = false;
+#ifndef CYCLE_TEST
+    uint16_t userId;
+    uint32_t microVolt;
+    uint32_t ageMs;
+    uint16_t adcValue;
 #endif
+
+    TLOG1(TLOG_KEY_SUCCESS, key);
+    /* No PIN digits in the trace, it outlives the entry */
+    Trace_log(TRACE_KEY, (key >= '0' && key <= '9') ? 0 : (uint8_t)key);
+#ifndef CYCLE_TEST
+    switch(PinEntry_key(key, &userId))
+    {
+        case PIN_ENTRY_ACCEPTED:
+            TLOG1(TLOG_PIN_ACCEPTED, userId);
+            Trace_log(TRACE_PIN_ACCEPTED, userId);
+            action = true;
+        break;
+
+        case PIN_ENTRY_REJECTED:
+            TLOG0(TLOG_PIN_REJECTED);
+            Trace_log(TRACE_PIN_REJECTED, 0);
+            Buzzer_play(Buzzer_melodyFailure, BUZZER_VOLUME_HIGH);
+            SetUI(UI_MSG_FRONT_FLASH(LED_R, 5, 0), false);
+        break;
+
+        case PIN_ENTRY_CLEARED:
+            TLOG0(TLOG_PIN_CLEARED);
+        break;
+
+        case PIN_ENTRY_ENROLLED:
+            TLOG1(TLOG_PIN_ENROLLED, userId);
+            Trace_log(TRACE_PIN_ENROLLED, userId);
+            Buzzer_play(Buzzer_melodySuccess, BUZZER_VOLUME_MEDIUM);
+            SetUI(UI_MSG_FRONT_FLASH(LED_G, 5, 0), false);
+        break;
+
+        case PIN_ENTRY_ENROL_FAILED:
+            TLOG0(TLOG_PIN_ENROL_FAILED);
+            Buzzer_play(Buzzer_melodyFailure, BUZZER_VOLUME_HIGH);
+            SetUI(UI_MSG_FRONT_FLASH(LED_R, 5, 0), false);
+        break;
+
+        default:
+        break;
+    }
+
+    if(action)
+    {
+        Buzzer_play(Buzzer_melodySuccess, BUZZER_VOLUME_MEDIUM);
+#ifdef CLOSE_TOUCH_PANEL
+        /* Hold the pin high while the lock action runs */
+        PulseTrain_stop();
+        PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 1);
+#endif
+        /* The read only feeds the log, the move takes its own sag baseline */
+        if(TLOG_ON(TLOG_BATTERY_BEFORE))
+        {
+            adcValue = GetBatteryADC(&microVolt, &ageMs);
+            TLOG3(TLOG_BATTERY_BEFORE, adcValue, microVolt, ageMs);
+        }
+#ifndef CLOSE_TOUCH_PANEL
+        if(GetMotorSW() == Board_DIO15_MOTOR_SW2)  // Lock
+        {
+            SetUI(UI_MSG_FRONT_FLASH(LED_G, 5, 5), false);
+            UnLock(true);
+        }
+        else  // Unlock
+        {
+            Lock(true);
+        }
+#endif
+        /* The move is measured by the sag capture, which refreshes the value after it */
+#ifdef CLOSE_TOUCH_PANEL
+        PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 0);
+#endif
+    }
+#endif
+    return action;
 }
 
+#ifdef KEYPAD_LINK_FRAMED
+/**
+  * @brief  Process one message from the keypad link.
+  * @param type : message type.
+  * @param payload : message payload.
+  * @param length : payload length.
+  * @return true when a key triggered a lock action
+  */
+bool ProcessKeypadMessage(uint8_t type, const uint8_t *payload, uint8_t length)
+{
+    bool action = false;
+    char key;
+    uint8_t i;
+
+    switch(type)
+    {
+        case KEYPAD_MSG_KEY:
+            /* The frame is consumed afterwards, so the keys after a lock
+             * action are still handed to the PIN entry */
+            for(i = 0; i < length; i++)
+            {
+                key = (char)payload[i];
+                if(!KeypadLink_isKey(key))
+                {
+                    TLOG1(TLOG_KEY_FAIL, key);
+                    continue;
+                }
+                Buzzer_play(Buzzer_melodyKey, BUZZER_VOLUME_MEDIUM);
+                if(ProcessKey(key))
+                    action = true;
+            }
+        break;
+
+        case KEYPAD_MSG_PROXIMITY:
+#ifdef CYCLE_TEST
+            Proximity = (length && payload[0]);
+#endif
+            TLOG1(TLOG_KEYPAD_PROXIMITY, length ? payload[0] : 0);
+        break;
+
+        case KEYPAD_MSG_TOUCH:
+            TLOG1(TLOG_KEYPAD_TOUCH, length ? payload[0] : 0);
+        break;
+
+        default:
+            TLOG1(TLOG_KEYPAD_UNKNOWN_FRAME, type);
+        break;
+    }
+    return action;
+}
+
+/**
+  * @brief  Process one frame from the keypad link.
+  * @param frame : frame returned by KeypadLink_parse().
+  * @return true when a key triggered a lock action
+  */
+bool ProcessKeypadFrame(KeypadLinkFrame *frame)
+{
+    uint8_t payload[KEYPAD_LINK_MAX_PAYLOAD];
+    const uint8_t *data;
+    uint8_t i;
+#ifdef KEYPAD_AUTH
+    KeypadAuthStatus status;
+    uint8_t length;
+
+    if(frame->type == KEYPAD_MSG_SECURE)
+    {
+        status = KeypadAuth_open(frame, payload, &length);
+        /* Secure messages don't nest */
+        if((status != KEYPAD_AUTH_OK) || (length == 0) || (payload[0] == KEYPAD_MSG_SECURE))
+        {
+            TLOG1(TLOG_KEYPAD_SECURE_REJECTED, status);
+            return false;
+        }
+        return ProcessKeypadMessage(payload[0], &payload[1], length - 1);
+    }
+
+    /* Keys are only taken from authenticated frames */
+    if(frame->type == KEYPAD_MSG_KEY)
+    {
+        TLOG0(TLOG_KEYPAD_PLAIN_DROPPED);
+        return false;
+    }
+#endif
+
+    /* Read in place, only a payload wrapped around the FIFO end is copied */
+    data = KeypadLink_payload(frame);
+    if(data == NULL)
+    {
+        for(i = 0; i < frame->length; i++)
+        {
+            payload[i] = KeypadLink_payloadByte(frame, i);
+        }
+        data = payload;
+    }
+    return ProcessKeypadMessage(frame->type, data, frame->length);
+}
+#endif
+
 /**
   * @brief  Process keypad data.
   * @param none
@@ -1751,158 +1795,187 @@ void InitMaintask()
   */
 void ProcessKeypadData()
 {
+#ifdef KEYPAD_LINK_FRAMED
+    KeypadLinkFrame frame;
+    bool done;
+#else
     char data;
-    UIMsg ui;
+#endif
+#ifdef CYCLE_TEST
     uint32_t microVolt;
+    uint32_t ageMs;
     uint16_t adcValue;
+#endif
 
 #ifdef CYCLE_TEST
     if(UartOn)
     {
         if(keyPadUart == NULL)
         {
-            keyPadUart = UART_open(Board_UART1, &uartParams);
-#ifdef DEBUG
-            if (keyPadUart)
-                System_printf("uart1 initialized\r\n");
-            else
-                System_printf("uart1 initialized failed...\r\n");
-#endif
-            /* reads data from a UART with interrupt enabled */
-            UART_read(keyPadUart, KeyBuffer, 1);
+            KeypadUartOpen();
         }
     }
     else
     {
-        if(keyPadUart)
-        {
-            UART_close(keyPadUart);
-            keyPadUart = NULL;
-        }
+        KeypadUartClose();
     }
 #endif
-    while(FIFOIsEmpty(&FIFOBuf) ==  false)
-    {
-        if(FIFOGetByte(&FIFOBuf, &data))
-        {
-            if((('0' <= data) && ('9' >= data)) || ('*' == data) || ('#' == data))
-            {
-#ifdef DEBUG
-                System_printf("ProcessKeypadData success: Keypad data = %c\r\n", data);
-#endif
-#ifndef CYCLE_TEST
-                if((data == '#') || ('*' == data))
-                {
-#ifdef CLOSE_TOUCH_PANEL
-                    PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 1);
-                    //CloseTouch();
+#ifdef KEYPAD_LINK_STATS
+    KeypadStats_processed();
 #endif
-                    //UART_read(keyPadUart, &data, 1);
-                    adcValue = GetBatteryADC(&microVolt);
-#ifdef DEBUG
-                    System_printf("Before Battery ADC_vaule = %d, mV = %d \n\r ", adcValue, microVolt);
-#endif
-#ifndef CLOSE_TOUCH_PANEL
-                    if(GetMotorSW() == Board_DIO15_MOTOR_SW2)  // Lock
-                    {
-                        ui.led[0] = LED_G;
-                        ui.led[1] = LED_NONE;
-                        ui.ledTimes[0] = 5; // 1sec
-                        ui.ledTimes[1] = 0;
-                        ui.ledType[0] = LED_FLASH;
-                        ui.ledType[1] = LED_FLASH;
-                        ui.lowPower = LOWPOWER_LED_NONE;
-                        ui.lowPowerTimes = 0;
-                        ui.beepType = BEEP_ON;
-                        ui.beepTimes = 5;
-                        SetUI(ui, false);
-                        UnLock(true);
-                    }
-                    else  // Unlock
-                    {
-                        Lock(true);
-                    }
-#endif
-                    adcValue = GetBatteryADC(&microVolt);
-#ifdef DEBUG
-                    System_printf("After Battery ADC_vaule = %d, mV = %d \n\r ", adcValue, microVolt);
-#endif
-#ifdef CLOSE_TOUCH_PANEL
-                   PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 0);
-#endif
-                    UART_read(keyPadUart, &data, 1);
-                    return;
-                }
-#endif
-            }
-            else
-            {
-#ifdef DEBUG
-                System_printf("ProcessKeypadData fail: Keypad data = %c\r\n", data);
-#endif
-            }
-            //System_flush();
-        }
-        UART_read(keyPadUart, &data, 1);
+#ifdef KEYPAD_LINK_FRAMED
+    while(KeypadLink_parse(&FIFOBuf, &frame))
+    {
+        done = ProcessKeypadFrame(&frame);
+        KeypadLink_consume(&frame);
+        if(done)
+            return;
     }
+#else
+    /* Only valid keys are queued by keyPadCallback */
+    while(FIFOGetByte(&FIFOBuf, &data))
+    {
+        if(ProcessKey(data))
+            return;
+    }
+#endif
 #ifdef CYCLE_TEST
     if(Proximity)
     {
-        adcValue = GetBatteryADC(&microVolt);
-#ifdef DEBUG
-        System_printf("Before Battery ADC_vaule = %d, mV = %d \n\r ", adcValue, microVolt);
-#endif
+        if(TLOG_ON(TLOG_BATTERY_BEFORE))
+        {
+            adcValue = GetBatteryADC(&microVolt, &ageMs);
+            TLOG3(TLOG_BATTERY_BEFORE, adcValue, microVolt, ageMs);
+        }
 //#ifdef CYCLE_TEST
 //        Count++;
 //#endif
         if(GetMotorSW() == Board_DIO15_MOTOR_SW2)  // Lock
         {
-            ui.led[0] = LED_G;
-            ui.led[1] = LED_NONE;
-            ui.ledTimes[0] = 5; // 1sec
-            ui.ledTimes[1] = 0;
-            ui.ledType[0] = LED_FLASH;
-            ui.ledType[1] = LED_FLASH;
-            ui.lowPower = LOWPOWER_LED_NONE;
-            ui.lowPowerTimes = 0;
-            ui.beepType = BEEP_ON;
-            ui.beepTimes = 5;
-            SetUI(ui, false);
+            SetUI(UI_MSG_FRONT_FLASH(LED_G, 5, 5), false);
             UnLock(true);
         }
         else  // Unlock
         {
             Lock(true);
         }
-2        adcValue = GetBatteryADC(&microVolt);
-#ifdef DEBUG
-#ifdef CYCLE_TEST
-        System_printf("Count number = %d \n\r ", Count);
-#endif
-        System_printf("After Battery ADC_vaule = %d, mV = %d \n\r ", adcValue, microVolt);
-#endif
+        TLOG1(TLOG_CYCLE_COUNT, Count);
         Proximity = false;
     }
 #endif
 }
 
+/**
+  * @brief  Handle a button gesture.
+  * @param index : button index, BUTTON_INDEX_CHORD for a chord.
+  * @param event : button event.
+  * @return none
+  */
+void ProcessButtonEvent(uint8_t index, ButtonEvent event)
+{
+    LED led = (index == BUTTON_FACTORY) ? LED_G : LED_R;
+    uint16_t userId;
+
+    if(index == BUTTON_INDEX_CHORD)
+    {
+        TLOG0(TLOG_BUTTON_CHORD);
+        return;
+    }
+
+    switch(event)
+    {
+        case BUTTON_EVENT_PRESS:
+#ifdef CLOSE_TOUCH_PANEL
+            CloseTouch();
+#endif
+            TLOG1(TLOG_BUTTON_PRESS, index + 1);
+            SetUI(UI_MSG_BACK_FLASH(led, 4, 0), true);
+        break;
+
+        case BUTTON_EVENT_LONG_PRESS:
+            TLOG1(TLOG_BUTTON_LONG_PRESS, index + 1);
+            SetUI(UI_MSG_BACK_FLASH(led, 5, 5), true);
+            /* Provisioning, the inside button enrolls the next PIN entered */
+            if(index == BUTTON_FACTORY)
+            {
+                Credstore_count(&userId);
+                TLOG1(TLOG_PIN_ENROL_START, userId + 1);
+                PinEntry_enrol(userId + 1);
+            }
+        break;
+
+        case BUTTON_EVENT_RELEASE:
+            TLOG1(TLOG_BUTTON_RELEASE, index + 1);
+        break;
+
+        case BUTTON_EVENT_CLICK:
+            TLOG1(TLOG_BUTTON_CLICK, index + 1);
+        break;
+
+        case BUTTON_EVENT_DOUBLE_CLICK:
+            TLOG1(TLOG_BUTTON_DOUBLE_CLICK, index + 1);
+        break;
+
+        case BUTTON_EVENT_REPEAT:
+            TLOG1(TLOG_BUTTON_REPEAT, index + 1);
+        break;
+
+        default:
+        break;
+    }
+}
+
+#ifdef TLOG_ENABLE
+/**
+  * @brief  Log the main task stack high-water mark when it grows, to check
+  *         TASKSTACKSIZE against the real use of each build.
+  * @param none
+  * @return none
+  */
+static void CheckStackPeak(void)
+{
+    static size_t stackPeak = 0;
+    Task_Stat stat;
+
+    Task_stat(Task_self(), &stat);
+    if(stat.used > stackPeak)
+    {
+        stackPeak = stat.used;
+        TLOG2(TLOG_STACK_PEAK, stat.used, stat.stackSize);
+    }
+}
+#endif
+
 /*
  *  ======== task1Fxn ========
  */
 Void maintaskFxn(UArg arg0, UArg arg1)
 {
-    UIMsg ui;
    // uint32_t microVolt;
     //uint16_t adcValue;
+    uint8_t buttonIndex;
+    ButtonEvent buttonEvent;
 
     InitMaintask();
+    Fault_ready();
     for (;;)
     {
 #ifdef BATTERY_TEST
         Semaphore_pend(semHandle, BIOS_WAIT_FOREVER);
 #endif
 
+#ifdef KEYPAD_UART_WAKE
+        ManageKeypadUart();
+#endif
         ProcessKeypadData();
+        UpdateFuelGauge(Battery_sagProcess());
+#ifdef TLOG_ENABLE
+        CheckStackPeak();
+#endif
+#ifdef KEYPAD_LINK_STATS
+        if(KeypadStats_reportDue())
+            KeypadStats_report();
+#endif
 
         /*Detect Key cover */
         /*
@@ -1911,17 +1984,7 @@ Void maintaskFxn(UArg arg0, UArg arg1)
 #ifdef DEBUG
             System_printf("Detect Key cover\r\n");
 #endif
-            ui.led[0] = LED_R;
-            ui.led[1] = LED_NONE;
-            ui.ledTimes[0] = 5;  // 1sec
-            ui.ledTimes[1] = 0;
-            ui.ledType[0] = LED_FLASH;
-            ui.ledType[1] = LED_FLASH;
-            ui.lowPower = LOWPOWER_LED_NONE;
-            ui.lowPowerTimes = 0;
-            ui.beepType = BEEP_ON;
-            ui.beepTimes = 5;
-            SetUI(ui, true);
+            SetUI(UI_MSG_FRONT_FLASH(LED_R, 5, 5), true);
         }
 */
 /*
@@ -1942,189 +2005,65 @@ Void maintaskFxn(UArg arg0, UArg arg1)
         /* Detect test pin */
         if(PIN_getInputValue(PIN_ID(Board_DIO5_TEST1)))
         {
-#ifdef DEBUG
-            System_printf("Detect test1 pin high\r\n");
-#endif
+            TLOG0(TLOG_TEST1_HIGH);
         }
         else
         {
-#ifdef DEBUG
-            System_printf("Detect test1 pin low\r\n");
-#endif
+            TLOG0(TLOG_TEST1_LOW);
         }
 
         if(PIN_getInputValue(PIN_ID(Board_DIO6_TEST2)))
         {
-#ifdef DEBUG
-            System_printf("Detect test2 pin high\r\n");
-#endif
+            TLOG0(TLOG_TEST2_HIGH);
         }
         else
         {
-#ifdef DEBUG
-            System_printf("Detect test2 pin low\r\n");
-#endif
+            TLOG0(TLOG_TEST2_LOW);
         }
 
         if(PIN_getInputValue(PIN_ID(Board_DIO7_TEST3)))
         {
-#ifdef DEBUG
-            System_printf("Detect test3 pin high\r\n");
-#endif
+            TLOG0(TLOG_TEST3_HIGH);
         }
         else
         {
-#ifdef DEBUG
-            System_printf("Detect test3 pin low\r\n");
-#endif
+            TLOG0(TLOG_TEST3_LOW);
         }
 #endif
 
-        /* Detect button1 */
-        if(button1Event & EVENT_PRESS)
-        {
-#ifdef CLOSE_TOUCH_PANEL
-          //  PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 1);
-            CloseTouch();
-#endif
-            ui.led[0] = LED_NONE;
-            ui.led[1] = LED_G;
-            ui.ledTimes[0] = 0;
-            ui.ledTimes[1] = 4;
-            ui.ledType[0] = LED_FLASH;
-            ui.ledType[1] = LED_FLASH;
-            ui.lowPower = LOWPOWER_LED_NONE;
-            ui.lowPowerTimes = 0;
-            ui.beepType = BEEP_NONE;
-            ui.beepTimes = 0;
-#ifdef DEBUG
-            System_printf("Button1 press\r\n");
-#endif
-            button1Event = 0;
-            SetUI(ui, true);
-#ifdef CLOSE_TOUCH_PANEL
-            //PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 0);
-#endif
-        }
-        else if(button1Event & EVENT_PRESS_LONG)
-        {
-            ui.led[0] = LED_NONE;
-            ui.led[1] = LED_G;
-            ui.ledTimes[0] = 0;
-            ui.ledTimes[1] = 5;
-            ui.ledType[0] = LED_FLASH;
-            ui.ledType[1] = LED_FLASH;
-            ui.lowPower = LOWPOWER_LED_NONE;
-            ui.lowPowerTimes = 0;
-            ui.beepType = BEEP_ON;
-            ui.beepTimes = 5;
-#ifdef DEBUG
-            System_printf("Button1 long press\r\n");
-#endif
-            button1Event = 0;
-            SetUI(ui, true);
-        }
-        else if(button1Event & EVENT_RELEASE)
-        {
-#ifdef DEBUG
-            System_printf("Button1 release\r\n");
-#endif
-            button1Event = 0;
-        }
-
-        /* Detect button2 */
-        if(button2Event & EVENT_PRESS)
-        {
-#ifdef CLOSE_TOUCH_PANEL
-           // PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 1);
-            CloseTouch();
-#endif
-            ui.led[0] = LED_NONE;
-            ui.led[1] = LED_R;
-            ui.ledTimes[0] = 0;
-            ui.ledTimes[1] = 4;
-            ui.ledType[0] = LED_FLASH;
-            ui.ledType[1] = LED_FLASH;
-            ui.lowPower = LOWPOWER_LED_NONE;
-            ui.lowPowerTimes = 0;
-            ui.beepType = BEEP_NONE;
-            ui.beepTimes = 0;
-#ifdef DEBUG
-            System_printf("Button2 press\r\n");
-#endif
-            button2Event = 0;
-            SetUI(ui, true);
-#ifdef CLOSE_TOUCH_PANEL
-           // PIN_setOutputValue(keypadIntPinHandle, Board_DIO28_KEYPAD_INT, 0);
-#endif
-        }
-        else if(button2Event & EVENT_PRESS_LONG)
+        /* Detect button */
+        while(Button_getEvent(&buttonIndex, &buttonEvent))
         {
-            ui.led[0] = LED_NONE;
-            ui.led[1] = LED_R;
-            ui.ledTimes[0] = 0;
-            ui.ledTimes[1] = 5;
-            ui.ledType[0] = LED_FLASH;
-            ui.ledType[1] = LED_FLASH;
-            ui.lowPower = LOWPOWER_LED_NONE;
-            ui.lowPowerTimes = 0;
-            ui.beepType = BEEP_ON;
-            ui.beepTimes = 5;
-#ifdef DEBUG
-            System_printf("Button2 long press\r\n");
+#ifdef KEYPAD_UART_WAKE
+            KeypadPower_activity();
 #endif
-            button2Event = 0;
-            SetUI(ui, true);
-        }
-        else if(button2Event & EVENT_RELEASE)
-        {
-#ifdef DEBUG
-            System_printf("Button2 release\r\n");
-#endif
-            button2Event = 0;
+            ProcessButtonEvent(buttonIndex, buttonEvent);
         }
 
 #ifdef DETECT_SW
         /* Detect SW1 */
         if(!PIN_getInputValue(PIN_ID(Board_DIO14_MOTOR_SW1)))
         {
-            ui.led[0] = LED_G;
-            ui.led[1] = LED_NONE;
-            ui.ledTimes[0] = 5;
-            ui.ledTimes[1] = 0;
-            ui.ledType[0] = LED_FLASH;
-            ui.ledType[1] = LED_FLASH;
-            ui.lowPower = LOWPOWER_LED_NONE;
-            ui.lowPowerTimes = 0;
-            ui.beepType = BEEP_NONE;
-            ui.beepTimes = 0;
-#ifdef DEBUG
-            System_printf("SW1 press\r\n");
-#endif
-            SetUI(ui, true);
+            TLOG0(TLOG_SW1_PRESS);
+            SetUI(UI_MSG_FRONT_FLASH(LED_G, 5, 0), true);
         }
 
         /* Detect SW2 */
         if(!PIN_getInputValue(PIN_ID(Board_DIO15_MOTOR_SW2)))
         {
-            ui.led[0] = LED_R;
-            ui.led[1] = LED_NONE;
-            ui.ledTimes[0] = 5;
-            ui.ledTimes[1] = 0;
-            ui.ledType[0] = LED_FLASH;
-            ui.ledType[1] = LED_FLASH;
-            ui.lowPower = LOWPOWER_LED_NONE;
-            ui.lowPowerTimes = 0;
-            ui.beepType = BEEP_NONE;
-            ui.beepTimes = 0;
-#ifdef DEBUG
-            System_printf("SW2 press\r\n");
-#endif
-            SetUI(ui, true);
+            TLOG0(TLOG_SW2_PRESS);
+            SetUI(UI_MSG_FRONT_FLASH(LED_R, 5, 0), true);
         }
 #endif
 
-        Task_sleep(sleepTickCount);
+        /* Idle work: battery and temperature measurements, trace and crash record dumps */
+        Battery_idle();
+        Temperature_idle();
+        Trace_idle();
+        Fault_idle();
+
+        /* Sleep until the next poll or until the keypad needs service */
+        Semaphore_pend(maintaskSem, sleepTickCount);
     }
 }
 
@@ -2172,10 +2111,21 @@ int main()
 {
     /* Call driver init functions */
     Board_init();
+    /* Before anything that logs a trace event */
+    Trace_init();
+    Fault_init();
     UART_init();
     PWM_init();
     ADC_init();
-#ifdef DEBUG
+    ADCBuf_init();
+    NVS_init();
+#ifdef TEMPERATURE_TMP116
+    I2C_init();
+#endif
+#if defined(KEYPAD_AUTH) && !defined(KEYPAD_AUTH_SOFTWARE)
+    AESCCM_init();
+#endif
+#if defined(DEBUG) || defined(TLOG_ENABLE)
     InitDebugPort();
 #endif
     InitGlobalParameter();
@@ -0,0 +1,134 @@
+/*
+ *  ======== pin_entry.c ========
+ *  PIN entry engine.
+ *
+ *  Assembles digits from the keypad into a bounded buffer. '*' clears the
+ *  entry, '#' submits it to the credential store. A pause longer than
+ *  PIN_ENTRY_TIMEOUT_MS between keys restarts the entry, and the buffer is
+ *  wiped after every submit so digits don't linger in RAM.
+ *
+ *  PinEntry_enrol() turns the next entry into an enrolment: the submitted
+ *  PIN is added to the credential store instead of being verified. That
+ *  is how units are provisioned, the store starts empty.
+ */
+
+#include <string.h>
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/knl/Clock.h>
+
+#include "credstore.h"
+#include "pin_entry.h"
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static char pinDigits[CREDSTORE_PIN_MAX];
+static uint8_t pinLength;
+static bool pinOverflow;
+static uint32_t pinLastKeyTick;
+static bool pinEnrol;                   //the entry enrolls a new PIN
+static uint16_t pinEnrolUserId;
+
+/**
+  * @brief  Initialize PIN entry engine.
+  * @param none
+  * @return none
+  */
+void PinEntry_init(void)
+{
+    PinEntry_clear();
+    pinLastKeyTick = Clock_getTicks();
+}
+
+/**
+  * @brief  Drop the digits typed so far.
+  * @param none
+  * @return none
+  */
+void PinEntry_clear(void)
+{
+    memset(pinDigits, 0, sizeof(pinDigits));
+    pinLength = 0;
+    pinOverflow = false;
+    pinEnrol = false;
+}
+
+/**
+  * @brief  Enrol the next PIN entered instead of verifying it. Cancelled
+  *         by '*' or PIN_ENTRY_ENROL_TIMEOUT_MS without a key.
+  * @param userId : user the new PIN belongs to.
+  * @return none
+  */
+void PinEntry_enrol(uint16_t userId)
+{
+    PinEntry_clear();
+    pinEnrol = true;
+    pinEnrolUserId = userId;
+    pinLastKeyTick = Clock_getTicks();
+}
+
+/**
+  * @brief  Feed one key to the PIN entry engine.
+  * @param key : key code '0'~'9', '*' or '#'.
+  * @param userId : output, user of an accepted PIN, may be NULL.
+  * @return what the key did
+  */
+PinEntryResult PinEntry_key(char key, uint16_t *userId)
+{
+    uint32_t now = Clock_getTicks();
+    uint32_t timeoutMs = pinEnrol ? PIN_ENTRY_ENROL_TIMEOUT_MS : PIN_ENTRY_TIMEOUT_MS;
+    PinEntryResult result;
+
+    if((now - pinLastKeyTick) > (timeoutMs * (1000 / Clock_tickPeriod)))
+        PinEntry_clear();
+    pinLastKeyTick = now;
+
+    if(('0' <= key) && ('9' >= key))
+    {
+        /* Keep swallowing digits after an overflow so a long sequence can't end on a valid PIN */
+        if(pinOverflow || (pinLength >= CREDSTORE_PIN_MAX))
+        {
+            pinOverflow = true;
+            return PIN_ENTRY_OVERFLOW;
+        }
+        pinDigits[pinLength++] = key;
+        return PIN_ENTRY_DIGIT;
+    }
+
+    if('*' == key)
+    {
+        PinEntry_clear();
+        return PIN_ENTRY_CLEARED;
+    }
+
+    if(('#' == key) && pinEnrol)
+    {
+        if((!pinOverflow) && (Credstore_add(pinEnrolUserId, pinDigits, pinLength) == CREDSTORE_SUCCESS))
+        {
+            if(userId)
+                *userId = pinEnrolUserId;
+            result = PIN_ENTRY_ENROLLED;
+        }
+        else
+            result = PIN_ENTRY_ENROL_FAILED;
+        PinEntry_clear();
+        return result;
+    }
+
+    if('#' == key)
+    {
+        if((!pinOverflow) && Credstore_verify(pinDigits, pinLength, userId))
+            result = PIN_ENTRY_ACCEPTED;
+        else
+            result = PIN_ENTRY_REJECTED;
+        PinEntry_clear();
+        return result;
+    }
+
+    return PIN_ENTRY_IGNORED;
+}
@@ -0,0 +1,48 @@
+#ifndef _PIN_ENTRY_H_
+#define _PIN_ENTRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Digits typed so far are dropped when the next key comes later than this */
+#define PIN_ENTRY_TIMEOUT_MS    5000
+/* Same during an enrolment, the first digit included */
+#define PIN_ENTRY_ENROL_TIMEOUT_MS  30000
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum _pinEntryResult {
+    PIN_ENTRY_DIGIT,        //digit stored
+    PIN_ENTRY_OVERFLOW,     //too many digits, entry dropped
+    PIN_ENTRY_CLEARED,      //'*' cleared the entry
+    PIN_ENTRY_ACCEPTED,     //'#' submitted an enrolled PIN
+    PIN_ENTRY_REJECTED,     //'#' submitted an unknown or malformed PIN
+    PIN_ENTRY_IGNORED,      //not a key code
+    PIN_ENTRY_ENROLLED,     //'#' enrolled the PIN of an enrolment
+    PIN_ENTRY_ENROL_FAILED, //'#' submitted a PIN that couldn't be enrolled
+} PinEntryResult;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void PinEntry_init(void);
+extern PinEntryResult PinEntry_key(char key, uint16_t *userId);
+extern void PinEntry_clear(void);
+extern void PinEntry_enrol(uint16_t userId);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_PIN_ENTRY_H_
@@ -0,0 +1,195 @@
+/*
+ *  ======== pulse_train.c ========
+ *  Pulse train generator.
+ *
+ *  Plays a (level, duration) sequence on an output pin. Every level change
+ *  is made first thing in the one-shot callback of a GPTimer, which is then
+ *  reloaded with the next duration, so the edges are placed with
+ *  microsecond precision and no task or Clock involvement. Steps longer
+ *  than one timer period are played in several timer runs.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/drivers/timer/GPTimerCC26XX.h>
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "tlog.h"
+#include "pulse_train.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* GPTimer runs from the 48MHz system clock */
+#define PULSE_TIMER_TICKS_PER_US    48
+
+/* 16-bit timer with prescaler extension gives a 24-bit load value (~349ms) */
+#define PULSE_TIMER_MAX_US          300000
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static GPTimerCC26XX_Handle pulseTimer = NULL;
+
+static PIN_Handle pulsePinHandle;
+static PIN_Id pulsePin;
+static const PulseStep *volatile pulseStep = NULL;  //step being played, NULL when idle
+static uint32_t pulseRemainingUs;                   //time left in the current step
+static PulseTrainCallback pulseCallback;
+
+/**
+  * @brief  Arm the timer for the next part of the current step.
+  * @param none
+  * @return none
+  */
+static void PulseTrain_arm(void)
+{
+    uint32_t us = pulseRemainingUs;
+
+    if(us > PULSE_TIMER_MAX_US)
+        us = PULSE_TIMER_MAX_US;
+    pulseRemainingUs -= us;
+
+    GPTimerCC26XX_setLoadValue(pulseTimer, us * PULSE_TIMER_TICKS_PER_US - 1);
+    GPTimerCC26XX_start(pulseTimer);
+}
+
+/**
+  * @brief  Output the level of the current step, end the train and stop
+  *         the timer on the terminating step.
+  * @param none
+  * @return none
+  */
+static void PulseTrain_step(void)
+{
+    const PulseStep *step = pulseStep;
+    PulseTrainCallback callback;
+
+    PIN_setOutputValue(pulsePinHandle, pulsePin, step->level);
+
+    if(step->durationUs == 0)
+    {
+        /* The one-shot timer has expired but stays started, which keeps the
+         * standby constraint until it is stopped */
+        pulseStep = NULL;
+        GPTimerCC26XX_stop(pulseTimer);
+        callback = pulseCallback;
+        pulseCallback = NULL;
+        if(callback)
+            callback();
+        return;
+    }
+
+    pulseRemainingUs = step->durationUs;
+    PulseTrain_arm();
+}
+
+/**
+  * @brief  Pulse train timer callback, runs in HWI context.
+  * @param handle : GPTimer handle.
+  * @param interruptMask : interrupt reasons.
+  * @return none
+  */
+static void PulseTrain_timerFxn(GPTimerCC26XX_Handle handle, GPTimerCC26XX_IntMask interruptMask)
+{
+    if(pulseStep == NULL)
+        return;
+
+    if(pulseRemainingUs)
+    {
+        PulseTrain_arm();
+        return;
+    }
+
+    pulseStep++;
+    PulseTrain_step();
+}
+
+/**
+  * @brief  Initialize the pulse train timer.
+  * @param none
+  * @return true when success
+  */
+bool PulseTrain_init(void)
+{
+    GPTimerCC26XX_Params timerParams;
+
+    GPTimerCC26XX_Params_init(&timerParams);
+    timerParams.width = GPT_CONFIG_16BIT;
+    timerParams.mode = GPT_MODE_ONESHOT;
+    timerParams.debugStallMode = GPTimerCC26XX_DEBUG_STALL_OFF;
+    pulseTimer = GPTimerCC26XX_open(Board_GPTIMER_PULSE, &timerParams);
+    if(!pulseTimer)
+    {
+        TLOG0(TLOG_PULSE_TIMER_FAILED);
+        return false;
+    }
+    GPTimerCC26XX_registerInterrupt(pulseTimer, PulseTrain_timerFxn, GPT_INT_TIMEOUT);
+    return true;
+}
+
+/**
+  * @brief  Start playing a pulse train in the background.
+  * @param handle : PIN handle owning the pin.
+  * @param pin : output pin.
+  * @param steps : steps terminated by a step with durationUs = 0.
+  * @param callback : called when the train has been played, may be NULL.
+  * @return true when started, false when busy or not initialized
+  */
+bool PulseTrain_play(PIN_Handle handle, PIN_Id pin, const PulseStep *steps, PulseTrainCallback callback)
+{
+    UInt key;
+
+    if((pulseTimer == NULL) || (handle == NULL) || (steps == NULL))
+        return false;
+
+    key = Hwi_disable();
+    if(pulseStep != NULL)
+    {
+        Hwi_restore(key);
+        return false;
+    }
+    pulsePinHandle = handle;
+    pulsePin = pin;
+    pulseCallback = callback;
+    pulseStep = steps;
+    PulseTrain_step();
+    Hwi_restore(key);
+    return true;
+}
+
+/**
+  * @brief  Stop the pulse train being played, if any. The pin keeps its
+  *         current level and the completion callback isn't called.
+  * @param none
+  * @return none
+  */
+void PulseTrain_stop(void)
+{
+    UInt key;
+
+    key = Hwi_disable();
+    if(pulseStep != NULL)
+    {
+        pulseStep = NULL;
+        pulseCallback = NULL;
+        GPTimerCC26XX_stop(pulseTimer);
+    }
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Check whether a pulse train is being played.
+  * @param none
+  * @return true when busy
+  */
+bool PulseTrain_isBusy(void)
+{
+    return (pulseStep != NULL);
+}
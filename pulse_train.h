@@ -0,0 +1,41 @@
+#ifndef _PULSE_TRAIN_H_
+#define _PULSE_TRAIN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ti/drivers/PIN.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*
+ * One step of a pulse train: the pin is driven to level for durationUs.
+ * A step with durationUs = 0 ends the train, its level is left on the pin.
+ */
+typedef struct _pulseStep {
+    uint8_t level;
+    uint32_t durationUs;
+} PulseStep;
+
+/* Called from HWI context when a train has been played */
+typedef void (*PulseTrainCallback)(void);
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern bool PulseTrain_init(void);
+extern bool PulseTrain_play(PIN_Handle handle, PIN_Id pin, const PulseStep *steps, PulseTrainCallback callback);
+extern void PulseTrain_stop(void);
+extern bool PulseTrain_isBusy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_PULSE_TRAIN_H_
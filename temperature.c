@@ -0,0 +1,230 @@
+/*
+ *  ======== temperature.c ========
+ *  Temperature service.
+ *
+ *  With TEMPERATURE_TMP116 the TMP116 on Board_I2C_TMP is used in one-shot
+ *  mode: it shuts down by itself after each conversion, so it only draws
+ *  current while measuring. The conversion is started and read back with
+ *  callback mode I2C transfers and a Clock waits for it, no task blocks.
+ *  Without it the temperature sensor of the battery monitor in the SoC is
+ *  read instead. Either way the value is cached and refreshed from the
+ *  idle main loop every TEMPERATURE_REFRESH_MS.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+#ifdef TEMPERATURE_TMP116
+#include <ti/drivers/I2C.h>
+#else
+#include <ti/devices/cc13x2_cc26x2/driverlib/aon_batmon.h>
+#endif
+
+/* Example/Board Header files */
+#include "Board.h"
+#include "util.h"
+#include "tlog.h"
+#include "temperature.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#ifdef TEMPERATURE_TMP116
+#define TMP116_REG_TEMPERATURE      0x00
+#define TMP116_REG_CONFIG           0x01
+
+/* MOD = one-shot, CONV = 0, AVG = none */
+#define TMP116_CONFIG_ONE_SHOT      0x0C00
+#endif
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+#ifdef TEMPERATURE_TMP116
+static I2C_Handle temperatureI2c = NULL;
+static I2C_Transaction temperatureTransaction;
+static uint8_t temperatureTxBuffer[3];
+static uint8_t temperatureRxBuffer[2];
+static Clock_Struct temperatureConversionClockStruct;
+#endif
+
+static volatile bool temperatureBusy;
+static volatile bool temperatureValid;
+static volatile int16_t temperatureCentiCelsius;
+static uint32_t temperatureTick;            //Clock tick of the latest measurement start
+
+/**
+  * @brief  Cache a measurement.
+  * @param centiCelsius : temperature in 1/100 degree C.
+  * @return none
+  */
+static void Temperature_set(int16_t centiCelsius)
+{
+    temperatureCentiCelsius = centiCelsius;
+    temperatureValid = true;
+}
+
+#ifdef TEMPERATURE_TMP116
+/**
+  * @brief  I2C transfer callback, runs in SWI context.
+  * @param handle : I2C handle.
+  * @param transaction : finished transaction.
+  * @param transferStatus : true when success.
+  * @return none
+  */
+static void Temperature_i2cFxn(I2C_Handle handle, I2C_Transaction *transaction, bool transferStatus)
+{
+    int16_t raw;
+
+    if(!transferStatus)
+    {
+        temperatureBusy = false;
+        return;
+    }
+
+    /* Conversion started, read it back once done */
+    if(transaction->readCount == 0)
+    {
+        Util_startClock(&temperatureConversionClockStruct);
+        return;
+    }
+
+    /* 7.8125 m degree C per LSB = 25/32 of 1/100 degree C */
+    raw = (int16_t)(((uint16_t)temperatureRxBuffer[0] << 8) | temperatureRxBuffer[1]);
+    Temperature_set((int16_t)((int32_t)raw * 25 / 32));
+    temperatureBusy = false;
+}
+
+/**
+  * @brief  Conversion done CLOCK callback function, reads the result.
+  * @param arg0: input parameter for conversion CLOCK callback function
+  * @return none
+  */
+static void Temperature_conversionFxn(UArg arg0)
+{
+    temperatureTxBuffer[0] = TMP116_REG_TEMPERATURE;
+    temperatureTransaction.writeBuf = temperatureTxBuffer;
+    temperatureTransaction.writeCount = 1;
+    temperatureTransaction.readBuf = temperatureRxBuffer;
+    temperatureTransaction.readCount = 2;
+    if(!I2C_transfer(temperatureI2c, &temperatureTransaction))
+        temperatureBusy = false;
+}
+#endif
+
+/**
+  * @brief  Initialize the temperature service and start the first
+  *         measurement.
+  * @param none
+  * @return true when success
+  */
+bool Temperature_init(void)
+{
+#ifdef TEMPERATURE_TMP116
+    I2C_Params params;
+#endif
+
+    temperatureBusy = false;
+    temperatureValid = false;
+    temperatureCentiCelsius = TEMPERATURE_NONE;
+
+#ifdef TEMPERATURE_TMP116
+    Util_constructClock(&temperatureConversionClockStruct, Temperature_conversionFxn, TMP116_CONVERSION_MS, 0, false, 0);
+
+    I2C_Params_init(&params);
+    params.transferMode = I2C_MODE_CALLBACK;
+    params.transferCallbackFxn = Temperature_i2cFxn;
+    params.bitRate = I2C_400kHz;
+    temperatureI2c = I2C_open(Board_I2C_TMP, &params);
+    if(temperatureI2c == NULL)
+    {
+        TLOG0(TLOG_TEMPERATURE_I2C_FAILED);
+        return false;
+    }
+    temperatureTransaction.slaveAddress = TMP116_I2C_ADDRESS;
+#endif
+
+    return Temperature_refresh();
+}
+
+/**
+  * @brief  Start a measurement. Can be called from task or SWI context.
+  * @param none
+  * @return true when started or already running
+  */
+bool Temperature_refresh(void)
+{
+#ifdef TEMPERATURE_TMP116
+    UInt key;
+#endif
+
+    temperatureTick = Clock_getTicks();
+#ifdef TEMPERATURE_TMP116
+    if(temperatureI2c == NULL)
+        return false;
+
+    key = Hwi_disable();
+    if(temperatureBusy)
+    {
+        Hwi_restore(key);
+        return true;
+    }
+    temperatureBusy = true;
+    Hwi_restore(key);
+
+    temperatureTxBuffer[0] = TMP116_REG_CONFIG;
+    temperatureTxBuffer[1] = TMP116_CONFIG_ONE_SHOT >> 8;
+    temperatureTxBuffer[2] = TMP116_CONFIG_ONE_SHOT & 0xFF;
+    temperatureTransaction.writeBuf = temperatureTxBuffer;
+    temperatureTransaction.writeCount = 3;
+    temperatureTransaction.readBuf = NULL;
+    temperatureTransaction.readCount = 0;
+    if(!I2C_transfer(temperatureI2c, &temperatureTransaction))
+    {
+        temperatureBusy = false;
+        return false;
+    }
+    return true;
+#else
+    /* Updated in the background by the battery monitor */
+    Temperature_set((int16_t)(AONBatMonTemperatureGetDegC() * 100));
+    return true;
+#endif
+}
+
+/**
+  * @brief  Measure again TEMPERATURE_REFRESH_MS after the previous
+  *         measurement started, called when the system is idle.
+  * @param none
+  * @return none
+  */
+void Temperature_idle(void)
+{
+    if((Clock_getTicks() - temperatureTick) >= TEMPERATURE_REFRESH_MS * (1000 / Clock_tickPeriod))
+        Temperature_refresh();
+}
+
+/**
+  * @brief  Check whether a measurement is available.
+  * @param none
+  * @return true when Temperature_getCentiCelsius() is valid
+  */
+bool Temperature_isValid(void)
+{
+    return temperatureValid;
+}
+
+/**
+  * @brief  Latest temperature.
+  * @param none
+  * @return 1/100 degree C, TEMPERATURE_NONE when not measured yet
+  */
+int16_t Temperature_getCentiCelsius(void)
+{
+    return temperatureCentiCelsius;
+}
@@ -0,0 +1,40 @@
+#ifndef _TEMPERATURE_H_
+#define _TEMPERATURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* The idle loop measures again once the value is this old */
+#define TEMPERATURE_REFRESH_MS      60000
+
+/* No measurement yet */
+#define TEMPERATURE_NONE            ((int16_t)0x8000)
+
+/* TMP116 on Board_I2C_TMP, ADD0 to ground */
+#define TMP116_I2C_ADDRESS          0x48
+/* One-shot conversion without averaging takes 15.5ms */
+#define TMP116_CONVERSION_MS        20
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern bool Temperature_init(void);
+extern bool Temperature_refresh(void);
+extern void Temperature_idle(void);
+extern bool Temperature_isValid(void);
+extern int16_t Temperature_getCentiCelsius(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_TEMPERATURE_H_
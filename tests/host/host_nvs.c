@@ -0,0 +1,115 @@
+/*
+ *  ======== host_nvs.c ========
+ *  NVS regions in RAM for the host tests.
+ */
+
+#include <string.h>
+
+#include <ti/drivers/NVS.h>
+
+struct NVS_Config_ {
+    uint8_t data[HOST_NVS_REGION_SIZE];
+};
+
+static struct NVS_Config_ hostNvsRegions[HOST_NVS_REGIONS];
+static bool hostNvsFormatted[HOST_NVS_REGIONS];
+
+/**
+  * @brief  Check an access is inside a region.
+  * @param offset : region offset.
+  * @param size : access size.
+  * @return true when valid
+  */
+static bool HostNvs_valid(size_t offset, size_t size)
+{
+    return (offset <= HOST_NVS_REGION_SIZE) && (size <= HOST_NVS_REGION_SIZE - offset);
+}
+
+/**
+  * @brief  Erase a whole region, like a new device.
+  * @param index : region index.
+  * @return none
+  */
+void HostNvs_format(unsigned int index)
+{
+    memset(hostNvsRegions[index].data, 0xFF, HOST_NVS_REGION_SIZE);
+    hostNvsFormatted[index] = true;
+}
+
+/**
+  * @brief  Raw content of a region.
+  * @param index : region index.
+  * @return region bytes
+  */
+uint8_t *HostNvs_region(unsigned int index)
+{
+    return hostNvsRegions[index].data;
+}
+
+void NVS_init(void)
+{
+}
+
+void NVS_Params_init(NVS_Params *params)
+{
+    params->custom = NULL;
+}
+
+NVS_Handle NVS_open(unsigned int index, NVS_Params *params)
+{
+    (void)params;
+    if(index >= HOST_NVS_REGIONS)
+        return NULL;
+    if(!hostNvsFormatted[index])
+        HostNvs_format(index);
+    return &hostNvsRegions[index];
+}
+
+void NVS_close(NVS_Handle handle)
+{
+    (void)handle;
+}
+
+void NVS_getAttrs(NVS_Handle handle, NVS_Attrs *attrs)
+{
+    attrs->regionBase = handle->data;
+    attrs->regionSize = HOST_NVS_REGION_SIZE;
+    attrs->sectorSize = HOST_NVS_SECTOR_SIZE;
+}
+
+int_fast16_t NVS_read(NVS_Handle handle, size_t offset, void *buffer, size_t size)
+{
+    if(!HostNvs_valid(offset, size))
+        return NVS_STATUS_INV_OFFSET;
+    memcpy(buffer, handle->data + offset, size);
+    return NVS_STATUS_SUCCESS;
+}
+
+int_fast16_t NVS_write(NVS_Handle handle, size_t offset, void *buffer, size_t size,
+                       uint_fast16_t flags)
+{
+    const uint8_t *bytes = buffer;
+    size_t i;
+
+    if(!HostNvs_valid(offset, size))
+        return NVS_STATUS_INV_OFFSET;
+    if(flags & NVS_WRITE_ERASE)
+        NVS_erase(handle, offset - offset % HOST_NVS_SECTOR_SIZE, HOST_NVS_SECTOR_SIZE);
+
+    /* Programming only clears bits */
+    for(i = 0; i < size; i++)
+    {
+        handle->data[offset + i] &= bytes[i];
+    }
+    if((flags & NVS_WRITE_POST_VERIFY) && memcmp(handle->data + offset, buffer, size))
+        return NVS_STATUS_ERROR;
+    return NVS_STATUS_SUCCESS;
+}
+
+int_fast16_t NVS_erase(NVS_Handle handle, size_t offset, size_t size)
+{
+    if(!HostNvs_valid(offset, size) || (offset % HOST_NVS_SECTOR_SIZE) || (size % HOST_NVS_SECTOR_SIZE))
+        return NVS_STATUS_INV_OFFSET;
+    memset(handle->data + offset, 0xFF, size);
+    return NVS_STATUS_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/*
+ *  ======== host_rtos.c ========
+ *  Host stand-ins for the TI-RTOS services the tested modules call.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "host_test.h"
+
+int hostTestFailures = 0;
+
+uint32_t Clock_tickPeriod = 10;
+
+static uint32_t hostClockTicks = 0;
+static bool hostClockReal = false;
+
+static pthread_mutex_t hostHwiLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+/**
+  * @brief  Print a formatted string.
+  * @param format : printf format.
+  * @return none
+  */
+void System_printf(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/**
+  * @brief  Flush the output.
+  * @param none
+  * @return none
+  */
+void System_flush(void)
+{
+    fflush(stdout);
+}
+
+/**
+  * @brief  Current tick count.
+  * @param none
+  * @return ticks
+  */
+uint32_t Clock_getTicks(void)
+{
+    struct timespec now;
+
+    if(!hostClockReal)
+        return hostClockTicks;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000) / Clock_tickPeriod);
+}
+
+/**
+  * @brief  Stop a clock, nothing runs clocks on the host.
+  * @param handle : clock.
+  * @return none
+  */
+void Clock_stop(Clock_Handle handle)
+{
+    (void)handle;
+}
+
+/**
+  * @brief  Move the tick count forward.
+  * @param ticks : ticks to add.
+  * @return none
+  */
+void HostClock_advance(uint32_t ticks)
+{
+    hostClockTicks += ticks;
+}
+
+/**
+  * @brief  Make the tick count follow the host monotonic clock, for the
+  *         tests running threads in real time.
+  * @param none
+  * @return none
+  */
+void HostClock_realTime(void)
+{
+    hostClockReal = true;
+}
+
+/**
+  * @brief  Enter a critical section. The threads standing for interrupts
+  *         hold the same lock while they run.
+  * @param none
+  * @return key for Hwi_restore()
+  */
+UInt Hwi_disable(void)
+{
+    pthread_mutex_lock(&hostHwiLock);
+    return 1;
+}
+
+/**
+  * @brief  Leave a critical section.
+  * @param key : Hwi_disable() result.
+  * @return none
+  */
+void Hwi_restore(UInt key)
+{
+    (void)key;
+    pthread_mutex_unlock(&hostHwiLock);
+}
+
+void Semaphore_Params_init(Semaphore_Params *params)
+{
+    params->mode = Semaphore_Mode_COUNTING;
+}
+
+void Semaphore_construct(Semaphore_Struct *sem, int count, Semaphore_Params *params)
+{
+    pthread_mutex_init(&sem->mutex, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->count = count;
+    sem->mode = params ? params->mode : Semaphore_Mode_COUNTING;
+}
+
+Semaphore_Handle Semaphore_handle(Semaphore_Struct *sem)
+{
+    return sem;
+}
+
+void Semaphore_post(Semaphore_Handle handle)
+{
+    pthread_mutex_lock(&handle->mutex);
+    if((handle->mode != Semaphore_Mode_BINARY) || (handle->count == 0))
+        handle->count++;
+    pthread_cond_signal(&handle->cond);
+    pthread_mutex_unlock(&handle->mutex);
+}
+
+bool Semaphore_pend(Semaphore_Handle handle, uint32_t timeout)
+{
+    struct timespec deadline;
+    uint64_t ns;
+    bool result;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    ns = (uint64_t)timeout * Clock_tickPeriod * 1000 + deadline.tv_nsec;
+    deadline.tv_sec += ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+
+    pthread_mutex_lock(&handle->mutex);
+    while(handle->count == 0)
+    {
+        if(timeout == BIOS_NO_WAIT)
+            break;
+        if(timeout == BIOS_WAIT_FOREVER)
+            pthread_cond_wait(&handle->cond, &handle->mutex);
+        else if(pthread_cond_timedwait(&handle->cond, &handle->mutex, &deadline))
+            break;
+    }
+    result = (handle->count > 0);
+    if(result)
+        handle->count--;
+    pthread_mutex_unlock(&handle->mutex);
+    return result;
+}
+
+void Task_sleep(uint32_t ticks)
+{
+    usleep(ticks * Clock_tickPeriod);
+}
@@ -0,0 +1,26 @@
+/*
+ *  ======== host_test.h ========
+ *  Minimal check macros shared by the host tests.
+ */
+
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+#include <stdio.h>
+
+extern int hostTestFailures;
+
+/* Report a failed condition and keep running the test */
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if(!(cond))                                                         \
+        {                                                                   \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            hostTestFailures++;                                             \
+        }                                                                   \
+    } while(0)
+
+/* Exit status of a test program */
+#define HOST_TEST_RESULT()  (hostTestFailures ? 1 : 0)
+
+#endif // !_HOST_TEST_H_
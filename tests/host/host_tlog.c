@@ -0,0 +1,37 @@
+/*
+ *  ======== host_tlog.c ========
+ *  Tokenized log sink for the host tests: each message is printed with
+ *  its format from tlog_ids.h instead of being framed for the decoder.
+ */
+
+#include <stdio.h>
+
+#include "tlog.h"
+
+#define TLOG_FORMAT(id, module, level, format)  format,
+
+volatile uint32_t tlogMask = TLOG_MASK_DEFAULT;
+
+static const char *const hostTlogFormats[] = {
+    TLOG_MESSAGES(TLOG_FORMAT)
+};
+
+/**
+  * @brief  Print a message with its format.
+  * @param id : message ID.
+  * @param argc : number of arguments, up to TLOG_MAX_ARGS.
+  * @param args : arguments.
+  * @return none
+  */
+void Tlog_write(TlogId id, uint8_t argc, const uint32_t *args)
+{
+    uint32_t values[TLOG_MAX_ARGS] = {0};
+    uint8_t i;
+
+    for(i = 0; (i < argc) && (i < TLOG_MAX_ARGS); i++)
+    {
+        values[i] = args[i];
+    }
+    printf(hostTlogFormats[id], values[0], values[1], values[2]);
+    printf("\n");
+}
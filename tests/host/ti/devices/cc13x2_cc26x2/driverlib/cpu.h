@@ -0,0 +1,13 @@
+/*
+ *  ======== cpu.h ========
+ *  Host stand-in, declarations only.
+ */
+
+#ifndef _HOST_CPU_H_
+#define _HOST_CPU_H_
+
+#include <stdint.h>
+
+extern void CPUdelay(uint32_t loops);
+
+#endif // !_HOST_CPU_H_
@@ -0,0 +1,30 @@
+/*
+ *  ======== ti/drivers/ADC.h ========
+ *  Host stand-in, the types and calls of the battery monitor. The
+ *  conversions are simulated by the test (test_battery.c).
+ */
+
+#ifndef _HOST_ADC_H_
+#define _HOST_ADC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADC_STATUS_SUCCESS      0
+#define ADC_STATUS_ERROR        (-1)
+
+typedef struct ADC_Config_ *ADC_Handle;
+
+typedef struct ADC_Params_ {
+    void *custom;
+    bool isProtected;
+} ADC_Params;
+
+extern void ADC_init(void);
+extern void ADC_Params_init(ADC_Params *params);
+extern ADC_Handle ADC_open(uint_least8_t index, ADC_Params *params);
+extern void ADC_close(ADC_Handle handle);
+extern int_fast16_t ADC_convert(ADC_Handle handle, uint16_t *value);
+extern uint32_t ADC_convertRawToMicroVolts(ADC_Handle handle, uint16_t rawAdcValue);
+
+#endif // !_HOST_ADC_H_
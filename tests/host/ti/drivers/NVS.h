@@ -0,0 +1,62 @@
+/*
+ *  ======== ti/drivers/NVS.h ========
+ *  Host stand-in, NVS regions emulated in RAM with the flash programming
+ *  rules: a write can only clear bits, an erase sets a sector to 0xFF.
+ */
+
+#ifndef _HOST_NVS_H_
+#define _HOST_NVS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define NVS_STATUS_SUCCESS      0
+#define NVS_STATUS_ERROR        (-1)
+#define NVS_STATUS_INV_OFFSET   (-4)
+
+#define NVS_WRITE_ERASE         0x1
+#define NVS_WRITE_PRE_VERIFY    0x2
+#define NVS_WRITE_POST_VERIFY   0x4
+
+/* Same layout as the CC26X2R1_LAUNCHXL board file */
+#define HOST_NVS_REGIONS        2
+#define HOST_NVS_SECTOR_SIZE    0x2000
+#define HOST_NVS_REGION_SIZE    (HOST_NVS_SECTOR_SIZE * 2)
+
+typedef struct NVS_Config_ *NVS_Handle;
+
+typedef struct NVS_Params_ {
+    void *custom;
+} NVS_Params;
+
+typedef struct NVS_Attrs_ {
+    void *regionBase;
+    size_t regionSize;
+    size_t sectorSize;
+} NVS_Attrs;
+
+extern void NVS_init(void);
+extern void NVS_Params_init(NVS_Params *params);
+extern NVS_Handle NVS_open(unsigned int index, NVS_Params *params);
+extern void NVS_close(NVS_Handle handle);
+extern void NVS_getAttrs(NVS_Handle handle, NVS_Attrs *attrs);
+extern int_fast16_t NVS_read(NVS_Handle handle, size_t offset, void *buffer, size_t size);
+extern int_fast16_t NVS_write(NVS_Handle handle, size_t offset, void *buffer, size_t size,
+                              uint_fast16_t flags);
+extern int_fast16_t NVS_erase(NVS_Handle handle, size_t offset, size_t size);
+
+/* Test helpers */
+extern void HostNvs_format(unsigned int index);
+extern uint8_t *HostNvs_region(unsigned int index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_HOST_NVS_H_
@@ -0,0 +1,45 @@
+/*
+ *  ======== ti/drivers/PIN.h ========
+ *  Host stand-in, the pin IDs and the calls of the firmware.
+ */
+
+#ifndef _HOST_PIN_H_
+#define _HOST_PIN_H_
+
+#include <stdint.h>
+
+typedef uint32_t PIN_Config;
+typedef uint32_t PIN_Id;
+typedef struct PIN_State_ {
+    int unused;
+} PIN_State;
+typedef PIN_State *PIN_Handle;
+typedef void (*PIN_IntCb)(PIN_Handle handle, PIN_Id pinId);
+
+#define PIN_UNASSIGNED      0xFF
+#define PIN_TERMINATE       0xFE
+#define PIN_ID(x)           ((x) & 0xFF)
+
+#define PIN_GPIO_OUTPUT_EN  (1 << 8)
+#define PIN_GPIO_LOW        0
+#define PIN_GPIO_HIGH       (1 << 9)
+#define PIN_PUSHPULL        0
+#define PIN_DRVSTR_MAX      (1 << 10)
+#define PIN_DRVSTR_MIN      (1 << 11)
+#define PIN_INPUT_EN        (1 << 12)
+#define PIN_INPUT_DIS       (1 << 28)
+#define PIN_NOPULL          0
+#define PIN_PULLUP          (1 << 13)
+#define PIN_PULLDOWN        (1 << 14)
+#define PIN_IRQ_DIS         0
+#define PIN_IRQ_NEGEDGE     (1 << 16)
+#define PIN_IRQ_POSEDGE     (1 << 17)
+#define PIN_IRQ_BOTHEDGES   (3 << 16)
+
+extern PIN_Handle PIN_open(PIN_State *state, const PIN_Config *table);
+extern uint32_t PIN_getInputValue(PIN_Id pinId);
+extern int PIN_setOutputValue(PIN_Handle handle, PIN_Id pinId, uint32_t value);
+extern int PIN_setInterrupt(PIN_Handle handle, PIN_Config config);
+extern int PIN_registerIntCb(PIN_Handle handle, PIN_IntCb cb);
+
+#endif // !_HOST_PIN_H_
@@ -0,0 +1,33 @@
+/*
+ *  ======== ti/drivers/PWM.h ========
+ *  Host stand-in, declarations only.
+ */
+
+#ifndef _HOST_PWM_H_
+#define _HOST_PWM_H_
+
+#include <stdint.h>
+
+typedef struct PWM_Config_ *PWM_Handle;
+
+typedef enum PWM_Period_Units_ { PWM_PERIOD_US, PWM_PERIOD_HZ, PWM_PERIOD_COUNTS } PWM_Period_Units;
+typedef enum PWM_Duty_Units_ { PWM_DUTY_US, PWM_DUTY_FRACTION, PWM_DUTY_COUNTS } PWM_Duty_Units;
+typedef enum PWM_IdleLevel_ { PWM_IDLE_LOW, PWM_IDLE_HIGH } PWM_IdleLevel;
+
+typedef struct PWM_Params_ {
+    PWM_Period_Units periodUnits;
+    uint32_t periodValue;
+    PWM_Duty_Units dutyUnits;
+    uint32_t dutyValue;
+    PWM_IdleLevel idleLevel;
+} PWM_Params;
+
+#define PWM_DUTY_FRACTION_MAX   ((uint32_t)~0)
+
+extern void PWM_init(void);
+extern void PWM_Params_init(PWM_Params *params);
+extern PWM_Handle PWM_open(unsigned int index, PWM_Params *params);
+extern void PWM_start(PWM_Handle handle);
+extern void PWM_stop(PWM_Handle handle);
+
+#endif // !_HOST_PWM_H_
@@ -0,0 +1,47 @@
+/*
+ *  ======== ti/drivers/UART.h ========
+ *  Host stand-in, declarations only.
+ */
+
+#ifndef _HOST_UART_H_
+#define _HOST_UART_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct UART_Config_ *UART_Handle;
+typedef void (*UART_Callback)(UART_Handle handle, void *buf, size_t count);
+
+typedef enum UART_Mode_ { UART_MODE_BLOCKING, UART_MODE_CALLBACK } UART_Mode;
+typedef enum UART_ReturnMode_ { UART_RETURN_FULL, UART_RETURN_NEWLINE } UART_ReturnMode;
+typedef enum UART_DataMode_ { UART_DATA_BINARY, UART_DATA_TEXT } UART_DataMode;
+typedef enum UART_Echo_ { UART_ECHO_OFF, UART_ECHO_ON } UART_Echo;
+
+typedef struct UART_Params_ {
+    UART_Mode readMode;
+    UART_Mode writeMode;
+    uint32_t readTimeout;
+    uint32_t writeTimeout;
+    UART_Callback readCallback;
+    UART_Callback writeCallback;
+    UART_ReturnMode readReturnMode;
+    UART_DataMode readDataMode;
+    UART_DataMode writeDataMode;
+    UART_Echo readEcho;
+    uint32_t baudRate;
+} UART_Params;
+
+#define UART_WAIT_FOREVER   (~0U)
+#define UART_STATUS_SUCCESS 0
+#define UART_ERROR          (-1)
+
+extern void UART_init(void);
+extern void UART_Params_init(UART_Params *params);
+extern UART_Handle UART_open(unsigned int index, UART_Params *params);
+extern void UART_close(UART_Handle handle);
+extern int_fast32_t UART_read(UART_Handle handle, void *buffer, size_t size);
+extern int_fast32_t UART_write(UART_Handle handle, const void *buffer, size_t size);
+extern void UART_readCancel(UART_Handle handle);
+extern int_fast16_t UART_control(UART_Handle handle, uint_fast16_t cmd, void *arg);
+
+#endif // !_HOST_UART_H_
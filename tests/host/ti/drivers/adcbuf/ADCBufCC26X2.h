@@ -0,0 +1,34 @@
+/*
+ *  ======== ti/drivers/adcbuf/ADCBufCC26X2.h ========
+ *  Host stand-in, the parameters extension of the battery monitor.
+ */
+
+#ifndef _HOST_ADCBUFCC26X2_H_
+#define _HOST_ADCBUFCC26X2_H_
+
+#include <ti/drivers/ADCBuf.h>
+
+typedef enum ADCBufCC26X2_Sampling_Duration_ {
+    ADCBufCC26X2_SAMPLING_DURATION_2P7_US,
+    ADCBufCC26X2_SAMPLING_DURATION_341_US,
+    ADCBufCC26X2_SAMPLING_DURATION_10P9_MS
+} ADCBufCC26X2_Sampling_Duration;
+
+typedef enum ADCBufCC26X2_Sampling_Mode_ {
+    ADCBufCC26X2_SAMPING_MODE_SYNCHRONOUS,
+    ADCBufCC26X2_SAMPING_MODE_ASYNCHRONOUS
+} ADCBufCC26X2_Sampling_Mode;
+
+typedef enum ADCBufCC26X2_Reference_Source_ {
+    ADCBufCC26X2_FIXED_REFERENCE,
+    ADCBufCC26X2_VDDS_REFERENCE
+} ADCBufCC26X2_Reference_Source;
+
+typedef struct ADCBufCC26X2_ParamsExtension_ {
+    ADCBufCC26X2_Sampling_Duration samplingDuration;
+    ADCBufCC26X2_Sampling_Mode samplingMode;
+    ADCBufCC26X2_Reference_Source refSource;
+    bool inputScalingEnabled;
+} ADCBufCC26X2_ParamsExtension;
+
+#endif // !_HOST_ADCBUFCC26X2_H_
@@ -0,0 +1,14 @@
+/*
+ *  ======== ti/drivers/uart/UARTCC26XX.h ========
+ *  Host stand-in, the commands used by the firmware.
+ */
+
+#ifndef _HOST_UARTCC26XX_H_
+#define _HOST_UARTCC26XX_H_
+
+#include <ti/drivers/UART.h>
+
+#define UARTCC26XX_CMD_RETURN_PARTIAL_ENABLE    100
+#define UARTCC26XX_CMD_RETURN_PARTIAL_DISABLE   101
+
+#endif // !_HOST_UARTCC26XX_H_
@@ -0,0 +1,16 @@
+/*
+ *  ======== ti/sysbios/BIOS.h ========
+ *  Host stand-in, declarations only.
+ */
+
+#ifndef _HOST_BIOS_H_
+#define _HOST_BIOS_H_
+
+#include <xdc/std.h>
+
+#define BIOS_WAIT_FOREVER   (~(0U))
+#define BIOS_NO_WAIT        0
+
+extern void BIOS_start(void);
+
+#endif // !_HOST_BIOS_H_
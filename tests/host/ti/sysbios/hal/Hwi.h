@@ -0,0 +1,24 @@
+/*
+ *  ======== ti/sysbios/hal/Hwi.h ========
+ *  Host stand-in, interrupts are the threads calling driver callbacks:
+ *  Hwi_disable() takes a recursive lock they hold while they run.
+ */
+
+#ifndef _HOST_HWI_H_
+#define _HOST_HWI_H_
+
+#include <xdc/std.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern UInt Hwi_disable(void);
+extern void Hwi_restore(UInt key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_HOST_HWI_H_
@@ -0,0 +1,42 @@
+/*
+ *  ======== ti/sysbios/knl/Clock.h ========
+ *  Host stand-in, the tick count is set by the test (host_rtos.c) or
+ *  follows the host clock when HostClock_realTime() is called.
+ */
+
+#ifndef _HOST_CLOCK_H_
+#define _HOST_CLOCK_H_
+
+#include <xdc/std.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct Clock_Struct_ {
+    int unused;
+} Clock_Struct;
+typedef Clock_Struct *Clock_Handle;
+typedef void (*Clock_FuncPtr)(UArg arg);
+
+typedef struct Clock_Params_ {
+    UArg arg;
+    uint32_t period;
+    bool startFlag;
+} Clock_Params;
+
+extern uint32_t Clock_tickPeriod;   //us per tick, 10 like the target
+
+extern uint32_t Clock_getTicks(void);
+extern void Clock_stop(Clock_Handle handle);
+
+/* Test helpers */
+extern void HostClock_advance(uint32_t ticks);
+extern void HostClock_realTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_HOST_CLOCK_H_
@@ -0,0 +1,13 @@
+/*
+ *  ======== ti/sysbios/knl/Event.h ========
+ *  Host stand-in, the event IDs util.h names.
+ */
+
+#ifndef _HOST_EVENT_H_
+#define _HOST_EVENT_H_
+
+#define Event_Id_NONE   0
+#define Event_Id_30     (1 << 30)
+#define Event_Id_31     (1u << 31)
+
+#endif // !_HOST_EVENT_H_
@@ -0,0 +1,4 @@
+/*
+ *  ======== ti/sysbios/knl/Queue.h ========
+ *  Host stand-in, nothing used.
+ */
@@ -0,0 +1,33 @@
+/*
+ *  ======== ti/sysbios/knl/Semaphore.h ========
+ *  Host stand-in, a binary semaphore on a pthread condition.
+ */
+
+#ifndef _HOST_SEMAPHORE_H_
+#define _HOST_SEMAPHORE_H_
+
+#include <pthread.h>
+#include <xdc/std.h>
+
+#define Semaphore_Mode_COUNTING 0
+#define Semaphore_Mode_BINARY   1
+
+typedef struct Semaphore_Struct_ {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int count;
+    int mode;
+} Semaphore_Struct;
+typedef Semaphore_Struct *Semaphore_Handle;
+
+typedef struct Semaphore_Params_ {
+    int mode;
+} Semaphore_Params;
+
+extern void Semaphore_Params_init(Semaphore_Params *params);
+extern void Semaphore_construct(Semaphore_Struct *sem, int count, Semaphore_Params *params);
+extern Semaphore_Handle Semaphore_handle(Semaphore_Struct *sem);
+extern void Semaphore_post(Semaphore_Handle handle);
+extern bool Semaphore_pend(Semaphore_Handle handle, uint32_t timeout);
+
+#endif // !_HOST_SEMAPHORE_H_
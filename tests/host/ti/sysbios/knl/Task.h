@@ -0,0 +1,34 @@
+/*
+ *  ======== ti/sysbios/knl/Task.h ========
+ *  Host stand-in, declarations only.
+ */
+
+#ifndef _HOST_TASK_H_
+#define _HOST_TASK_H_
+
+#include <xdc/std.h>
+
+typedef struct Task_Struct_ {
+    int unused;
+} Task_Struct;
+typedef Task_Struct *Task_Handle;
+typedef void (*Task_FuncPtr)(UArg arg0, UArg arg1);
+
+typedef struct Task_Params_ {
+    size_t stackSize;
+    void *stack;
+    int priority;
+} Task_Params;
+
+typedef struct Task_Stat_ {
+    size_t stackSize;
+    size_t used;
+} Task_Stat;
+
+extern void Task_Params_init(Task_Params *params);
+extern void Task_construct(Task_Struct *task, Task_FuncPtr fxn, Task_Params *params, void *eb);
+extern void Task_sleep(uint32_t ticks);
+extern Task_Handle Task_self(void);
+extern void Task_stat(Task_Handle handle, Task_Stat *stat);
+
+#endif // !_HOST_TASK_H_
@@ -0,0 +1,21 @@
+/*
+ *  ======== xdc/runtime/System.h ========
+ *  Host stand-in, System_printf() goes to stdout.
+ */
+
+#ifndef _HOST_SYSTEM_H_
+#define _HOST_SYSTEM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern void System_printf(const char *format, ...);
+extern void System_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_HOST_SYSTEM_H_
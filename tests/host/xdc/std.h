@@ -0,0 +1,27 @@
+/*
+ *  ======== xdc/std.h ========
+ *  Host stand-in for the XDC base types, only what the host tests need.
+ */
+
+#ifndef _HOST_XDC_STD_H_
+#define _HOST_XDC_STD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef void Void;
+typedef char Char;
+typedef int Int;
+typedef unsigned int UInt;
+typedef uint8_t UInt8;
+typedef uint16_t UInt16;
+typedef uint32_t UInt32;
+typedef int32_t Int32;
+typedef uintptr_t UArg;
+typedef int Bool;
+
+#define TRUE    1
+#define FALSE   0
+
+#endif // !_HOST_XDC_STD_H_
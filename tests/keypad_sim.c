@@ -0,0 +1,712 @@
+/*
+ *  ======== keypad_sim.c ========
+ *  Keypad receive path stress harness.
+ *
+ *  Runs the firmware receive path of main.c, keyPadCallback() -> FIFO ->
+ *  ProcessKeypadData(), against a keypad simulated on a pseudo-terminal:
+ *
+ *   - the keypad thread writes keystrokes (or KEYPAD_MSG_KEY frames in the
+ *     KEYPAD_LINK_FRAMED build) to the pty master at line rate, in bursts
+ *     at a configurable key rate, and can corrupt or insert bytes;
+ *   - the UART thread reads the pty slave like the UARTCC26XX driver in
+ *     partial return mode: a read completes when the buffer armed by
+ *     UART_read() is full or the line stays idle for 32 bit periods, then
+ *     keyPadCallback() runs with the Hwi lock held;
+ *   - the main thread stands for the main task: it pends on the task
+ *     semaphore, calls ProcessKeypadData() and optionally stays busy to
+ *     model the rest of the main loop.
+ *
+ *  The FIFO calls are wrapped (ld --wrap) to follow every byte from the
+ *  pty write to its consumption by the task. Reported: latency
+ *  percentiles, bytes dropped on a full FIFO and the FIFO high-water
+ *  mark, followed by the on-target KeypadStats report of the same run.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/drivers/UART.h>
+
+#include "FIFO.h"
+#include "keypad_link.h"
+#include "keypad_stats.h"
+#include "pin_entry.h"
+#include "tlog.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define SIM_SHADOW_SIZE     1024    //more than any FIFOSIZE
+#define SIM_RX_MAX          256
+#define SIM_SETTLE_MS       100     //quiet time that ends a run
+#define SIM_PEND_TICKS      1000    //10 ms
+
+static const char simKeys[] = "0123456789*#";
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct _simConfig {
+    uint32_t keys;          //keys to send
+    uint32_t rate;          //average keys per second
+    uint32_t burst;         //keys (frames) sent back to back
+    uint32_t baud;
+    double corrupt;         //probability a byte gets a flipped bit
+    double insert;          //probability a random byte is inserted before a byte
+    uint32_t busyUs;        //main loop work after each wake-up
+    uint32_t seed;
+    bool check;             //fail unless every key is processed
+} SimConfig;
+
+typedef struct _simUart {
+    int fd;                 //pty slave
+    volatile bool armed;
+    char *buffer;
+    size_t size;
+} SimUart;
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+
+/* main.c */
+extern void InitGlobalParameter(void);
+extern void KeypadUartOpen(void);
+extern void ProcessKeypadData(void);
+extern void keyPadCallback(UART_Handle handle, void *buf, size_t count);
+
+/* The wrapped functions */
+extern bool __real_FIFOPutByte(FIFO_Buf *fifo, char byte);
+extern int __real_FIFOPutBytes(FIFO_Buf *fifo, char *bytes, int count);
+extern bool __real_FIFOGetByte(FIFO_Buf *fifo, char *byte);
+extern int __real_FIFODiscardBytes(FIFO_Buf *fifo, int count);
+extern Semaphore_Handle __real_Semaphore_handle(Semaphore_Struct *sem);
+extern PinEntryResult __real_PinEntry_key(char key, uint16_t *userId);
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static SimConfig simConfig = {
+    .keys = 2000,
+    .rate = 100,
+    .burst = 4,
+    .baud = 115200,
+    .corrupt = 0.0,
+    .insert = 0.0,
+    .busyUs = 0,
+    .seed = 1,
+    .check = false,
+};
+
+static SimUart simUart;
+static Semaphore_Handle simTaskSem;
+static int simMasterFd;
+
+/* Stream bookkeeping, indexed by byte position on the wire */
+static uint64_t *simSendNs;
+static volatile uint32_t simSent;           //bytes written
+static volatile bool simSendDone;
+static uint32_t simKeysSent;
+
+/* Chunk being handed to keyPadCallback() */
+static const char *simChunk;
+static uint32_t simChunkBase;
+static uint32_t simChunkCursor;
+static uint32_t simChunkCount;
+static uint32_t simReceived;                //bytes read from the pty
+static uint32_t simUnarmed;                 //bytes read with no UART_read() pending
+
+/* Stream positions of the bytes in the FIFO */
+static pthread_mutex_t simShadowLock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t simShadow[SIM_SHADOW_SIZE];
+static uint32_t simShadowHead;
+static uint32_t simShadowTail;
+
+/* Results */
+static uint32_t simDropped;
+static int simHighWater;
+static uint32_t simResync;                  //bytes discarded by the frame parser
+static uint32_t simKeysProcessed;
+static uint32_t *simLatencyUs;
+static uint32_t simLatencyCount;
+static volatile uint64_t simLastActivityNs;
+
+/**
+  * @brief  Host monotonic time.
+  * @param none
+  * @return ns
+  */
+static uint64_t Sim_nowNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+  * @brief  Sleep until an absolute monotonic time.
+  * @param ns : wake-up time.
+  * @return none
+  */
+static void Sim_sleepUntil(uint64_t ns)
+{
+    struct timespec deadline;
+
+    deadline.tv_sec = ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+        ;
+}
+
+/**
+  * @brief  Uniform random number in [0, 1).
+  * @param none
+  * @return random number
+  */
+static double Sim_random(void)
+{
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+/**
+  * @brief  Queue the stream position of a byte put into the FIFO.
+  * @param position : stream position.
+  * @return none
+  */
+static void Sim_shadowPush(uint32_t position)
+{
+    pthread_mutex_lock(&simShadowLock);
+    simShadow[simShadowHead++ % SIM_SHADOW_SIZE] = position;
+    pthread_mutex_unlock(&simShadowLock);
+}
+
+/**
+  * @brief  Stream position of the oldest byte in the FIFO.
+  * @param none
+  * @return stream position
+  */
+static uint32_t Sim_shadowPop(void)
+{
+    uint32_t position;
+
+    pthread_mutex_lock(&simShadowLock);
+    position = simShadow[simShadowTail++ % SIM_SHADOW_SIZE];
+    pthread_mutex_unlock(&simShadowLock);
+    return position;
+}
+
+/**
+  * @brief  Record the latency of a byte consumed by the task.
+  * @param position : stream position.
+  * @return none
+  */
+static void Sim_latency(uint32_t position)
+{
+    simLatencyUs[simLatencyCount++] = (uint32_t)((Sim_nowNs() - simSendNs[position]) / 1000);
+    simLastActivityNs = Sim_nowNs();
+}
+
+/**
+  * @brief  Follow the FIFO fill level after a put.
+  * @param fifo : FIFO buffer.
+  * @return none
+  */
+static void Sim_highWater(FIFO_Buf *fifo)
+{
+    int filled = FIFOFilledNumber(fifo);
+
+    if(filled > simHighWater)
+        simHighWater = filled;
+}
+
+/*********************************************************************
+ * WRAPPED FUNCTIONS
+ */
+
+/* Byte stream build: keyPadCallback() puts the valid keys one by one in
+ * chunk order, the invalid ones are skipped, so the next chunk byte
+ * equal to the key is the one being put */
+bool __wrap_FIFOPutByte(FIFO_Buf *fifo, char byte)
+{
+    uint32_t position;
+
+    while((simChunkCursor < simChunkCount) && (simChunk[simChunkCursor] != byte))
+    {
+        simChunkCursor++;
+    }
+    position = simChunkBase + simChunkCursor++;
+
+    if(!__real_FIFOPutByte(fifo, byte))
+    {
+        simDropped++;
+        return false;
+    }
+    Sim_shadowPush(position);
+    Sim_highWater(fifo);
+    return true;
+}
+
+/* Framed build: whole chunks are put, the tail is lost when full */
+int __wrap_FIFOPutBytes(FIFO_Buf *fifo, char *bytes, int count)
+{
+    uint32_t position = simChunkBase + (uint32_t)(bytes - simChunk);
+    int queued = __real_FIFOPutBytes(fifo, bytes, count);
+    int i;
+
+    if(queued < 0)
+        queued = 0;
+    for(i = 0; i < queued; i++)
+    {
+        Sim_shadowPush(position + i);
+    }
+    simDropped += count - queued;
+    Sim_highWater(fifo);
+    return queued;
+}
+
+bool __wrap_FIFOGetByte(FIFO_Buf *fifo, char *byte)
+{
+    if(!__real_FIFOGetByte(fifo, byte))
+        return false;
+    Sim_latency(Sim_shadowPop());
+    return true;
+}
+
+/* A frame is consumed in one discard, a resync drops one byte */
+int __wrap_FIFODiscardBytes(FIFO_Buf *fifo, int count)
+{
+    uint32_t position = 0;
+    int discarded = __real_FIFODiscardBytes(fifo, count);
+    int i;
+
+    for(i = 0; i < discarded; i++)
+    {
+        position = Sim_shadowPop();
+    }
+    if(discarded == 1)
+        simResync++;
+    else if(discarded > 1)
+        Sim_latency(position);
+    return discarded;
+}
+
+/* The task semaphore is the only one InitGlobalParameter() creates */
+Semaphore_Handle __wrap_Semaphore_handle(Semaphore_Struct *sem)
+{
+    simTaskSem = __real_Semaphore_handle(sem);
+    return simTaskSem;
+}
+
+PinEntryResult __wrap_PinEntry_key(char key, uint16_t *userId)
+{
+    simKeysProcessed++;
+    return __real_PinEntry_key(key, userId);
+}
+
+/*********************************************************************
+ * UART DRIVER
+ */
+
+UART_Handle UART_open(unsigned int index, UART_Params *params)
+{
+    return (UART_Handle)&simUart;
+}
+
+void UART_Params_init(UART_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+}
+
+int_fast16_t UART_control(UART_Handle handle, uint_fast16_t cmd, void *arg)
+{
+    return UART_STATUS_SUCCESS;
+}
+
+int_fast32_t UART_read(UART_Handle handle, void *buffer, size_t size)
+{
+    simUart.buffer = buffer;
+    simUart.size = (size < SIM_RX_MAX) ? size : SIM_RX_MAX;
+    simUart.armed = true;
+    return 0;
+}
+
+void UART_readCancel(UART_Handle handle)
+{
+    simUart.armed = false;
+}
+
+void UART_close(UART_Handle handle)
+{
+    simUart.armed = false;
+}
+
+/**
+  * @brief  UART receive interrupt: partial return reads of the pty slave.
+  * @param arg : unused.
+  * @return NULL
+  */
+static void *Sim_uartThread(void *arg)
+{
+    char discard[SIM_RX_MAX];
+    struct pollfd pfd = {simUart.fd, POLLIN, 0};
+    struct timespec idle;
+    size_t filled;
+    ssize_t got;
+    char *buffer;
+    size_t size;
+
+    /* RX timeout of the partial return mode, 32 bit periods */
+    idle.tv_sec = 0;
+    idle.tv_nsec = 32L * 1000000000L / simConfig.baud;
+
+    for(;;)
+    {
+        if(poll(&pfd, 1, 10) <= 0)
+        {
+            if(simSendDone && (simReceived >= simSent))
+                break;
+            continue;
+        }
+
+        if(!simUart.armed)
+        {
+            got = read(simUart.fd, discard, sizeof(discard));
+            if(got > 0)
+            {
+                simUnarmed += got;
+                simReceived += got;
+            }
+            continue;
+        }
+
+        buffer = simUart.buffer;
+        size = simUart.size;
+        filled = 0;
+        while(filled < size)
+        {
+            got = read(simUart.fd, buffer + filled, size - filled);
+            if(got > 0)
+                filled += got;
+            if((filled >= size) || (ppoll(&pfd, 1, &idle, NULL) <= 0))
+                break;
+        }
+        if(filled == 0)
+            continue;
+
+        /* Interrupt context: the task can't enter its critical sections */
+        Hwi_disable();
+        simUart.armed = false;
+        simChunk = buffer;
+        simChunkBase = simReceived;
+        simChunkCursor = 0;
+        simChunkCount = filled;
+        simReceived += filled;
+        keyPadCallback((UART_Handle)&simUart, buffer, filled);
+        Hwi_restore(0);
+        simLastActivityNs = Sim_nowNs();
+    }
+    return NULL;
+}
+
+/*********************************************************************
+ * KEYPAD
+ */
+
+#ifdef KEYPAD_LINK_FRAMED
+/**
+  * @brief  CRC-8 (poly 0x07) of the keypad link.
+  * @param data : bytes.
+  * @param length : number of bytes.
+  * @return CRC
+  */
+static uint8_t Sim_crc8(const uint8_t *data, uint8_t length)
+{
+    uint8_t crc = 0;
+    uint8_t i;
+    uint8_t bit;
+
+    for(i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for(bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+#endif
+
+/**
+  * @brief  Put one byte on the wire at line rate.
+  * @param byte : byte to send.
+  * @param wire : in/out, time the line is free.
+  * @return none
+  */
+static void Sim_writeByte(uint8_t byte, uint64_t *wire)
+{
+    uint64_t now = Sim_nowNs();
+
+    if(*wire < now)
+        *wire = now;
+    *wire += 10ULL * 1000000000ULL / simConfig.baud;
+    Sim_sleepUntil(*wire);
+
+    simSendNs[simSent] = Sim_nowNs();
+    if(write(simMasterFd, &byte, 1) == 1)
+        simSent++;
+}
+
+/**
+  * @brief  Send one byte with error injection.
+  * @param byte : byte to send.
+  * @param wire : in/out, time the line is free.
+  * @return none
+  */
+static void Sim_sendByte(uint8_t byte, uint64_t *wire)
+{
+    if(Sim_random() < simConfig.insert)
+        Sim_writeByte((uint8_t)rand(), wire);
+    if(Sim_random() < simConfig.corrupt)
+        byte ^= (uint8_t)(1 << (rand() % 8));
+    Sim_writeByte(byte, wire);
+}
+
+/**
+  * @brief  Send one key press.
+  * @param key : key code.
+  * @param wire : in/out, time the line is free.
+  * @return none
+  */
+static void Sim_sendKey(char key, uint64_t *wire)
+{
+#ifdef KEYPAD_LINK_FRAMED
+    uint8_t frame[KEYPAD_LINK_HEADER_SIZE + 1 + KEYPAD_LINK_CRC_SIZE];
+    uint8_t i;
+
+    frame[0] = KEYPAD_LINK_SYNC;
+    frame[1] = KEYPAD_MSG_KEY;
+    frame[2] = 1;
+    frame[3] = (uint8_t)key;
+    frame[4] = Sim_crc8(frame + 1, 3);
+    for(i = 0; i < sizeof(frame); i++)
+    {
+        Sim_sendByte(frame[i], wire);
+    }
+#else
+    Sim_sendByte((uint8_t)key, wire);
+#endif
+    simKeysSent++;
+}
+
+/**
+  * @brief  Keypad: bursts of keys at the configured average rate.
+  * @param arg : unused.
+  * @return NULL
+  */
+static void *Sim_keypadThread(void *arg)
+{
+    uint64_t period = (uint64_t)simConfig.burst * 1000000000ULL / simConfig.rate;
+    uint64_t next = Sim_nowNs();
+    uint64_t wire = 0;
+    uint32_t i;
+
+    while(simKeysSent < simConfig.keys)
+    {
+        for(i = 0; (i < simConfig.burst) && (simKeysSent < simConfig.keys); i++)
+        {
+            Sim_sendKey(simKeys[rand() % (sizeof(simKeys) - 1)], &wire);
+        }
+        next += period;
+        Sim_sleepUntil(next);
+    }
+    simSendDone = true;
+    return NULL;
+}
+
+/*********************************************************************
+ * HARNESS
+ */
+
+/**
+  * @brief  Open the pty, raw mode on the slave side.
+  * @param none
+  * @return true when success
+  */
+static bool Sim_openPty(void)
+{
+    struct termios tio;
+
+    simMasterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if((simMasterFd < 0) || grantpt(simMasterFd) || unlockpt(simMasterFd))
+        return false;
+    simUart.fd = open(ptsname(simMasterFd), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(simUart.fd < 0)
+        return false;
+    if(tcgetattr(simUart.fd, &tio))
+        return false;
+    cfmakeraw(&tio);
+    return (tcsetattr(simUart.fd, TCSANOW, &tio) == 0);
+}
+
+/**
+  * @brief  Sort helper.
+  * @param a : first value.
+  * @param b : second value.
+  * @return comparison
+  */
+static int Sim_compare(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+  * @brief  Latency below which a share of the samples falls.
+  * @param permille : share in 1/1000.
+  * @return latency in us
+  */
+static uint32_t Sim_percentile(uint32_t permille)
+{
+    uint32_t index;
+
+    if(simLatencyCount == 0)
+        return 0;
+    index = (uint32_t)(((uint64_t)simLatencyCount * permille + 999) / 1000);
+    return simLatencyUs[(index > 0) ? index - 1 : 0];
+}
+
+/**
+  * @brief  Print the results.
+  * @param none
+  * @return none
+  */
+static void Sim_report(void)
+{
+    qsort(simLatencyUs, simLatencyCount, sizeof(uint32_t), Sim_compare);
+
+    printf("keypad sim: %u keys at %u/s in bursts of %u, %u baud, corrupt %.4f insert %.4f busy %u us\n",
+           simConfig.keys, simConfig.rate, simConfig.burst, simConfig.baud,
+           simConfig.corrupt, simConfig.insert, simConfig.busyUs);
+    printf("bytes sent %u received %u unarmed %u dropped %u resync %u\n",
+           simSent, simReceived, simUnarmed, simDropped, simResync);
+    printf("keys sent %u processed %u, fifo high-water %d\n",
+           simKeysSent, simKeysProcessed, simHighWater);
+    printf("latency us p50 %u p90 %u p99 %u p99.9 %u max %u (%u)\n",
+           Sim_percentile(500), Sim_percentile(900), Sim_percentile(990), Sim_percentile(999),
+           simLatencyCount ? simLatencyUs[simLatencyCount - 1] : 0, simLatencyCount);
+
+    /* The on-target counters of the same run, alone in the log */
+    tlogMask = TLOG_MASK_BIT(TLOG_MODULE_KEYPAD, TLOG_LEVEL_INFO);
+    KeypadStats_report();
+}
+
+/**
+  * @brief  Print the usage.
+  * @param name : program name.
+  * @return none
+  */
+static void Sim_usage(const char *name)
+{
+    printf("usage: %s [-n keys] [-r keys/s] [-b burst] [-B baud] [-e corrupt] [-i insert]\n"
+           "          [-w busy us] [-s seed] [-c]\n"
+           "  -e, -i  probability per byte of a flipped bit, of an inserted byte\n"
+           "  -w      main loop work after each wake-up\n"
+           "  -c      fail unless every key sent is processed\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t keypadThread;
+    pthread_t uartThread;
+    uint32_t maxBytes;
+    int option;
+
+    while((option = getopt(argc, argv, "n:r:b:B:e:i:w:s:ch")) != -1)
+    {
+        switch(option)
+        {
+            case 'n': simConfig.keys = strtoul(optarg, NULL, 0); break;
+            case 'r': simConfig.rate = strtoul(optarg, NULL, 0); break;
+            case 'b': simConfig.burst = strtoul(optarg, NULL, 0); break;
+            case 'B': simConfig.baud = strtoul(optarg, NULL, 0); break;
+            case 'e': simConfig.corrupt = strtod(optarg, NULL); break;
+            case 'i': simConfig.insert = strtod(optarg, NULL); break;
+            case 'w': simConfig.busyUs = strtoul(optarg, NULL, 0); break;
+            case 's': simConfig.seed = strtoul(optarg, NULL, 0); break;
+            case 'c': simConfig.check = true; break;
+            default: Sim_usage(argv[0]); return 2;
+        }
+    }
+    if(!simConfig.rate || !simConfig.burst || !simConfig.baud)
+    {
+        Sim_usage(argv[0]);
+        return 2;
+    }
+
+    /* Every byte can be preceded by an inserted one */
+    maxBytes = simConfig.keys * (KEYPAD_LINK_HEADER_SIZE + 1 + KEYPAD_LINK_CRC_SIZE) * 2;
+    simSendNs = calloc(maxBytes, sizeof(uint64_t));
+    simLatencyUs = calloc(maxBytes, sizeof(uint32_t));
+    if(!simSendNs || !simLatencyUs)
+        return 2;
+    if(!Sim_openPty())
+    {
+        perror("pty");
+        return 2;
+    }
+    srand(simConfig.seed);
+    HostClock_realTime();
+    tlogMask = 0;
+
+    /* The firmware receive path, as InitMaintask() leaves it */
+    InitGlobalParameter();
+    PinEntry_init();
+    KeypadStats_init();
+    KeypadUartOpen();
+
+    simLastActivityNs = Sim_nowNs();
+    pthread_create(&uartThread, NULL, Sim_uartThread, NULL);
+    pthread_create(&keypadThread, NULL, Sim_keypadThread, NULL);
+
+    /* Main task */
+    while(!simSendDone || (simReceived < simSent) ||
+          (Sim_nowNs() - simLastActivityNs < SIM_SETTLE_MS * 1000000ULL))
+    {
+        if(!Semaphore_pend(simTaskSem, SIM_PEND_TICKS))
+            continue;
+        ProcessKeypadData();
+        if(simConfig.busyUs)
+            usleep(simConfig.busyUs);
+    }
+
+    pthread_join(keypadThread, NULL);
+    pthread_join(uartThread, NULL);
+    Sim_report();
+
+    if(simConfig.check && ((simKeysProcessed != simKeysSent) || simDropped || simUnarmed))
+    {
+        printf("keypad sim: FAILED, keys lost\n");
+        return 1;
+    }
+    return 0;
+}
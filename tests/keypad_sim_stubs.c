@@ -0,0 +1,112 @@
+/*
+ *  ======== keypad_sim_stubs.c ========
+ *  Do-nothing stand-ins for the drivers and firmware modules main.c calls
+ *  outside of the keypad receive path, so keypad_sim links the real
+ *  main.c. The receive path itself (FIFO, keypad link, PIN entry,
+ *  credential store, statistics) is the firmware code.
+ */
+
+#include <ti/drivers/PIN.h>
+#include <ti/drivers/PWM.h>
+#include <ti/drivers/UART.h>
+#include <ti/drivers/ADC.h>
+#include <ti/drivers/ADCBuf.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+
+#include "util.h"
+#include "buzzer.h"
+#include "led.h"
+#include "button.h"
+#include "battery.h"
+#include "fuel_gauge.h"
+#include "temperature.h"
+#include "keypad_power.h"
+#include "trace.h"
+#include "fault.h"
+
+/* Drivers */
+void ADC_init(void) {}
+void ADCBuf_init(void) {}
+void PWM_init(void) {}
+void PWM_Params_init(PWM_Params *params) {}
+PWM_Handle PWM_open(unsigned int index, PWM_Params *params) { return NULL; }
+void PWM_start(PWM_Handle handle) {}
+void PWM_stop(PWM_Handle handle) {}
+void UART_init(void) {}
+void CPUdelay(uint32_t loops) {}
+void BIOS_start(void) {}
+void CC26X2R1_LAUNCHXL_initGeneral(void) {}
+
+static PIN_State simPinState;
+PIN_Handle PIN_open(PIN_State *state, const PIN_Config *table) { return &simPinState; }
+uint32_t PIN_getInputValue(PIN_Id pinId) { return 0; }
+int PIN_setOutputValue(PIN_Handle handle, PIN_Id pinId, uint32_t value) { return 0; }
+int PIN_setInterrupt(PIN_Handle handle, PIN_Config config) { return 0; }
+int PIN_registerIntCb(PIN_Handle handle, PIN_IntCb cb) { return 0; }
+
+void Task_Params_init(Task_Params *params) {}
+void Task_construct(Task_Struct *task, Task_FuncPtr fxn, Task_Params *params, void *eb) {}
+Task_Handle Task_self(void) { return NULL; }
+void Task_stat(Task_Handle handle, Task_Stat *stat) { stat->stackSize = 0; stat->used = 0; }
+
+/* Clocks never fire on the host */
+Clock_Handle Util_constructClock(Clock_Struct *pClock, Clock_FuncPtr clockCB, uint32_t clockDuration,
+                                 uint32_t clockPeriod, uint8_t startFlag, UArg arg) { return pClock; }
+void Util_startClock(Clock_Struct *pClock) {}
+void Util_restartClock(Clock_Struct *pClock, uint32_t clockTimeout) {}
+bool Util_isActive(Clock_Struct *pClock) { return false; }
+void Util_stopClock(Clock_Struct *pClock) {}
+
+/* User interface and power */
+const BuzzerNote Buzzer_melodyKey[1];
+const BuzzerNote Buzzer_melodySuccess[1];
+const BuzzerNote Buzzer_melodyFailure[1];
+void Buzzer_init(void) {}
+void Buzzer_on(void) {}
+void Buzzer_off(void) {}
+void Buzzer_play(const BuzzerNote *melody, BuzzerVolume volume) {}
+void Led_init(void) {}
+void Led_set(SetLED led, bool value) {}
+void Led_toggle(SetLED led) {}
+bool Led_isOn(SetLED led) { return false; }
+void Led_setOnLevel(uint8_t level) {}
+uint8_t Led_getOnLevel(void) { return LED_LEVEL_ON_DEFAULT; }
+void Led_fade(SetLED led, uint8_t level, uint16_t durationMs) {}
+void Led_breathe(SetLED led, uint16_t periodMs) {}
+bool Button_init(const ButtonConfig *config, uint8_t count) { return true; }
+bool Button_getEvent(uint8_t *index, ButtonEvent *event) { return false; }
+void KeypadPower_init(KeypadPowerCallback callback, uint32_t idleMs) {}
+void KeypadPower_activity(void) {}
+bool KeypadPower_isReady(void) { return true; }
+
+/* Battery and temperature */
+bool Battery_init(void) { return true; }
+void Battery_idle(void) {}
+bool Battery_get(uint32_t maxAgeMs, uint32_t *microVolt, uint32_t *ageMs) { *microVolt = 3000000; *ageMs = 0; return true; }
+bool Battery_isValid(void) { return true; }
+uint16_t Battery_getRaw(void) { return 0; }
+uint32_t Battery_getMicroVolt(void) { return 3000000; }
+bool Battery_sagStart(void) { return false; }
+void Battery_sagStop(void) {}
+bool Battery_sagProcess(void) { return false; }
+bool Battery_getSag(BatterySag *sag) { return false; }
+void FuelGauge_init(FuelGaugeChemistry chemistry) {}
+void FuelGauge_setTemperature(int16_t centiCelsius) {}
+void FuelGauge_update(uint32_t microVolt) {}
+void FuelGauge_updateSag(uint32_t restMicroVolt, uint32_t loadMicroVolt) {}
+bool FuelGauge_isLow(void) { return false; }
+bool Temperature_init(void) { return false; }
+void Temperature_idle(void) {}
+bool Temperature_isValid(void) { return false; }
+int16_t Temperature_getCentiCelsius(void) { return 2500; }
+
+/* Diagnostics */
+void Trace_init(void) {}
+void Trace_log(TraceEvent event, uint16_t arg) {}
+void Trace_idle(void) {}
+void Fault_init(void) {}
+void Fault_ready(void) {}
+void Fault_idle(void) {}
+void UartPrintf_init(UART_Handle handle) {}
+void UartPrintf_setParams(UART_Params *params) {}
@@ -0,0 +1,114 @@
+/*
+ *  ======== test_aes_ccm.c ========
+ *  Software AES-CCM against the RFC 3610 packet vectors.
+ */
+
+#include <string.h>
+
+#include "aes_ccm.h"
+#include "host/host_test.h"
+
+typedef struct _ccmVector {
+    uint8_t nonce[13];
+    uint8_t length;             //payload bytes, after the 8 AAD bytes
+    uint8_t result[25 + 8];     //ciphertext then the 8-byte MAC
+} CcmVector;
+
+/* RFC 3610 section 8, packet vectors #1 ~ #3 */
+static const uint8_t ccmKey[AES_CCM_KEY_SIZE] = {
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+};
+
+static const CcmVector ccmVectors[] = {
+    {
+        {0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5}, 23,
+        {0x58, 0x8C, 0x97, 0x9A, 0x61, 0xC6, 0x63, 0xD2, 0xF0, 0x66, 0xD0, 0xC2, 0xC0, 0xF9, 0x89, 0x80,
+         0x6D, 0x5F, 0x6B, 0x61, 0xDA, 0xC3, 0x84,
+         0x17, 0xE8, 0xD1, 0x2C, 0xFD, 0xF9, 0x26, 0xE0},
+    },
+    {
+        {0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5}, 24,
+        {0x72, 0xC9, 0x1A, 0x36, 0xE1, 0x35, 0xF8, 0xCF, 0x29, 0x1C, 0xA8, 0x94, 0x08, 0x5C, 0x87, 0xE3,
+         0xCC, 0x15, 0xC4, 0x39, 0xC9, 0xE4, 0x3A, 0x3B,
+         0xA0, 0x91, 0xD5, 0x6E, 0x10, 0x40, 0x09, 0x16},
+    },
+    {
+        {0x00, 0x00, 0x00, 0x05, 0x04, 0x03, 0x02, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5}, 25,
+        {0x51, 0xB1, 0xE5, 0xF4, 0x4A, 0x19, 0x7D, 0x1D, 0xA4, 0x6B, 0x0F, 0x8E, 0x2D, 0x28, 0x2A, 0xE8,
+         0x71, 0xE8, 0x38, 0xBB, 0x64, 0xDA, 0x85, 0x96, 0x57,
+         0x4A, 0xDA, 0xA7, 0x6F, 0xBD, 0x9F, 0xB0, 0xC5},
+    },
+};
+
+#define CCM_AAD_SIZE    8
+#define CCM_MAC_SIZE    8
+
+/**
+  * @brief  Check one vector both ways and the rejection of altered input.
+  * @param ctx : context with the vector key.
+  * @param vector : test vector.
+  * @return none
+  */
+static void TestVector(const AesCcmContext *ctx, const CcmVector *vector)
+{
+    uint8_t packet[CCM_AAD_SIZE + 25];
+    uint8_t output[25];
+    uint8_t plain[25];
+    uint8_t mac[CCM_MAC_SIZE];
+    uint8_t tampered[25];
+    uint8_t i;
+
+    /* The packet counts up from 0, the first 8 bytes are the AAD */
+    for(i = 0; i < sizeof(packet); i++)
+    {
+        packet[i] = i;
+    }
+
+    CHECK(AesCcm_encrypt(ctx, vector->nonce, sizeof(vector->nonce), packet, CCM_AAD_SIZE,
+                         packet + CCM_AAD_SIZE, output, vector->length, mac, CCM_MAC_SIZE));
+    CHECK(memcmp(output, vector->result, vector->length) == 0);
+    CHECK(memcmp(mac, vector->result + vector->length, CCM_MAC_SIZE) == 0);
+
+    CHECK(AesCcm_decrypt(ctx, vector->nonce, sizeof(vector->nonce), packet, CCM_AAD_SIZE,
+                         vector->result, plain, vector->length,
+                         vector->result + vector->length, CCM_MAC_SIZE));
+    CHECK(memcmp(plain, packet + CCM_AAD_SIZE, vector->length) == 0);
+
+    /* One flipped bit anywhere must fail the MAC */
+    memcpy(tampered, vector->result, vector->length);
+    tampered[vector->length - 1] ^= 0x01;
+    CHECK(!AesCcm_decrypt(ctx, vector->nonce, sizeof(vector->nonce), packet, CCM_AAD_SIZE,
+                          tampered, plain, vector->length,
+                          vector->result + vector->length, CCM_MAC_SIZE));
+
+    memcpy(mac, vector->result + vector->length, CCM_MAC_SIZE);
+    mac[0] ^= 0x80;
+    CHECK(!AesCcm_decrypt(ctx, vector->nonce, sizeof(vector->nonce), packet, CCM_AAD_SIZE,
+                          vector->result, plain, vector->length, mac, CCM_MAC_SIZE));
+
+    packet[0] ^= 0x01;
+    CHECK(!AesCcm_decrypt(ctx, vector->nonce, sizeof(vector->nonce), packet, CCM_AAD_SIZE,
+                          vector->result, plain, vector->length,
+                          vector->result + vector->length, CCM_MAC_SIZE));
+}
+
+int main(void)
+{
+    AesCcmContext ctx;
+    uint8_t nonce[AES_CCM_NONCE_MAX] = {0};
+    uint8_t mac[AES_CCM_MAC_MAX];
+    uint8_t i;
+
+    AesCcm_setKey(&ctx, ccmKey);
+    for(i = 0; i < sizeof(ccmVectors) / sizeof(ccmVectors[0]); i++)
+    {
+        TestVector(&ctx, &ccmVectors[i]);
+    }
+
+    /* Parameters CCM does not allow */
+    CHECK(!AesCcm_encrypt(&ctx, nonce, AES_CCM_NONCE_MIN - 1, NULL, 0, NULL, NULL, 0, mac, 8));
+    CHECK(!AesCcm_encrypt(&ctx, nonce, AES_CCM_NONCE_MAX, NULL, 0, NULL, NULL, 0, mac, 5));
+    CHECK(!AesCcm_encrypt(&ctx, nonce, AES_CCM_NONCE_MAX, NULL, 0, NULL, NULL, 0, mac, AES_CCM_MAC_MAX + 2));
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,590 @@
+/*
+ *  ======== test_battery.c ========
+ *  Battery monitor divider duty cycle model.
+ *
+ *  The real battery.c runs a simulated day against stand-ins of the ADC
+ *  drivers, the BAT_CTRL pin and the Clocks, all driven by a simulated
+ *  tick count: the idle loop refreshes the measurement and the motor
+ *  moves TEST_MOVES_PER_DAY times, each move with a sag capture. The test
+ *  checks that every sample is taken with the divider settled, that the
+ *  time the divider is on matches the model of battery.h and that a
+ *  forced measurement ends within BATTERY_WAIT_MS, then prints the divider
+ *  leakage saved against a divider that is always on.
+ *
+ *  Built for ADCBuf and for BATTERY_ADC_SOFTWARE (MOTOR_PWM builds). The
+ *  polled conversions of BATTERY_ADC_SOFTWARE take BATTERY_SAMPLING_US of
+ *  the Clock callback that runs them, which must leave most of each
+ *  sample period to the other Clocks.
+ */
+
+#include <string.h>
+
+#include <ti/drivers/PIN.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+#ifdef BATTERY_ADC_SOFTWARE
+#include <ti/drivers/ADC.h>
+#else
+#include <ti/drivers/ADCBuf.h>
+#endif
+
+#include "Board.h"
+#include "util.h"
+#include "trace.h"
+#include "battery.h"
+#include "host/host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Ticks of 10us */
+#define TEST_TICKS_PER_MS       (1000 / 10)
+#define TEST_TICKS_PER_S        (1000 * TEST_TICKS_PER_MS)
+
+#define TEST_DAY_S              86400
+#define TEST_MOVES_PER_DAY      20
+#define TEST_MOVE_MS            1000
+
+/* The capture must hold the move and its tail, or it ends early */
+#if (TEST_MOVE_MS + BATTERY_SAG_TAIL_MS) * BATTERY_SAG_FREQ_HZ / 1000 > BATTERY_SAG_SAMPLES
+#error "TEST_MOVE_MS too long for BATTERY_SAG_SAMPLES"
+#endif
+
+/* ADC input at rest and while the motor runs; samples read half of it
+   while the divider output is still settling */
+#define TEST_REST_MV            1500
+#define TEST_SAG_MV             1200
+
+/* Pack voltage and divider resistance: not in the firmware, 200k over
+   100k is assumed for the 3:1 ratio of fuel_gauge.h */
+#define TEST_PACK_MV            6000
+#define TEST_DIVIDER_KOHM       300
+
+#define TEST_CLOCKS             4
+
+/* Ticks a polled conversion of BATTERY_ADC_SOFTWARE takes, the
+   acquisition rounded up to the tick */
+#define TEST_SAMPLING_TICKS     ((BATTERY_SAMPLING_US * TEST_TICKS_PER_MS + 999) / 1000)
+
+/* Divider on time of a refresh: settling, then one block. The software
+   block is one sample per Clock tick, the last one converted after the
+   last tick */
+#ifdef BATTERY_ADC_SOFTWARE
+#define TEST_BLOCK_TICKS        (BATTERY_BLOCK_SAMPLES * TEST_TICKS_PER_S / BATTERY_SAMPLE_FREQ_HZ + \
+                                 TEST_SAMPLING_TICKS)
+#define TEST_SAG_BLOCK_MS       (1000 / BATTERY_SAG_FREQ_HZ)
+#else
+#define TEST_BLOCK_TICKS        (BATTERY_BLOCK_SAMPLES * TEST_TICKS_PER_S / BATTERY_SAMPLE_FREQ_HZ)
+#define TEST_SAG_BLOCK_MS       (BATTERY_SAG_BLOCK * 1000 / BATTERY_SAG_FREQ_HZ)
+#endif
+#define TEST_REFRESH_TICKS      (BATTERY_SETTLE_MS * TEST_TICKS_PER_MS + TEST_BLOCK_TICKS)
+
+/* Divider on time of a move: settling before the motor, the move and the
+   tail, which ends on a sag block and is seen by the 10ms polling of
+   Test_move() */
+#define TEST_MOVE_TICKS         ((BATTERY_SETTLE_MS + TEST_MOVE_MS + BATTERY_SAG_TAIL_MS) * TEST_TICKS_PER_MS)
+#define TEST_MOVE_SLACK_TICKS   ((2 * TEST_SAG_BLOCK_MS + 10) * TEST_TICKS_PER_MS)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct _testClock {
+    Clock_Struct *clock;
+    Clock_FuncPtr fxn;
+    UArg arg;
+    uint64_t timeout;
+    uint64_t period;
+    uint64_t expiry;
+    bool active;
+} TestClock;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint64_t testNow;                //ticks
+static TestClock testClocks[TEST_CLOCKS];
+static uint8_t testClockCount;
+
+static bool testDividerOn;
+static bool testDividerMove;            //switched on for a move
+static uint64_t testDividerSince;
+static uint64_t testDividerTicks;       //total time on
+static uint32_t testRefreshes;
+static uint32_t testMoves;
+static bool testInMove;
+static bool testMotorOn;
+static uint32_t testSamples;
+static uint32_t testUnsettled;          //samples taken before the divider settled
+static uint64_t testCallbackMaxTicks;   //longest Clock callback
+
+#ifndef BATTERY_ADC_SOFTWARE
+static uint8_t testAdcBufInstance;
+static bool testAdcBufOpen;
+static ADCBuf_Params testAdcBufParams;
+static ADCBuf_Conversion *testConversion;
+static bool testConversionRunning;
+static uint64_t testConversionEnd;
+static uint8_t testConversionHalf;
+static bool testConversionSettled;
+#else
+static uint8_t testAdcInstance;
+#endif
+
+/*********************************************************************
+ * STAND-INS
+ */
+
+void Trace_log(TraceEvent event, uint16_t arg) {}
+
+static PIN_State testPinState;
+PIN_Handle PIN_open(PIN_State *state, const PIN_Config *table) { return &testPinState; }
+
+/**
+  * @brief  BAT_CTRL output, accounts the time the divider is on.
+  * @param handle : pin handle.
+  * @param pinId : pin.
+  * @param value : level.
+  * @return 0
+  */
+int PIN_setOutputValue(PIN_Handle handle, PIN_Id pinId, uint32_t value)
+{
+    bool on = (value == BATTERY_DIVIDER_ON);
+    uint64_t ticks;
+
+    if((pinId != Board_DIO13_BAT_CTRL) || (on == testDividerOn))
+        return 0;
+
+    testDividerOn = on;
+    if(on)
+    {
+        testDividerSince = testNow;
+        testDividerMove = testInMove;
+        return 0;
+    }
+
+    ticks = testNow - testDividerSince;
+    testDividerTicks += ticks;
+    if(testDividerMove)
+    {
+        testMoves++;
+        CHECK((ticks >= TEST_MOVE_TICKS) && (ticks <= TEST_MOVE_TICKS + TEST_MOVE_SLACK_TICKS));
+    }
+    else
+    {
+        testRefreshes++;
+        CHECK(ticks == TEST_REFRESH_TICKS);
+    }
+    return 0;
+}
+
+/**
+  * @brief  Check whether the divider output settled.
+  * @param none
+  * @return true when settled
+  */
+static bool Test_settled(void)
+{
+    return testDividerOn && (testNow - testDividerSince >= BATTERY_SETTLE_MS * TEST_TICKS_PER_MS);
+}
+
+/**
+  * @brief  Value read by the ADC now.
+  * @param settled : divider output settled when the sample was taken.
+  * @return ADC value, mV at the input
+  */
+static uint16_t Test_sample(bool settled)
+{
+    uint16_t value = testMotorOn ? TEST_SAG_MV : TEST_REST_MV;
+
+    testSamples++;
+    if(settled)
+        return value;
+    testUnsettled++;
+    return value / 2;
+}
+
+/**
+  * @brief  Find the stand-in of a Clock.
+  * @param pClock : clock.
+  * @return clock stand-in
+  */
+static TestClock *Test_clock(Clock_Struct *pClock)
+{
+    uint8_t i;
+
+    for(i = 0; i < testClockCount; i++)
+    {
+        if(testClocks[i].clock == pClock)
+            return &testClocks[i];
+    }
+    return NULL;
+}
+
+Clock_Handle Util_constructClock(Clock_Struct *pClock, Clock_FuncPtr clockCB, uint32_t clockDuration,
+                                 uint32_t clockPeriod, uint8_t startFlag, UArg arg)
+{
+    TestClock *clock = &testClocks[testClockCount++];
+
+    clock->clock = pClock;
+    clock->fxn = clockCB;
+    clock->arg = arg;
+    clock->timeout = (uint64_t)clockDuration * TEST_TICKS_PER_MS;
+    clock->period = (uint64_t)clockPeriod * TEST_TICKS_PER_MS;
+    clock->active = false;
+    if(startFlag)
+        Util_startClock(pClock);
+    return pClock;
+}
+
+void Util_startClock(Clock_Struct *pClock)
+{
+    TestClock *clock = Test_clock(pClock);
+
+    clock->expiry = testNow + clock->timeout;
+    clock->active = true;
+}
+
+void Util_stopClock(Clock_Struct *pClock)
+{
+    Test_clock(pClock)->active = false;
+}
+
+bool Util_isActive(Clock_Struct *pClock)
+{
+    return Test_clock(pClock)->active;
+}
+
+#ifndef BATTERY_ADC_SOFTWARE
+void ADCBuf_Params_init(ADCBuf_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+}
+
+ADCBuf_Handle ADCBuf_open(uint_least8_t index, ADCBuf_Params *params)
+{
+    if(testAdcBufOpen)
+        return NULL;
+    /* The acquisition of the divider output fits the sample period */
+    CHECK(params->custom != NULL);
+    CHECK(2 * BATTERY_SAMPLING_US <= 1000000 / params->samplingFrequency);
+    testAdcBufOpen = true;
+    testAdcBufParams = *params;
+    return (ADCBuf_Handle)&testAdcBufInstance;
+}
+
+void ADCBuf_close(ADCBuf_Handle handle)
+{
+    testConversionRunning = false;
+    testAdcBufOpen = false;
+}
+
+/**
+  * @brief  Time a block of the running conversion takes.
+  * @param none
+  * @return ticks
+  */
+static uint64_t Test_blockTicks(void)
+{
+    return (uint64_t)testConversion->samplesRequestedCount * TEST_TICKS_PER_S / testAdcBufParams.samplingFrequency;
+}
+
+int_fast16_t ADCBuf_convert(ADCBuf_Handle handle, ADCBuf_Conversion conversions[], uint_fast8_t channelCount)
+{
+    if(!testAdcBufOpen || testConversionRunning)
+        return ADCBuf_STATUS_ERROR;
+
+    testConversion = &conversions[0];
+    testConversionRunning = true;
+    testConversionHalf = 0;
+    testConversionSettled = Test_settled();
+    testConversionEnd = testNow + Test_blockTicks();
+    return ADCBuf_STATUS_SUCCESS;
+}
+
+int_fast16_t ADCBuf_convertCancel(ADCBuf_Handle handle)
+{
+    testConversionRunning = false;
+    return ADCBuf_STATUS_SUCCESS;
+}
+
+int_fast16_t ADCBuf_adjustRawValues(ADCBuf_Handle handle, void *sampleBuffer, uint_fast16_t sampleCount,
+                                    uint32_t adcChannel)
+{
+    return ADCBuf_STATUS_SUCCESS;
+}
+
+int_fast16_t ADCBuf_convertAdjustedToMicroVolts(ADCBuf_Handle handle, uint32_t adcChannel,
+                                                void *adjustedSampleBuffer, uint32_t outputMicroVoltBuffer[],
+                                                uint_fast16_t sampleCount)
+{
+    uint_fast16_t i;
+
+    for(i = 0; i < sampleCount; i++)
+    {
+        outputMicroVoltBuffer[i] = (uint32_t)((uint16_t *)adjustedSampleBuffer)[i] * 1000;
+    }
+    return ADCBuf_STATUS_SUCCESS;
+}
+
+/**
+  * @brief  End the block of the running conversion: fill it, then stop or
+  *         go on with the other half in continuous mode.
+  * @param none
+  * @return none
+  */
+static void Test_conversionEnd(void)
+{
+    ADCBuf_Conversion *conversion = testConversion;
+    uint16_t *samples = (testConversionHalf && conversion->sampleBufferTwo) ?
+                        conversion->sampleBufferTwo : conversion->sampleBuffer;
+    uint16_t i;
+
+    for(i = 0; i < conversion->samplesRequestedCount; i++)
+    {
+        samples[i] = Test_sample(testConversionSettled);
+    }
+
+    if(testAdcBufParams.recurrenceMode == ADCBuf_RECURRENCE_MODE_CONTINUOUS)
+    {
+        testConversionHalf ^= 1;
+        testConversionSettled = Test_settled();
+        testConversionEnd = testNow + Test_blockTicks();
+    }
+    else
+    {
+        testConversionRunning = false;
+    }
+    testAdcBufParams.callbackFxn((ADCBuf_Handle)&testAdcBufInstance, conversion, samples,
+                                 conversion->adcChannel, ADCBuf_STATUS_SUCCESS);
+}
+#else
+void ADC_Params_init(ADC_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->isProtected = true;
+}
+
+ADC_Handle ADC_open(uint_least8_t index, ADC_Params *params)
+{
+    /* Conversions run from Clock callbacks, the semaphore would be taken from a Swi */
+    CHECK(!params->isProtected);
+    return (ADC_Handle)&testAdcInstance;
+}
+
+/**
+  * @brief  Polled conversion: the caller is held for the acquisition.
+  * @param handle : ADC handle.
+  * @param value : output ADC value.
+  * @return ADC_STATUS_SUCCESS
+  */
+int_fast16_t ADC_convert(ADC_Handle handle, uint16_t *value)
+{
+    HostClock_advance(TEST_SAMPLING_TICKS);
+    testNow += TEST_SAMPLING_TICKS;
+    *value = Test_sample(Test_settled());
+    return ADC_STATUS_SUCCESS;
+}
+
+uint32_t ADC_convertRawToMicroVolts(ADC_Handle handle, uint16_t rawAdcValue)
+{
+    return (uint32_t)rawAdcValue * 1000;
+}
+#endif
+
+/*********************************************************************
+ * SIMULATION
+ */
+
+/**
+  * @brief  Advance the simulated time, firing the Clocks and ending the
+  *         ADC blocks on the way. A Clock callback that takes time delays
+  *         the ones due meanwhile, like in the Clock Swi.
+  * @param ticks : ticks to run.
+  * @return none
+  */
+static void Test_run(uint64_t ticks)
+{
+    uint64_t end = testNow + ticks;
+    uint64_t next;
+    uint64_t start;
+    TestClock *clock;
+    uint8_t i;
+
+    for(;;)
+    {
+        next = end;
+        clock = NULL;
+        for(i = 0; i < testClockCount; i++)
+        {
+            if(testClocks[i].active && (testClocks[i].expiry <= next))
+            {
+                next = testClocks[i].expiry;
+                clock = &testClocks[i];
+            }
+        }
+#ifndef BATTERY_ADC_SOFTWARE
+        if(testConversionRunning && (testConversionEnd <= next))
+        {
+            next = testConversionEnd;
+            clock = NULL;
+        }
+#endif
+
+        if(next < testNow)
+            next = testNow;
+        HostClock_advance((uint32_t)(next - testNow));
+        testNow = next;
+
+        if(clock)
+        {
+            if(clock->period)
+                clock->expiry += clock->period;
+            else
+                clock->active = false;
+            start = testNow;
+            clock->fxn(clock->arg);
+            if(testNow - start > testCallbackMaxTicks)
+                testCallbackMaxTicks = testNow - start;
+        }
+#ifndef BATTERY_ADC_SOFTWARE
+        else if(testConversionRunning && (testConversionEnd == testNow))
+        {
+            Test_conversionEnd();
+        }
+#endif
+        else if(testNow >= end)
+        {
+            break;
+        }
+    }
+}
+
+/* battery.c sleeps the task while the divider settles before a move */
+void __wrap_Task_sleep(uint32_t ticks)
+{
+    Test_run(ticks);
+}
+
+/* Battery_get() waits for a forced measurement: the simulation runs until
+   the block ends or the timeout */
+bool __wrap_Semaphore_pend(Semaphore_Handle handle, uint32_t timeout)
+{
+    uint32_t waited;
+
+    for(waited = 0; (handle->count == 0) && (waited < timeout); waited++)
+    {
+        Test_run(1);
+    }
+    if(handle->count == 0)
+        return false;
+    handle->count--;
+    return true;
+}
+
+/**
+  * @brief  A measurement forced by a caller ends within BATTERY_WAIT_MS.
+  * @param none
+  * @return none
+  */
+static void Test_forcedGet(void)
+{
+    uint32_t microVolt;
+    uint32_t ageMs;
+    uint64_t start;
+
+    Test_run(TEST_TICKS_PER_S);
+    start = testNow;
+    CHECK(Battery_get(0, &microVolt, &ageMs));
+    CHECK(testNow - start <= BATTERY_WAIT_MS * TEST_TICKS_PER_MS);
+    CHECK(microVolt == TEST_REST_MV * 1000);
+    CHECK(ageMs == 0);
+}
+
+/**
+  * @brief  One motor move with its sag capture, as the motor task does it.
+  * @param none
+  * @return none
+  */
+static void Test_move(void)
+{
+    BatterySag sag;
+    uint16_t waitMs;
+
+    testInMove = true;
+    CHECK(Battery_sagStart());
+    testInMove = false;
+    testMotorOn = true;
+    Test_run(TEST_MOVE_MS * TEST_TICKS_PER_MS);
+    testMotorOn = false;
+    Battery_sagStop();
+
+    for(waitMs = 0; !Battery_sagProcess() && (waitMs < 2 * BATTERY_SAG_TAIL_MS); waitMs += 10)
+    {
+        Test_run(10 * TEST_TICKS_PER_MS);
+    }
+
+    CHECK(Battery_getSag(&sag));
+    CHECK(sag.baselineMicroVolt == TEST_REST_MV * 1000);
+    CHECK(sag.minMicroVolt == TEST_SAG_MV * 1000);
+    CHECK(sag.timeToMinMs == 0);
+    CHECK((sag.loadMs + 20 >= TEST_MOVE_MS) && (sag.loadMs <= TEST_MOVE_MS + 20));
+    CHECK((sag.recoveryMs + 20 >= TEST_MOVE_MS) && (sag.recoveryMs <= TEST_MOVE_MS + 20));
+}
+
+int main(void)
+{
+    uint64_t modelTicks;
+    uint32_t alwaysOnNanoAmp;
+    uint32_t gatedNanoAmp;
+    uint32_t second;
+
+    CHECK(Battery_init());
+    Test_run(BATTERY_WAIT_MS * TEST_TICKS_PER_MS);
+    CHECK(Battery_isValid());
+    CHECK(Battery_getMicroVolt() == TEST_REST_MV * 1000);
+    CHECK(!testDividerOn);
+    Test_forcedGet();
+
+    /* Idle loop every second, moves spread over the day */
+    for(second = 0; second < TEST_DAY_S; second++)
+    {
+        if(second % (TEST_DAY_S / TEST_MOVES_PER_DAY) == TEST_DAY_S / TEST_MOVES_PER_DAY / 2)
+            Test_move();
+        Battery_idle();
+        Test_run(TEST_TICKS_PER_S);
+    }
+    CHECK(!testDividerOn);
+    CHECK(testUnsettled == 0);
+    CHECK(Battery_getMicroVolt() == TEST_REST_MV * 1000);
+
+    /* The other Clocks run within each sample period */
+    CHECK(2 * testCallbackMaxTicks <= TEST_TICKS_PER_S / BATTERY_SAMPLE_FREQ_HZ);
+
+    /* Model: a refresh once per BATTERY_REFRESH_MS of idle time and after
+       every move (its age is checked once per second, so a refresh can be
+       up to a second late), plus the first and the forced ones, plus the
+       moves */
+    CHECK(testMoves == TEST_MOVES_PER_DAY);
+    CHECK(testRefreshes * (BATTERY_REFRESH_MS + 1000) / 1000 >= TEST_DAY_S);
+    CHECK(testRefreshes <= TEST_DAY_S / (BATTERY_REFRESH_MS / 1000) + TEST_MOVES_PER_DAY + 2);
+    modelTicks = (uint64_t)testRefreshes * TEST_REFRESH_TICKS + (uint64_t)testMoves * TEST_MOVE_TICKS;
+    CHECK((testDividerTicks >= modelTicks) &&
+          (testDividerTicks <= modelTicks + (uint64_t)testMoves * TEST_MOVE_SLACK_TICKS));
+
+    alwaysOnNanoAmp = TEST_PACK_MV * 1000 / TEST_DIVIDER_KOHM;
+    gatedNanoAmp = (uint32_t)((uint64_t)alwaysOnNanoAmp * testDividerTicks / testNow);
+    printf("divider on for %u refreshes and %u moves, %u ms/day (model %u ms), duty %u ppm\n",
+           (unsigned)testRefreshes, (unsigned)testMoves, (unsigned)(testDividerTicks / TEST_TICKS_PER_MS),
+           (unsigned)(modelTicks / TEST_TICKS_PER_MS), (unsigned)(testDividerTicks * 1000000 / testNow));
+    printf("samples %u, unsettled %u, longest Clock callback %u us\n", (unsigned)testSamples,
+           (unsigned)testUnsettled, (unsigned)(testCallbackMaxTicks * 1000 / TEST_TICKS_PER_MS));
+    printf("divider leakage %u nA always on, %u nA gated: %u mAh/year saved (%u kohm, %u mV pack)\n",
+           (unsigned)alwaysOnNanoAmp, (unsigned)gatedNanoAmp,
+           (unsigned)((uint64_t)(alwaysOnNanoAmp - gatedNanoAmp) * 24 * 365 / 1000000),
+           TEST_DIVIDER_KOHM, TEST_PACK_MV);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,196 @@
+/*
+ *  ======== test_filter.c ========
+ *  Filter kernels against plain C expectations. Built twice: with
+ *  FILTER_HOST the SIMD kernels run on the host and the benchmark checks
+ *  them against the reference versions, with FILTER_REFERENCE the
+ *  reference versions alone are checked.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "filter.h"
+#include "host/host_test.h"
+
+#define TEST_BLOCK          260
+#define TEST_LOWPASS_FRAC   3
+#define TEST_LOWPASS_SHIFT  14
+
+static uint32_t testSeed = 1;
+
+/**
+  * @brief  Pseudo random number, same sequence on every run.
+  * @param none
+  * @return 16 random bits
+  */
+static uint16_t Test_random(void)
+{
+    testSeed = testSeed * 1103515245 + 12345;
+    return (uint16_t)(testSeed >> 16);
+}
+
+/**
+  * @brief  Fill a block with noise around a level, or with full scale
+  *         values to fill the SIMD lanes.
+  * @param samples : block.
+  * @param count : number of samples.
+  * @param fullScale : true for FILTER_SAMPLE_MAX only.
+  * @return none
+  */
+static void Test_fill(uint16_t *samples, uint16_t count, bool fullScale)
+{
+    uint16_t i;
+
+    for(i = 0; i < count; i++)
+    {
+        samples[i] = fullScale ? FILTER_SAMPLE_MAX : (Test_random() & FILTER_SAMPLE_MAX);
+    }
+}
+
+/**
+  * @brief  Compare two samples for qsort.
+  * @param a : first sample.
+  * @param b : second sample.
+  * @return <0, 0 or >0
+  */
+static int Test_compare(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+/**
+  * @brief  Sum and mean at every start alignment and count.
+  * @param fullScale : full scale block.
+  * @return none
+  */
+static void Test_sum(bool fullScale)
+{
+    static uint16_t samples[TEST_BLOCK];
+    uint32_t expected;
+    uint16_t start;
+    uint16_t count;
+    uint16_t i;
+
+    Test_fill(samples, TEST_BLOCK, fullScale);
+    for(start = 0; start < 4; start++)
+    {
+        for(count = 0; count + start <= TEST_BLOCK; count++)
+        {
+            expected = 0;
+            for(i = 0; i < count; i++)
+            {
+                expected += samples[start + i];
+            }
+            CHECK(Filter_sum(samples + start, count) == expected);
+            if(count)
+                CHECK(Filter_mean(samples + start, count) == (expected + count / 2) / count);
+        }
+    }
+    CHECK(Filter_mean(samples, 0) == 0);
+}
+
+/**
+  * @brief  Low-pass over blocks of every size, state carried across blocks.
+  * @param alpha : Q14 coefficient.
+  * @return none
+  */
+static void Test_lowpass(uint16_t alpha)
+{
+    static uint16_t samples[TEST_BLOCK];
+    FilterLowpass lowpass;
+    int32_t value;
+    uint16_t output;
+    uint16_t count;
+    uint16_t i;
+
+    Test_fill(samples, TEST_BLOCK, false);
+    Filter_lowpassInit(&lowpass, alpha);
+    value = samples[0] << TEST_LOWPASS_FRAC;
+    for(count = 1; count < 40; count++)
+    {
+        output = Filter_lowpass(&lowpass, samples, count);
+        for(i = 0; i < count; i++)
+        {
+            value = (lowpass.alpha * ((int32_t)samples[i] << TEST_LOWPASS_FRAC) +
+                     (FILTER_LOWPASS_ONE - lowpass.alpha) * value + (1 << (TEST_LOWPASS_SHIFT - 1))) >>
+                    TEST_LOWPASS_SHIFT;
+        }
+        CHECK(lowpass.value == value);
+        CHECK(output == ((value + (1 << (TEST_LOWPASS_FRAC - 1))) >> TEST_LOWPASS_FRAC));
+    }
+}
+
+/**
+  * @brief  Median and trimmed mean against a sorted copy.
+  * @param none
+  * @return none
+  */
+static void Test_trimmed(void)
+{
+    uint16_t samples[21];
+    uint16_t sorted[21];
+    uint32_t sum;
+    uint16_t count;
+    uint16_t trim;
+    uint16_t i;
+
+    for(count = 1; count <= 21; count++)
+    {
+        for(trim = 0; trim < 4; trim++)
+        {
+            Test_fill(sorted, count, false);
+            memcpy(samples, sorted, sizeof(samples[0]) * count);
+            qsort(sorted, count, sizeof(sorted[0]), Test_compare);
+
+            if(2 * trim >= count)
+            {
+                CHECK(Filter_trimmedMean(samples, count, trim) == sorted[(count - 1) / 2]);
+                continue;
+            }
+            sum = 0;
+            for(i = trim; i < count - trim; i++)
+            {
+                sum += sorted[i];
+            }
+            CHECK(Filter_trimmedMean(samples, count, trim) ==
+                  (sum + (count - 2 * trim) / 2) / (count - 2 * trim));
+            CHECK(memcmp(samples, sorted, sizeof(samples[0]) * count) == 0);
+        }
+    }
+    CHECK(Filter_median(samples, 0) == 0);
+}
+
+/**
+  * @brief  Moving average primes on the first sample and settles on a step.
+  * @param none
+  * @return none
+  */
+static void Test_ema(void)
+{
+    FilterEma ema;
+    uint16_t i;
+
+    Filter_emaInit(&ema, 3);
+    CHECK(Filter_ema(&ema, 1000) == 1000);
+    for(i = 0; i < 200; i++)
+    {
+        Filter_ema(&ema, 3000);
+    }
+    CHECK(Filter_ema(&ema, 3000) >= 2999);
+}
+
+int main(void)
+{
+    Test_sum(false);
+    Test_sum(true);
+    Test_lowpass(1);
+    Test_lowpass(1000);
+    Test_lowpass(FILTER_LOWPASS_ONE / 2);
+    Test_lowpass(FILTER_LOWPASS_ONE);
+    Test_trimmed();
+    Test_ema();
+#ifdef FILTER_BENCHMARK
+    CHECK(Filter_benchmark());
+#endif
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,260 @@
+/*
+ *  ======== test_keypad_auth.c ========
+ *  Authenticated keypad frames through the link parser: accepted frames,
+ *  replay and tamper rejection, and the counter log across both sectors.
+ *  Plain frames are read in place at every position in the FIFO.
+ */
+
+#include <string.h>
+
+#include <ti/drivers/NVS.h>
+
+#include "Board.h"
+#include "FIFO.h"
+#include "aes_ccm.h"
+#include "keypad_link.h"
+#include "keypad_auth.h"
+#include "host/host_test.h"
+
+#define TEST_FIFO_SIZE      64
+#define TEST_FRAME_MAX      (KEYPAD_LINK_HEADER_SIZE + KEYPAD_LINK_MAX_PAYLOAD + KEYPAD_LINK_CRC_SIZE)
+
+/* Counter records in one log sector */
+#define TEST_SECTOR_RECORDS (HOST_NVS_SECTOR_SIZE / sizeof(uint32_t))
+
+static const uint8_t testKey[AES_CCM_KEY_SIZE] = KEYPAD_AUTH_KEY;
+static const uint8_t testMessage[] = {KEYPAD_MSG_KEY, '2', '5', '8', '0'};
+
+static AesCcmContext testContext;
+static FIFO_Buf testFifo;
+static char testFifoBuffer[TEST_FIFO_SIZE];
+
+/**
+  * @brief  CRC-8 (poly 0x07) of the link, bit by bit.
+  * @param data : bytes.
+  * @param length : number of bytes.
+  * @return CRC
+  */
+static uint8_t TestCrc8(const uint8_t *data, uint8_t length)
+{
+    uint8_t crc = 0;
+    uint8_t i;
+    uint8_t bit;
+
+    for(i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for(bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+  * @brief  Build a KEYPAD_MSG_SECURE frame the way the keypad sends it.
+  * @param counter : frame counter.
+  * @param frame : output, TEST_FRAME_MAX bytes.
+  * @return frame length
+  */
+static uint8_t TestBuildFrame(uint32_t counter, uint8_t *frame)
+{
+    uint8_t nonce[KEYPAD_AUTH_NONCE_SIZE] = {0};
+    uint8_t aad[2];
+    uint8_t length = KEYPAD_AUTH_OVERHEAD + sizeof(testMessage);
+    uint8_t *payload = frame + KEYPAD_LINK_HEADER_SIZE;
+
+    nonce[0] = (uint8_t)counter;
+    nonce[1] = (uint8_t)(counter >> 8);
+    nonce[2] = (uint8_t)(counter >> 16);
+    nonce[3] = (uint8_t)(counter >> 24);
+    nonce[4] = KEYPAD_AUTH_DIR_KEYPAD;
+    aad[0] = KEYPAD_MSG_SECURE;
+    aad[1] = length;
+
+    frame[0] = KEYPAD_LINK_SYNC;
+    frame[1] = KEYPAD_MSG_SECURE;
+    frame[2] = length;
+    memcpy(payload, nonce, KEYPAD_AUTH_COUNTER_SIZE);
+    AesCcm_encrypt(&testContext, nonce, sizeof(nonce), aad, sizeof(aad),
+                   testMessage, payload + KEYPAD_AUTH_COUNTER_SIZE, sizeof(testMessage),
+                   payload + KEYPAD_AUTH_COUNTER_SIZE + sizeof(testMessage), KEYPAD_AUTH_MAC_SIZE);
+    frame[KEYPAD_LINK_HEADER_SIZE + length] = TestCrc8(frame + 1, length + 2);
+    return KEYPAD_LINK_HEADER_SIZE + length + KEYPAD_LINK_CRC_SIZE;
+}
+
+/**
+  * @brief  Feed a frame to the link and open it.
+  * @param frame : frame bytes.
+  * @param size : frame length.
+  * @return KEYPAD_AUTH_OK when accepted
+  */
+static KeypadAuthStatus TestOpen(const uint8_t *frame, uint8_t size)
+{
+    KeypadLinkFrame link;
+    uint8_t message[KEYPAD_AUTH_MAX_MESSAGE];
+    uint8_t length;
+    KeypadAuthStatus status;
+
+    FIFOPutBytes(&testFifo, (char *)frame, size);
+    if(!KeypadLink_parse(&testFifo, &link))
+        return KEYPAD_AUTH_MALFORMED;
+
+    status = KeypadAuth_open(&link, message, &length);
+    KeypadLink_consume(&link);
+    if(status == KEYPAD_AUTH_OK)
+    {
+        CHECK(length == sizeof(testMessage));
+        CHECK(memcmp(message, testMessage, sizeof(testMessage)) == 0);
+    }
+    return status;
+}
+
+/**
+  * @brief  Build and open the frame of a counter.
+  * @param counter : frame counter.
+  * @return KEYPAD_AUTH_OK when accepted
+  */
+static KeypadAuthStatus TestOpenCounter(uint32_t counter)
+{
+    uint8_t frame[TEST_FRAME_MAX];
+
+    return TestOpen(frame, TestBuildFrame(counter, frame));
+}
+
+/**
+  * @brief  Replayed and altered frames are rejected.
+  * @param none
+  * @return none
+  */
+static void TestReplayTamper(void)
+{
+    uint8_t frame[TEST_FRAME_MAX];
+    uint8_t tampered[TEST_FRAME_MAX];
+    uint8_t size;
+    uint8_t i;
+
+    HostNvs_format(Board_NVSKEYPADAUTH);
+    CHECK(KeypadAuth_init());
+
+    size = TestBuildFrame(10, frame);
+    CHECK(TestOpen(frame, size) == KEYPAD_AUTH_OK);
+    CHECK(TestOpen(frame, size) == KEYPAD_AUTH_REPLAY);
+    CHECK(TestOpenCounter(9) == KEYPAD_AUTH_REPLAY);
+    CHECK(TestOpenCounter(11) == KEYPAD_AUTH_OK);
+
+    /* Every payload bit after the counter is covered by the MAC: flip one
+     * and fix the CRC so the frame reaches the authentication */
+    size = TestBuildFrame(20, frame);
+    for(i = KEYPAD_LINK_HEADER_SIZE + KEYPAD_AUTH_COUNTER_SIZE; i < size - KEYPAD_LINK_CRC_SIZE; i++)
+    {
+        memcpy(tampered, frame, size);
+        tampered[i] ^= 0x04;
+        tampered[size - 1] = TestCrc8(tampered + 1, size - 2);
+        CHECK(TestOpen(tampered, size) == KEYPAD_AUTH_MAC_INVALID);
+    }
+
+    /* A new counter on an old frame changes the nonce */
+    memcpy(tampered, frame, size);
+    tampered[KEYPAD_LINK_HEADER_SIZE] ^= 0x01;
+    tampered[size - 1] = TestCrc8(tampered + 1, size - 2);
+    CHECK(TestOpen(tampered, size) == KEYPAD_AUTH_MAC_INVALID);
+
+    /* The rejected frames did not move the counter */
+    CHECK(TestOpen(frame, size) == KEYPAD_AUTH_OK);
+
+    /* A reset must not reopen the window */
+    CHECK(KeypadAuth_init());
+    CHECK(TestOpen(frame, size) == KEYPAD_AUTH_REPLAY);
+    CHECK(TestOpenCounter(21) == KEYPAD_AUTH_OK);
+}
+
+/**
+  * @brief  The counter log wraps over both sectors and is restored at init.
+  * @param none
+  * @return none
+  */
+static void TestCounterLogWrap(void)
+{
+    const uint32_t total = TEST_SECTOR_RECORDS * 2 + TEST_SECTOR_RECORDS / 2;
+    uint32_t counter;
+    uint32_t failures = 0;
+
+    HostNvs_format(Board_NVSKEYPADAUTH);
+    CHECK(KeypadAuth_init());
+
+    for(counter = 1; counter <= total; counter++)
+    {
+        if(TestOpenCounter(counter) != KEYPAD_AUTH_OK)
+            failures++;
+
+        /* Reset around each sector switch */
+        if((counter % TEST_SECTOR_RECORDS == 0) || (counter % TEST_SECTOR_RECORDS == 1))
+        {
+            CHECK(KeypadAuth_init());
+            CHECK(TestOpenCounter(counter) == KEYPAD_AUTH_REPLAY);
+        }
+    }
+    CHECK(failures == 0);
+
+    CHECK(KeypadAuth_init());
+    CHECK(TestOpenCounter(total) == KEYPAD_AUTH_REPLAY);
+    CHECK(TestOpenCounter(total - TEST_SECTOR_RECORDS) == KEYPAD_AUTH_REPLAY);
+    CHECK(TestOpenCounter(total + 1) == KEYPAD_AUTH_OK);
+}
+
+/**
+  * @brief  The in place payload of a plain frame, at every FIFO position:
+  *         only a payload wrapped around the buffer end has none.
+  * @param none
+  * @return none
+  */
+static void TestPayloadInPlace(void)
+{
+    uint8_t frame[KEYPAD_LINK_HEADER_SIZE + 5 + KEYPAD_LINK_CRC_SIZE] = {KEYPAD_LINK_SYNC, KEYPAD_MSG_KEY, 5};
+    KeypadLinkFrame link;
+    const uint8_t *payload;
+    uint8_t position;
+    uint8_t start;
+    uint8_t i;
+
+    memcpy(&frame[KEYPAD_LINK_HEADER_SIZE], "13579", 5);
+    frame[KEYPAD_LINK_HEADER_SIZE + 5] = TestCrc8(&frame[1], 2 + 5);
+
+    for(position = 0; position < TEST_FIFO_SIZE; position++)
+    {
+        FIFOPutBytes(&testFifo, (char *)frame, sizeof(frame));
+        CHECK(KeypadLink_parse(&testFifo, &link));
+        payload = KeypadLink_payload(&link);
+        start = (uint8_t)((testFifo.readIndex + KEYPAD_LINK_HEADER_SIZE) % TEST_FIFO_SIZE);
+        CHECK((payload == NULL) == (start + 5 > TEST_FIFO_SIZE));
+        for(i = 0; i < 5; i++)
+        {
+            CHECK(KeypadLink_payloadByte(&link, i) == frame[KEYPAD_LINK_HEADER_SIZE + i]);
+            if(payload)
+                CHECK(payload[i] == frame[KEYPAD_LINK_HEADER_SIZE + i]);
+        }
+        KeypadLink_consume(&link);
+
+        /* One byte further on the next round */
+        for(i = 0; i < TEST_FIFO_SIZE + 1 - sizeof(frame); i++)
+        {
+            FIFOPutBytes(&testFifo, "x", 1);
+            FIFODiscardBytes(&testFifo, 1);
+        }
+    }
+}
+
+int main(void)
+{
+    AesCcm_setKey(&testContext, testKey);
+    InitialFIFO(sizeof(testFifoBuffer), testFifoBuffer, &testFifo);
+    KeypadLink_init();
+
+    TestReplayTamper();
+    TestCounterLogWrap();
+    TestPayloadInPlace();
+
+    return HOST_TEST_RESULT();
+}
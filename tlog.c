@@ -0,0 +1,191 @@
+/*
+ *  ======== tlog.c ========
+ *  Tokenized binary logger.
+ *
+ *  A log call stores the message ID and its raw arguments as a small
+ *  binary frame instead of formatting text: no format string in flash,
+ *  no printf on target, so it is cheap enough for interrupts. Frames are
+ *  sent by the uart_printf flush ahead of the System_printf text, and
+ *  tools/tlog_decode.py turns them back into text with the formats listed
+ *  in tlog_ids.h.
+ *
+ *  Each message has a module and a level. Messages above the build level
+ *  of their module compile to nothing, the others are filtered at runtime
+ *  by tlogMask, which costs a load and a test per call.
+ */
+
+/* BIOS module Headers */
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "tlog.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define TLOG_BUF_MASK           (TLOG_BUF_LEN - 1)
+
+#if (TLOG_BUF_LEN & TLOG_BUF_MASK) || (TLOG_BUF_LEN > 0x8000)
+#error "TLOG_BUF_LEN must be a power of two up to 0x8000"
+#endif
+
+/* "log" reports the mask, "log <hex>" sets it */
+#define TLOG_COMMAND_NAME       "log"
+#define TLOG_COMMAND_NAME_LEN   3
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/* Fails to build when TLOG_MODULES outgrows the mask */
+typedef char tlogModuleCountCheck[(TLOG_MODULE_COUNT <= TLOG_MAX_MODULES) ? 1 : -1];
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+volatile uint32_t tlogMask = TLOG_MASK_DEFAULT;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint8_t tlogBuffer[TLOG_BUF_LEN];
+static volatile uint16_t tlogHead;      //free running, masked on access
+static volatile uint16_t tlogTail;
+
+/**
+  * @brief  Log a message, any context. The frame is dropped when the ring
+  *         is full.
+  * @param id : message ID.
+  * @param argc : number of arguments, up to TLOG_MAX_ARGS.
+  * @param args : arguments.
+  * @return none
+  */
+void Tlog_write(TlogId id, uint8_t argc, const uint32_t *args)
+{
+    uint8_t frame[TLOG_MAX_FRAME_LEN];
+    uint8_t length = TLOG_HEADER_LEN;
+    uint32_t value;
+    uint16_t head;
+    uint16_t index;
+    uint8_t i;
+    UInt key;
+
+    if(argc > TLOG_MAX_ARGS)
+        argc = TLOG_MAX_ARGS;
+
+    for(i = 0; i < argc; i++)
+    {
+        value = args[i];
+        while(value >= 0x80)
+        {
+            frame[length++] = (uint8_t)value | 0x80;
+            value >>= 7;
+        }
+        frame[length++] = (uint8_t)value;
+    }
+    frame[0] = TLOG_SYNC;
+    frame[1] = (uint8_t)id;
+    frame[2] = (uint8_t)((uint16_t)id >> 8);
+    frame[3] = length - TLOG_HEADER_LEN;
+
+    /* Frames are copied whole so writers in different contexts don't mix */
+    key = Hwi_disable();
+    head = tlogHead;
+    if((uint16_t)(TLOG_BUF_LEN - (uint16_t)(head - tlogTail)) < length)
+    {
+        Hwi_restore(key);
+        return;
+    }
+    for(i = 0; i < length; i++)
+    {
+        index = (head + i) & TLOG_BUF_MASK;
+        tlogBuffer[index] = frame[i];
+    }
+    tlogHead = head + length;
+    Hwi_restore(key);
+}
+
+/**
+  * @brief  Contiguous part of the frames waiting to be sent.
+  * @param data : output start of the data.
+  * @return number of bytes, 0 when empty
+  */
+uint16_t Tlog_peek(const uint8_t **data)
+{
+    uint16_t tail = tlogTail;
+    uint16_t length = tlogHead - tail;
+
+    if(length > TLOG_BUF_LEN - (tail & TLOG_BUF_MASK))
+        length = TLOG_BUF_LEN - (tail & TLOG_BUF_MASK);
+    *data = &tlogBuffer[tail & TLOG_BUF_MASK];
+    return length;
+}
+
+/**
+  * @brief  Release sent bytes.
+  * @param length : bytes returned by Tlog_peek() and sent.
+  * @return none
+  */
+void Tlog_release(uint16_t length)
+{
+    tlogTail += length;
+}
+
+/**
+  * @brief  Set the runtime filter.
+  * @param mask : TLOG_MASK_BIT() of each module and level to log.
+  * @return none
+  */
+void Tlog_setMask(uint32_t mask)
+{
+    uint32_t args[1];
+
+    tlogMask = mask;
+    /* Reported whatever the mask, it is the answer to a request */
+    args[0] = mask;
+    Tlog_write(TLOG_LOG_MASK, 1, args);
+}
+
+/**
+  * @brief  Handle a command line from the debug UART: "log" reports the
+  *         mask, "log <hex>" sets it. Other lines are ignored.
+  * @param line : received line without the line ending.
+  * @param length : length of line.
+  * @return none
+  */
+void Tlog_command(const char *line, uint8_t length)
+{
+    uint32_t mask = 0;
+    uint8_t digits = 0;
+    uint8_t i;
+    char ch;
+
+    if(length < TLOG_COMMAND_NAME_LEN)
+        return;
+    for(i = 0; i < TLOG_COMMAND_NAME_LEN; i++)
+    {
+        if(line[i] != TLOG_COMMAND_NAME[i])
+            return;
+    }
+
+    for(; i < length; i++)
+    {
+        ch = line[i];
+        if(ch == ' ' && digits == 0)
+            continue;
+        if(ch >= '0' && ch <= '9')
+            mask = (mask << 4) | (uint32_t)(ch - '0');
+        else if(ch >= 'a' && ch <= 'f')
+            mask = (mask << 4) | (uint32_t)(ch - 'a' + 10);
+        else if(ch >= 'A' && ch <= 'F')
+            mask = (mask << 4) | (uint32_t)(ch - 'A' + 10);
+        else
+            return;
+        if(++digits > 8)
+            return;
+    }
+
+    Tlog_setMask(digits ? mask : tlogMask);
+}
@@ -0,0 +1,162 @@
+#ifndef _TLOG_H_
+#define _TLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "tlog_ids.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Log levels, a message is built in when its level is at most the level
+ * of its module */
+#define TLOG_LEVEL_NONE         0
+#define TLOG_LEVEL_ERROR        1
+#define TLOG_LEVEL_WARN         2
+#define TLOG_LEVEL_INFO         3
+#define TLOG_LEVEL_DEBUG        4
+
+/* Debug builds log everything, others nothing unless a module asks, e.g.
+ * -DTLOG_LEVEL_MOTOR=TLOG_LEVEL_INFO keeps the motor events in release */
+#ifndef TLOG_LEVEL_DEFAULT
+#ifdef DEBUG
+#define TLOG_LEVEL_DEFAULT      TLOG_LEVEL_DEBUG
+#else
+#define TLOG_LEVEL_DEFAULT      TLOG_LEVEL_NONE
+#endif
+#endif
+
+/* Build levels per module of TLOG_MODULES */
+#ifndef TLOG_LEVEL_MOTOR
+#define TLOG_LEVEL_MOTOR        TLOG_LEVEL_DEFAULT
+#endif
+#ifndef TLOG_LEVEL_KEYPAD
+#define TLOG_LEVEL_KEYPAD       TLOG_LEVEL_DEFAULT
+#endif
+#ifndef TLOG_LEVEL_UI
+#define TLOG_LEVEL_UI           TLOG_LEVEL_DEFAULT
+#endif
+#ifndef TLOG_LEVEL_POWER
+#define TLOG_LEVEL_POWER        TLOG_LEVEL_DEFAULT
+#endif
+#ifndef TLOG_LEVEL_SYSTEM
+#define TLOG_LEVEL_SYSTEM       TLOG_LEVEL_DEFAULT
+#endif
+
+#if !defined(TLOG_ENABLE) && ((TLOG_LEVEL_MOTOR > TLOG_LEVEL_NONE) || \
+    (TLOG_LEVEL_KEYPAD > TLOG_LEVEL_NONE) || (TLOG_LEVEL_UI > TLOG_LEVEL_NONE) || \
+    (TLOG_LEVEL_POWER > TLOG_LEVEL_NONE) || (TLOG_LEVEL_SYSTEM > TLOG_LEVEL_NONE))
+#define TLOG_ENABLE
+#endif
+
+/* Log mask commands on the debug UART RX. An open RX keeps the device out
+ * of standby, so only debug builds listen unless asked to */
+#if defined(TLOG_ENABLE) && defined(DEBUG) && !defined(TLOG_COMMAND)
+#define TLOG_COMMAND
+#endif
+
+/*
+ * Runtime filter, one bit per module and level: bit (module * 4 + level - 1)
+ * lets the messages of that module and level through. Only messages built
+ * in can be turned on.
+ */
+#define TLOG_MAX_MODULES        8
+#define TLOG_MASK_BIT(module, level)    (1UL << ((module) * 4 + (level) - 1))
+#ifndef TLOG_MASK_DEFAULT
+#define TLOG_MASK_DEFAULT       0xFFFFFFFF
+#endif
+
+/* Ring of encoded frames waiting for the debug UART, power of two */
+#define TLOG_BUF_LEN            512
+
+#define TLOG_MAX_ARGS           3
+
+/*
+ * Frame: TLOG_SYNC, ID (16-bit little endian), payload length, then each
+ * argument as an unsigned LEB128 varint (7 bits per byte, low first).
+ */
+#define TLOG_SYNC               0xA5
+#define TLOG_HEADER_LEN         4
+#define TLOG_MAX_FRAME_LEN      (TLOG_HEADER_LEN + 5 * TLOG_MAX_ARGS)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/* <ID>_MODULE, <ID>_LEVEL and <ID>_BUILD constants of each message */
+#define TLOG_FILTER(id, module, level, format) \
+    id##_MODULE = TLOG_MODULE_##module, \
+    id##_LEVEL = TLOG_LEVEL_##level, \
+    id##_BUILD = (TLOG_LEVEL_##level <= TLOG_LEVEL_##module),
+
+enum {
+    TLOG_MESSAGES(TLOG_FILTER)
+};
+
+#undef TLOG_FILTER
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+extern volatile uint32_t tlogMask;
+
+/*********************************************************************
+ * MACROS
+ */
+
+#ifdef TLOG_ENABLE
+/* A constant test when below the build level, so the call is removed */
+#define TLOG_ON(id)             ((id##_BUILD) && (tlogMask & TLOG_MASK_BIT(id##_MODULE, id##_LEVEL)))
+
+#define TLOG0(id)               do { \
+                                    if(TLOG_ON(id)) \
+                                        Tlog_write((id), 0, NULL); \
+                                } while(0)
+#define TLOG1(id, a)            do { \
+                                    if(TLOG_ON(id)) { \
+                                        uint32_t tlogArgs[1] = {(uint32_t)(a)}; \
+                                        Tlog_write((id), 1, tlogArgs); \
+                                    } \
+                                } while(0)
+#define TLOG2(id, a, b)         do { \
+                                    if(TLOG_ON(id)) { \
+                                        uint32_t tlogArgs[2] = {(uint32_t)(a), (uint32_t)(b)}; \
+                                        Tlog_write((id), 2, tlogArgs); \
+                                    } \
+                                } while(0)
+#define TLOG3(id, a, b, c)      do { \
+                                    if(TLOG_ON(id)) { \
+                                        uint32_t tlogArgs[3] = {(uint32_t)(a), (uint32_t)(b), (uint32_t)(c)}; \
+                                        Tlog_write((id), 3, tlogArgs); \
+                                    } \
+                                } while(0)
+#else
+#define TLOG_ON(id)             0
+#define TLOG0(id)               do {} while(0)
+#define TLOG1(id, a)            do {} while(0)
+#define TLOG2(id, a, b)         do {} while(0)
+#define TLOG3(id, a, b, c)      do {} while(0)
+#endif
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void Tlog_write(TlogId id, uint8_t argc, const uint32_t *args);
+extern uint16_t Tlog_peek(const uint8_t **data);
+extern void Tlog_release(uint16_t length);
+extern void Tlog_setMask(uint32_t mask);
+extern void Tlog_command(const char *line, uint8_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_TLOG_H_
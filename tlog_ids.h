@@ -0,0 +1,133 @@
+#ifndef _TLOG_IDS_H_
+#define _TLOG_IDS_H_
+
+/*
+ * Modules for the log filters, at most TLOG_MAX_MODULES. Like messages,
+ * append only: the runtime mask set over the debug UART depends on the
+ * order.
+ */
+#define TLOG_MODULES(X) \
+    X(MOTOR) \
+    X(KEYPAD) \
+    X(UI) \
+    X(POWER) \
+    X(SYSTEM)
+
+/*
+ * Tokenized log messages, X(ID, module, level, "format"). The ID of a
+ * message is its position in the list: append new messages at the end and
+ * never reuse or reorder entries, so older logs keep decoding. The formats
+ * are not built into the firmware, tools/tlog_decode.py reads them from
+ * this file. Formats take %d, %u, %x and %c, one 32-bit argument each.
+ */
+#define TLOG_MESSAGES(X) \
+    X(TLOG_UNLOCKING,               MOTOR,  INFO,  "UnLocking ...") \
+    X(TLOG_LOCKING,                 MOTOR,  INFO,  "Locking ...") \
+    X(TLOG_MOTOR_CLOCKWISE,         MOTOR,  INFO,  "start motor clockwise") \
+    X(TLOG_C_SW2_SW1,               MOTOR,  DEBUG, "C: SW2--SW1") \
+    X(TLOG_C_SW1_SW2,               MOTOR,  DEBUG, "C: SW1--SW2") \
+    X(TLOG_MOTOR_COUNTERCLOCKWISE,  MOTOR,  INFO,  "start motor counterclockwise") \
+    X(TLOG_CC_SW2_SW1,              MOTOR,  DEBUG, "CC: SW2--SW1") \
+    X(TLOG_CC_SW1_SW2,              MOTOR,  DEBUG, "CC: SW1--SW2") \
+    X(TLOG_DIRECTION_NOT_FOUND,     MOTOR,  WARN,  "Not Found Direction") \
+    X(TLOG_DIRECTION_RIGHT,         MOTOR,  INFO,  "Direction = Right") \
+    X(TLOG_DIRECTION_LEFT,          MOTOR,  INFO,  "Direction = left") \
+    X(TLOG_FIRST_SW,                MOTOR,  DEBUG, "firstTriggeredSW: %d") \
+    X(TLOG_SECOND_SW,               MOTOR,  DEBUG, "secondTriggeredSW: %d") \
+    X(TLOG_MOTOR_SW,                MOTOR,  DEBUG, "kidd : %d") \
+    X(TLOG_MOTOR_STOPPED,           MOTOR,  INFO,  "Stopped motor") \
+    X(TLOG_MOTOR1_PWM_FAILED,       MOTOR,  ERROR, "motor1PWM open failed...") \
+    X(TLOG_MOTOR2_PWM_FAILED,       MOTOR,  ERROR, "motor2PWM open failed...") \
+    X(TLOG_MOTOR_DR_PIN_FAILED,     MOTOR,  ERROR, "motor dr pin open failed...") \
+    X(TLOG_MOTOR_SW_PIN_FAILED,     MOTOR,  ERROR, "motor sw pin open failed...") \
+    X(TLOG_MOTOR_SW_CB_FAILED,      MOTOR,  ERROR, "register motor sw callback failed...") \
+    X(TLOG_KEYPAD_POSITIVE_EDGE,    KEYPAD, DEBUG, "positive edge") \
+    X(TLOG_KEYPAD_NEGATIVE_EDGE,    KEYPAD, DEBUG, "negative edge") \
+    X(TLOG_UART1_OPENED,            KEYPAD, INFO,  "uart1 initialized") \
+    X(TLOG_UART1_FAILED,            KEYPAD, ERROR, "uart1 initialized failed...") \
+    X(TLOG_UART1_CLOSED,            KEYPAD, INFO,  "uart1 closed") \
+    X(TLOG_TEST_PIN_FAILED,         SYSTEM, ERROR, "test pin open failed...") \
+    X(TLOG_CYCLE_TEST_VERSION,      SYSTEM, INFO,  "Cycle test version = %d") \
+    X(TLOG_FUNCTION_TEST_VERSION,   SYSTEM, INFO,  "Function test version = %d") \
+    X(TLOG_KEY_SUCCESS,             KEYPAD, DEBUG, "ProcessKeypadData success: Keypad data = %c") \
+    X(TLOG_PIN_ACCEPTED,            KEYPAD, INFO,  "PIN accepted: user = %d") \
+    X(TLOG_PIN_REJECTED,            KEYPAD, WARN,  "PIN rejected") \
+    X(TLOG_PIN_CLEARED,             KEYPAD, INFO,  "PIN cleared") \
+    X(TLOG_BATTERY_BEFORE,          POWER,  DEBUG, "Before Battery ADC_vaule = %d, mV = %d, age %d ms") \
+    X(TLOG_KEY_FAIL,                KEYPAD, WARN,  "ProcessKeypadData fail: Keypad data = %c") \
+    X(TLOG_KEYPAD_PROXIMITY,        KEYPAD, DEBUG, "Keypad proximity = %d") \
+    X(TLOG_KEYPAD_TOUCH,            KEYPAD, DEBUG, "Keypad touch status = 0x%x") \
+    X(TLOG_KEYPAD_UNKNOWN_FRAME,    KEYPAD, WARN,  "Keypad unknown frame type = 0x%x") \
+    X(TLOG_KEYPAD_SECURE_REJECTED,  KEYPAD, WARN,  "Keypad secure frame rejected = %d") \
+    X(TLOG_KEYPAD_PLAIN_DROPPED,    KEYPAD, WARN,  "Keypad plain key frame dropped") \
+    X(TLOG_CYCLE_COUNT,             SYSTEM, INFO,  "Count number = %d") \
+    X(TLOG_BUTTON_CHORD,            UI,     DEBUG, "Button chord") \
+    X(TLOG_BUTTON_PRESS,            UI,     DEBUG, "Button%d press") \
+    X(TLOG_BUTTON_LONG_PRESS,       UI,     DEBUG, "Button%d long press") \
+    X(TLOG_BUTTON_RELEASE,          UI,     DEBUG, "Button%d release") \
+    X(TLOG_BUTTON_CLICK,            UI,     DEBUG, "Button%d click") \
+    X(TLOG_BUTTON_DOUBLE_CLICK,     UI,     DEBUG, "Button%d double click") \
+    X(TLOG_BUTTON_REPEAT,           UI,     DEBUG, "Button%d repeat") \
+    X(TLOG_TEST1_HIGH,              SYSTEM, DEBUG, "Detect test1 pin high") \
+    X(TLOG_TEST1_LOW,               SYSTEM, DEBUG, "Detect test1 pin low") \
+    X(TLOG_TEST2_HIGH,              SYSTEM, DEBUG, "Detect test2 pin high") \
+    X(TLOG_TEST2_LOW,               SYSTEM, DEBUG, "Detect test2 pin low") \
+    X(TLOG_TEST3_HIGH,              SYSTEM, DEBUG, "Detect test3 pin high") \
+    X(TLOG_TEST3_LOW,               SYSTEM, DEBUG, "Detect test3 pin low") \
+    X(TLOG_SW1_PRESS,               UI,     DEBUG, "SW1 press") \
+    X(TLOG_SW2_PRESS,               UI,     DEBUG, "SW2 press") \
+    X(TLOG_LOG_MASK,                SYSTEM, INFO,  "log mask = 0x%x") \
+    X(TLOG_TRACE_BOOT,              SYSTEM, INFO,  "trace boot %d, %d entries kept") \
+    X(TLOG_TRACE_ENTRY,             SYSTEM, INFO,  "trace tick %u: event %d arg %d") \
+    X(TLOG_FAULT,                   SYSTEM, ERROR, "fault %d: vector %d thread %d") \
+    X(TLOG_FAULT_STATUS,            SYSTEM, ERROR, "fault cfsr 0x%x hfsr 0x%x address 0x%x") \
+    X(TLOG_FAULT_TASK,              SYSTEM, ERROR, "fault task 0x%x exc return 0x%x") \
+    X(TLOG_FAULT_TIME,              SYSTEM, ERROR, "fault motor off %u cycles, reset %u us, ready %u us") \
+    X(TLOG_FAULT_REG,               SYSTEM, ERROR, "fault reg %d = 0x%x") \
+    X(TLOG_FAULT_STACK,             SYSTEM, ERROR, "fault stack %d = 0x%x") \
+    X(TLOG_FAULT_TRACE,             SYSTEM, ERROR, "fault trace tick %u: event %d arg %d") \
+    X(TLOG_CREDSTORE_EMPTY,         KEYPAD, WARN,  "No PIN enrolled, provisioning needed") \
+    X(TLOG_PIN_ENROL_START,         KEYPAD, INFO,  "PIN enrolment: user = %d") \
+    X(TLOG_PIN_ENROLLED,            KEYPAD, INFO,  "PIN enrolled: user = %d") \
+    X(TLOG_PIN_ENROL_FAILED,        KEYPAD, WARN,  "PIN enrolment failed") \
+    X(TLOG_STACK_PEAK,              SYSTEM, INFO,  "main task stack peak %u of %u bytes") \
+    X(TLOG_BATTERY_ADC_FAILED,      POWER,  ERROR, "battery adc open failed...") \
+    X(TLOG_BATTERY_CTRL_FAILED,     POWER,  ERROR, "battery control open failed...") \
+    X(TLOG_BATTERY_SAG,             POWER,  INFO,  "Battery sag: %u uV -> min %u uV at %u ms") \
+    X(TLOG_BATTERY_SAG_TIME,        POWER,  INFO,  "Battery sag recovery %u ms, load %u ms") \
+    X(TLOG_BATTERY_LOW,             POWER,  WARN,  "Battery low: charge %u, cell %u mV, under load %u mV") \
+    X(TLOG_BATTERY_OK,              POWER,  INFO,  "Battery ok: charge %u, cell %u mV, under load %u mV") \
+    X(TLOG_TEMPERATURE_I2C_FAILED,  POWER,  ERROR, "temperature i2c open failed...") \
+    X(TLOG_KEYPAD_POWER_ON,         KEYPAD, DEBUG, "keypad power on") \
+    X(TLOG_KEYPAD_POWER_OFF,        KEYPAD, DEBUG, "keypad power off") \
+    X(TLOG_KEYPAD_POWER_FAILED,     KEYPAD, ERROR, "keypad power open failed...") \
+    X(TLOG_AESCCM_FAILED,           KEYPAD, WARN,  "AESCCM open failed, software CCM used") \
+    X(TLOG_KEYPAD_COUNTER_FAILED,   KEYPAD, ERROR, "keypad counter store open failed...") \
+    X(TLOG_KEYPAD_COUNTER,          KEYPAD, INFO,  "keypad counter = %u") \
+    X(TLOG_KEYPAD_COUNTER_UNSAVED,  KEYPAD, ERROR, "keypad counter save failed...") \
+    X(TLOG_CREDSTORE_OPEN_FAILED,   KEYPAD, ERROR, "credential store open failed...") \
+    X(TLOG_CREDSTORE_FORMATTED,     KEYPAD, WARN,  "credential store formatted") \
+    X(TLOG_CREDSTORE_COMPACTED,     KEYPAD, INFO,  "credential store compacted") \
+    X(TLOG_PULSE_TIMER_FAILED,      KEYPAD, ERROR, "pulse timer open failed...") \
+    X(TLOG_KEYPAD_RX_STATS,         KEYPAD, INFO,  "keypad rx %u dropped %u fifo high %d") \
+    X(TLOG_KEYPAD_LATENCY,          KEYPAD, INFO,  "keypad latency us p50 <%u p90 <%u p99 <%u") \
+    X(TLOG_KEYPAD_LATENCY_MAX,      KEYPAD, INFO,  "keypad latency us max %u (%u)") \
+    X(TLOG_KEYPAD_UART_OPENS,       KEYPAD, INFO,  "keypad uart opens %u late %u max %u ms")
+
+#define TLOG_MODULE_ID(module)                  TLOG_MODULE_##module,
+#define TLOG_ID(id, module, level, format)      id,
+
+typedef enum _tlogModule {
+    TLOG_MODULES(TLOG_MODULE_ID)
+    TLOG_MODULE_COUNT
+} TlogModule;
+
+typedef enum _tlogId {
+    TLOG_MESSAGES(TLOG_ID)
+    TLOG_COUNT
+} TlogId;
+
+#undef TLOG_MODULE_ID
+#undef TLOG_ID
+
+#endif // !_TLOG_IDS_H_
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Decode tokenized log frames from the debug UART.
+
+The message table is generated from the TLOG_MESSAGES list in tlog_ids.h,
+the ID of a message being its position in the list. Plain text in the
+stream (System_printf output) is passed through unchanged.
+
+Frame: 0xA5, ID (16-bit little endian), payload length, then each argument
+as an unsigned LEB128 varint.
+
+Usage:
+    tlog_decode.py [--ids tlog_ids.h] [capture.bin]   decode a file or stdin
+    tlog_decode.py --port /dev/ttyUSB0                 decode live (pyserial)
+    tlog_decode.py --table                             print the ID table
+    tlog_decode.py --mask MOTOR=INFO,KEYPAD=WARN       runtime filter mask
+
+The mask is sent as "log <hex>" on the debug UART, "log" alone reports it.
+Modules left out of --mask are turned off.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+TLOG_SYNC = 0xA5
+TLOG_HEADER_LEN = 4
+
+DEFAULT_IDS = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                           os.pardir, "tlog_ids.h")
+
+ENTRY = re.compile(r'X\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+MODULE = re.compile(r'X\(\s*(\w+)\s*\)')
+LEVELS = ["NONE", "ERROR", "WARN", "INFO", "DEBUG"]
+
+
+def read_list(path, name):
+    with open(path, encoding="latin-1") as f:
+        text = f.read()
+    start = text.index("#define " + name)
+    end = text.index("\n\n", start)
+    return text[start:end]
+
+
+def load_table(path):
+    """Return [(name, module, level, format)] in ID order."""
+    return [(name, module, level, bytes(fmt, "latin-1").decode("unicode_escape"))
+            for name, module, level, fmt in ENTRY.findall(read_list(path, "TLOG_MESSAGES"))]
+
+
+def load_modules(path):
+    return MODULE.findall(read_list(path, "TLOG_MODULES"))
+
+
+def make_mask(modules, spec):
+    """MODULE=LEVEL,... to the mask bits up to each level."""
+    mask = 0
+    for item in spec.split(","):
+        module, _, level = item.partition("=")
+        index = modules.index(module.strip().upper())
+        for bit in range(LEVELS.index((level or "DEBUG").strip().upper())):
+            mask |= 1 << (index * 4 + bit)
+    return mask
+
+
+def format_message(fmt, args):
+    values = []
+    for conv, value in zip(re.findall(r"%[-0-9]*([ducx])", fmt), args):
+        if conv == "d" and value & 0x80000000:
+            value -= 1 << 32
+        values.append(value)
+    try:
+        return fmt % tuple(values)
+    except (TypeError, ValueError):
+        return "%s %s" % (fmt, args)
+
+
+def read_varints(payload):
+    args = []
+    value = shift = 0
+    for byte in payload:
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            args.append(value & 0xFFFFFFFF)
+            value = shift = 0
+    return args
+
+
+class Decoder:
+    def __init__(self, table, out):
+        self.table = table
+        self.out = out
+        self.pending = bytearray()
+
+    def feed(self, data):
+        self.pending += data
+        buf = self.pending
+        i = 0
+        while i < len(buf):
+            if buf[i] != TLOG_SYNC:
+                j = buf.find(TLOG_SYNC, i)
+                j = len(buf) if j < 0 else j
+                self.out.write(buf[i:j].decode("latin-1"))
+                i = j
+                continue
+            if len(buf) - i < TLOG_HEADER_LEN:
+                break
+            length = buf[i + 3]
+            if len(buf) - i < TLOG_HEADER_LEN + length:
+                break
+            ident = buf[i + 1] | (buf[i + 2] << 8)
+            args = read_varints(buf[i + TLOG_HEADER_LEN:i + TLOG_HEADER_LEN + length])
+            if ident < len(self.table):
+                self.out.write(format_message(self.table[ident][3], args) + "\r\n")
+            else:
+                self.out.write("<tlog %d %s>\r\n" % (ident, args))
+            i += TLOG_HEADER_LEN + length
+        del buf[:i]
+        self.out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", help="raw capture, default stdin")
+    parser.add_argument("--ids", default=DEFAULT_IDS, help="path to tlog_ids.h")
+    parser.add_argument("--port", help="serial port to read live")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--table", action="store_true",
+                        help="print the ID table as JSON and exit")
+    parser.add_argument("--mask", help="print the log command for MODULE=LEVEL,...")
+    args = parser.parse_args()
+
+    if args.mask:
+        print("log %08x" % make_mask(load_modules(args.ids), args.mask))
+        return
+
+    table = load_table(args.ids)
+    if args.table:
+        json.dump([{"id": i, "name": name, "module": module, "level": level, "format": fmt}
+                   for i, (name, module, level, fmt) in enumerate(table)],
+                  sys.stdout, indent=1)
+        sys.stdout.write("\n")
+        return
+
+    decoder = Decoder(table, sys.stdout)
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            while True:
+                decoder.feed(port.read(256))
+    else:
+        stream = open(args.input, "rb") if args.input else sys.stdin.buffer
+        with stream:
+            while True:
+                data = stream.read(4096)
+                if not data:
+                    break
+                decoder.feed(data)
+
+
+if __name__ == "__main__":
+    main()
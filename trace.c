@@ -0,0 +1,205 @@
+/*
+ *  ======== trace.c ========
+ *  Post-mortem trace.
+ *
+ *  A ring of the latest timestamped events (motor, switches, keys, battery
+ *  reads, faults) in RAM that is not initialized at startup, so it survives
+ *  a warm reset, a watchdog or a brown-out that keeps the SRAM. At boot the
+ *  ring is validated, cleared when it doesn't hold a trace (power-on), and
+ *  its content before the reset is sent to the token log from the idle
+ *  main loop.
+ *
+ *  The dump is a debug feature: it needs TLOG_ENABLE (DEBUG, or
+ *  -DTLOG_LEVEL_SYSTEM=TLOG_LEVEL_INFO), Release builds have no debug
+ *  port. They still record the ring, kept until a power-on, and the crash
+ *  record of fault.c keeps its latest entries: read traceRing and
+ *  faultRecord with the debugger.
+ *
+ *  Logging an event is a few stores without a lock, so it stays on in
+ *  production and can be called from any context. The slot is claimed
+ *  before it is filled: an interrupt logging between the load and the
+ *  store of the head takes the same slot and one of the two events is
+ *  lost, which is accepted for a trace.
+ */
+
+/* XDC module Headers */
+#include <xdc/std.h>
+
+/* BIOS module Headers */
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/devices/cc13x2_cc26x2/driverlib/sys_ctrl.h>
+
+/* Example/Board Header files */
+#include "trace.h"
+#include "tlog.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define TRACE_MASK              (TRACE_LEN - 1)
+
+#if (TRACE_LEN & TRACE_MASK)
+#error "TRACE_LEN must be a power of two"
+#endif
+
+#define TRACE_MAGIC             0x54524345      //"TRCE"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct _traceRing {
+    uint32_t magic;
+    uint32_t head;              //free running, masked on access
+    uint16_t bootCount;
+    uint16_t reserved;
+    TraceEntry entries[TRACE_LEN];
+    uint32_t magicInverse;      //~TRACE_MAGIC, catches a partly valid RAM
+} TraceRing;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+#if defined(__TI_COMPILER_VERSION__)
+#pragma NOINIT(traceRing);
+static TraceRing traceRing;
+#elif defined(__GNUC__)
+static TraceRing traceRing __attribute__ ((section (".noinit")));
+#else
+static TraceRing traceRing;
+#endif
+
+/* Entries from before the boot still to be dumped, [traceDump, traceDumpEnd) */
+static uint32_t traceDump;
+static uint32_t traceDumpEnd;
+
+/**
+  * @brief  Check that the ring holds a trace.
+  * @param none
+  * @return true when valid
+  */
+static bool Trace_isValid(void)
+{
+    uint16_t i;
+
+    if((traceRing.magic != TRACE_MAGIC) || (traceRing.magicInverse != ~(uint32_t)TRACE_MAGIC))
+        return false;
+    for(i = 0; i < TRACE_LEN; i++)
+    {
+        if(traceRing.entries[i].event >= TRACE_EVENT_COUNT)
+            return false;
+    }
+    return true;
+}
+
+/**
+  * @brief  Validate the trace kept over the reset, or start a new one,
+  *         and log the boot. Called once at startup before any event.
+  * @param none
+  * @return none
+  */
+void Trace_init(void)
+{
+    uint16_t i;
+
+    if(Trace_isValid())
+    {
+        traceDumpEnd = traceRing.head;
+        traceDump = (traceDumpEnd > TRACE_LEN) ? traceDumpEnd - TRACE_LEN : 0;
+        traceRing.bootCount++;
+    }
+    else
+    {
+        for(i = 0; i < TRACE_LEN; i++)
+        {
+            traceRing.entries[i].tick = 0;
+            traceRing.entries[i].event = TRACE_NONE;
+            traceRing.entries[i].arg = 0;
+        }
+        traceRing.head = 0;
+        traceRing.bootCount = 0;
+        traceRing.reserved = 0;
+        traceRing.magic = TRACE_MAGIC;
+        traceRing.magicInverse = ~(uint32_t)TRACE_MAGIC;
+        traceDump = 0;
+        traceDumpEnd = 0;
+    }
+
+    TLOG2(TLOG_TRACE_BOOT, traceRing.bootCount, traceDumpEnd - traceDump);
+    Trace_log(TRACE_BOOT, (uint16_t)SysCtrlResetSourceGet());
+}
+
+/**
+  * @brief  Log an event, any context.
+  * @param event : event.
+  * @param arg : event argument.
+  * @return none
+  */
+void Trace_log(TraceEvent event, uint16_t arg)
+{
+    uint32_t head = traceRing.head;
+    TraceEntry *entry = &traceRing.entries[head & TRACE_MASK];
+
+    traceRing.head = head + 1;
+    entry->tick = Clock_getTicks();
+    entry->arg = arg;
+    entry->event = event;
+}
+
+/**
+  * @brief  Send the trace from before the boot to the token log, a few
+  *         entries per call, called when the system is idle. Entries
+  *         overwritten since the boot are skipped. Does nothing without
+  *         TLOG_ENABLE.
+  * @param none
+  * @return none
+  */
+void Trace_idle(void)
+{
+#ifdef TLOG_ENABLE
+    const TraceEntry *entry;
+    uint8_t count = 0;
+
+    while((traceDump != traceDumpEnd) && (count++ < TRACE_DUMP_PER_IDLE))
+    {
+        if((uint32_t)(traceRing.head - traceDump) > TRACE_LEN)
+            traceDump = traceRing.head - TRACE_LEN;
+        if((int32_t)(traceDumpEnd - traceDump) <= 0)
+        {
+            traceDump = traceDumpEnd;
+            break;
+        }
+        entry = &traceRing.entries[traceDump & TRACE_MASK];
+        TLOG3(TLOG_TRACE_ENTRY, entry->tick, entry->event, entry->arg);
+        traceDump++;
+    }
+#endif
+}
+
+/**
+  * @brief  Number of boots with the trace kept, since the last power-on.
+  * @param none
+  * @return boot count
+  */
+uint16_t Trace_getBootCount(void)
+{
+    return traceRing.bootCount;
+}
+
+/**
+  * @brief  Copy the latest entries, oldest first. Lock free, for the fault
+  *         handler.
+  * @param entries : output entries.
+  * @param count : entries wanted, up to TRACE_LEN.
+  * @return none
+  */
+void Trace_getLast(TraceEntry *entries, uint8_t count)
+{
+    uint32_t index = traceRing.head - count;
+    uint8_t i;
+
+    for(i = 0; i < count; i++)
+        entries[i] = traceRing.entries[(index + i) & TRACE_MASK];
+}
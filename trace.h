@@ -0,0 +1,64 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/* Entries kept, power of two */
+#define TRACE_LEN               64
+
+/* Entries sent to the token log per Trace_idle() call when dumping */
+#define TRACE_DUMP_PER_IDLE     8
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/* Values are in the dumps, append only */
+typedef enum _traceEvent {
+    TRACE_NONE = 0,
+    TRACE_BOOT = 1,             //arg: reset source, RSTSRC_xxx
+    TRACE_UNLOCK = 2,
+    TRACE_LOCK = 3,
+    TRACE_MOTOR_START = 4,      //arg: 1 counterclockwise, 2 clockwise
+    TRACE_MOTOR_STOP = 5,
+    TRACE_MOTOR_SW = 6,         //arg: PIN ID of the switch edge
+    TRACE_MOTOR_TIMEOUT = 7,
+    TRACE_KEY = 8,              //arg: key code, 0 for digits
+    TRACE_PIN_ACCEPTED = 9,     //arg: user ID
+    TRACE_PIN_REJECTED = 10,
+    TRACE_BATTERY = 11,         //arg: mV
+    TRACE_FAULT = 12,           //arg: fault code
+    TRACE_PIN_ENROLLED = 13,    //arg: user ID
+    TRACE_EVENT_COUNT
+} TraceEvent;
+
+typedef struct _traceEntry {
+    uint32_t tick;              //Clock ticks since the boot
+    uint16_t event;             //TraceEvent
+    uint16_t arg;
+} TraceEntry;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+extern void Trace_init(void);
+extern void Trace_log(TraceEvent event, uint16_t arg);
+extern void Trace_idle(void);
+extern uint16_t Trace_getBootCount(void);
+extern void Trace_getLast(TraceEntry *entries, uint8_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_TRACE_H_
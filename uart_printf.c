@@ -44,12 +44,23 @@
 #include <Board.h>
 #include <ti/drivers/UART.h>
 #include <ti/drivers/uart/UARTCC26XX.h>
+#include <ti/sysbios/hal/Hwi.h>
 #include <stdint.h>
+#include "tlog.h"
 
 /*********************************************************************
  * CONSTANTS
  */
 #define UART_PRINTF_BUF_LEN      1024
+#define UART_PRINTF_BUF_MASK     (UART_PRINTF_BUF_LEN - 1)
+
+#if (UART_PRINTF_BUF_LEN & UART_PRINTF_BUF_MASK) || (UART_PRINTF_BUF_LEN > 0x8000)
+#error "UART_PRINTF_BUF_LEN must be a power of two up to 0x8000"
+#endif
+
+#ifdef TLOG_COMMAND
+#define UART_PRINTF_LINE_LEN     16
+#endif
 
 /*********************************************************************
  * TYPEDEFS
@@ -59,27 +70,138 @@
  * LOCAL VARIABLES
  */
 static uint8_t  uartPrintf_outArray[UART_PRINTF_BUF_LEN];
-static uint16_t uartPrintf_head = 0;
-static uint16_t uartPrintf_tail = 0;
+
+// Free running indexes, masked on access. System_printf runs from Task, Swi
+// and Hwi context, so putch claims and fills a slot with interrupts off;
+// only the write completion writes tail.
+static volatile uint16_t uartPrintf_head = 0;
+static volatile uint16_t uartPrintf_tail = 0;
+
+// Length of the UART write in progress, 0 when the UART is idle
+static volatile uint16_t uartPrintf_writeLen = 0;
+#ifdef TLOG_ENABLE
+// The write in progress comes from the token log
+static volatile bool uartPrintf_writeTlog = false;
+#endif
+#ifdef TLOG_COMMAND
+// Command line being received, handed to the token log on a line ending
+static char     uartPrintf_inChar;
+static char     uartPrintf_inLine[UART_PRINTF_LINE_LEN];
+static uint8_t  uartPrintf_inLen = 0;
+#endif
 static UART_Handle hUart = NULL;
 
 
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+void uartPrintf_flush(void);
+
+/*********************************************************************
+ * @fn      uartPrintf_writeCallback
+ *
+ * @brief   UART write completion callback, releases the written bytes
+ *          and starts on the rest of the buffer.
+ *
+ * @param   handle - UART driver handle.
+ * @param   buf    - written buffer.
+ * @param   count  - bytes written.
+ *
+ * @return  None.
+ */
+static void uartPrintf_writeCallback(UART_Handle handle, void *buf, size_t count)
+{
+#ifdef TLOG_ENABLE
+	if (uartPrintf_writeTlog)
+		Tlog_release(uartPrintf_writeLen);
+	else
+#endif
+		uartPrintf_tail += uartPrintf_writeLen;
+	uartPrintf_writeLen = 0;
+
+	uartPrintf_flush();
+}
+
+#ifdef TLOG_COMMAND
+/*********************************************************************
+ * @fn      uartPrintf_readCallback
+ *
+ * @brief   UART read completion callback, collects a command line and
+ *          passes it to Tlog_command. Too long lines are dropped.
+ *
+ * @param   handle - UART driver handle.
+ * @param   buf    - read buffer.
+ * @param   count  - bytes read.
+ *
+ * @return  None.
+ */
+static void uartPrintf_readCallback(UART_Handle handle, void *buf, size_t count)
+{
+	char ch = uartPrintf_inChar;
+
+	if (count)
+	{
+		if (ch == '\r' || ch == '\n')
+		{
+			if (uartPrintf_inLen && uartPrintf_inLen <= UART_PRINTF_LINE_LEN)
+				Tlog_command(uartPrintf_inLine, uartPrintf_inLen);
+			uartPrintf_inLen = 0;
+		}
+		else if (uartPrintf_inLen < UART_PRINTF_LINE_LEN)
+			uartPrintf_inLine[uartPrintf_inLen++] = ch;
+		else
+			uartPrintf_inLen = UART_PRINTF_LINE_LEN + 1;
+	}
+
+	UART_read(handle, &uartPrintf_inChar, 1);
+}
+#endif
+
 /*********************************************************************
  * PUBLIC FUNCTIONS
  */
 
+/*********************************************************************
+ * @fn      UartPrintf_setParams
+ *
+ * @brief   Sets up UART parameters for the putchar hooks: writes are
+ *          made in callback mode so the flush never waits on the UART.
+ *          With TLOG_COMMAND, reads are set up the same way for the log
+ *          mask commands.
+ *
+ * @param   params - UART parameters, to be passed to UART_open.
+ *
+ * @return  None.
+ */
+void UartPrintf_setParams(UART_Params *params)
+{
+	params->writeMode = UART_MODE_CALLBACK;
+	params->writeCallback = uartPrintf_writeCallback;
+#ifdef TLOG_COMMAND
+	params->readMode = UART_MODE_CALLBACK;
+	params->readCallback = uartPrintf_readCallback;
+	params->readDataMode = UART_DATA_BINARY;
+	params->readEcho = UART_ECHO_OFF;
+#endif
+}
+
 /*********************************************************************
  * @fn      UartPrintf_init
  *
  * @brief   Initializes the putchar hooks with the handle to the UART.
  *
- * @param   handle - UART driver handle to an initialized and opened UART.
+ * @param   handle - UART driver handle to an initialized and opened UART,
+ *                   with parameters set by UartPrintf_setParams.
  *
  * @return  None.
  */
 void UartPrintf_init(UART_Handle handle)
 {
 	hUart = handle;
+#ifdef TLOG_COMMAND
+	if (NULL != hUart)
+		UART_read(hUart, &uartPrintf_inChar, 1);
+#endif
 }
 
 /*********************************************************************
@@ -95,8 +217,10 @@ void UartPrintf_init(UART_Handle handle)
  *          This function is called whenever the System module needs
  *          to output a character.
  *
- *          This implementation fills a very basic ring-buffer, and relies
- *          on another function to flush this buffer out to UART.
+ *          This implementation fills a ring-buffer, and relies on another
+ *          function to flush this buffer out to UART. The slot is claimed
+ *          and filled with interrupts disabled (a few cycles), as printing
+ *          Swis and Hwis can preempt a printing task.
  *
  *          Requires SysCallback to be the system provider module.
  *          Initialized via SysCallback.putchFxn = "&uartPrintf_putch"; in the
@@ -106,20 +230,20 @@ void UartPrintf_init(UART_Handle handle)
  *
  * @return  None.
  *
- * @post    ::uartPrintf_head is incremented by one with wrap at UART_PRINTF_BUF_LEN
- *          if there is room.
+ * @post    ::uartPrintf_head is incremented by one if there is room.
  */
 void uartPrintf_putch(char ch)
 {
-    // uartPrintf_tail should never catch up with uartPrintf_head. Discard in-between bytes.
-	if ( (uartPrintf_head + 1) % UART_PRINTF_BUF_LEN == uartPrintf_tail )
-		return;
-
-	uartPrintf_outArray[uartPrintf_head] = ch;
-	uartPrintf_head++;
+	UInt key = Hwi_disable();
+	uint16_t head = uartPrintf_head;
 
-	if (uartPrintf_head >= UART_PRINTF_BUF_LEN)
-		uartPrintf_head = 0;
+	// Discard characters while the buffer is full
+	if ((uint16_t)(head - uartPrintf_tail) < UART_PRINTF_BUF_LEN)
+	{
+		uartPrintf_outArray[head & UART_PRINTF_BUF_MASK] = ch;
+		uartPrintf_head = head + 1;
+	}
+	Hwi_restore(key);
 }
 
 /*********************************************************************
@@ -136,38 +260,58 @@ void uartPrintf_putch(char ch)
  *          var Idle = xdc.useModule('ti.sysbios.knl.Idle');
  *          Idle.addFunc('&uartPrintf_flush');
  *
+ *          The contiguous part of the pending data is handed to a
+ *          callback mode UART_write, and the function returns at once.
+ *          The write completion releases the bytes and goes on with
+ *          the rest. Token log frames go first, so text never lands in
+ *          the middle of a frame.
+ *
  * @param   None. Relies on global state.
  *
  * @return  None.
  *
- * @post    ::uartPrintf_tail is incremented to where uartPrintf_head
- *          was at the time the function was called.
+ * @post    A write from ::uartPrintf_tail is in progress if there was
+ *          pending data.
   */
-void uartPrintf_flush()
+void uartPrintf_flush(void)
 {
+	const uint8_t *outData;
+	uint16_t tail;
+	uint16_t outLen;
+	UInt key;
+
 	// Abort in case UART hasn't been initialized.
 	if (NULL == hUart)
 		return;
 
-  // Lock head position to avoid race conditions
-  uint16_t curHead = uartPrintf_head;
+	// Idle and the write completion may both get here, one write at a time
+	key = Hwi_disable();
+	if (uartPrintf_writeLen)
+	{
+		Hwi_restore(key);
+		return;
+	}
 
-  // Find out how much data must be output, and how to output it.
-	bool needWrap = curHead < uartPrintf_tail;
-  uint16_t outLen = needWrap?(UART_PRINTF_BUF_LEN-uartPrintf_tail+curHead):(curHead-uartPrintf_tail);
+#ifdef TLOG_ENABLE
+	outLen = Tlog_peek(&outData);
+	uartPrintf_writeTlog = (outLen != 0);
+	if (!outLen)
+#endif
+	{
+		tail = uartPrintf_tail;
+		outLen = uartPrintf_head - tail;
+
+		// Up to the end of the buffer, the rest goes with the next write
+		if (outLen > UART_PRINTF_BUF_LEN - (tail & UART_PRINTF_BUF_MASK))
+			outLen = UART_PRINTF_BUF_LEN - (tail & UART_PRINTF_BUF_MASK);
+		outData = &uartPrintf_outArray[tail & UART_PRINTF_BUF_MASK];
+	}
+	uartPrintf_writeLen = outLen;
+	Hwi_restore(key);
 
 	if (outLen)
 	{
-		if (needWrap)
-		{
-			UART_write(hUart, &uartPrintf_outArray[uartPrintf_tail], UART_PRINTF_BUF_LEN - uartPrintf_tail);
-			UART_write(hUart, uartPrintf_outArray, curHead);
-		}
-		else
-		{
-			UART_write(hUart, &uartPrintf_outArray[uartPrintf_tail], outLen);
-		}
+		if (UART_write(hUart, outData, outLen) == UART_ERROR)
+			uartPrintf_writeLen = 0;
 	}
-
-	uartPrintf_tail = curHead;
 }
@@ -73,6 +73,20 @@ extern "C"
  */
 void UartPrintf_init(UART_Handle handle);
 
+/*********************************************************************
+ * @fn      UartPrintf_setParams
+ *
+ * @brief   Sets up UART parameters for the putchar hooks: writes are
+ *          made in callback mode so the flush never waits on the UART.
+ *          With TLOG_COMMAND, reads are set up the same way for the log
+ *          mask commands.
+ *
+ * @param   params - UART parameters, to be passed to UART_open.
+ *
+ * @return  None.
+ */
+void UartPrintf_setParams(UART_Params *params);
+
 
 #ifdef __cplusplus
 }
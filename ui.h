@@ -0,0 +1,108 @@
+#ifndef _UI_H_
+#define _UI_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef enum _lowPowerLedType {
+    LOWPOWER_LED_NONE,
+    LOWPOWER_LED_ON,
+    LOWPOWER_LED_FLASH,
+} LowPowerLedType;
+
+typedef enum _beepType {
+    BEEP_NONE,
+    BEEP_ON,
+    BEEP_SHORT,
+} BeepType;
+
+typedef enum _led {
+    LED_NONE,
+    LED_R,
+    LED_G,
+} LED;
+
+typedef enum _ledType {
+    LED_ON,
+    LED_FLASH,
+} LedType;
+
+/*
+ * UI request packed into one 64-bit descriptor so it is passed in registers
+ * and can be built as a compile-time constant.
+ *
+ *  bits  0- 3 : LED, 2 bits each (index 0: front led, index 1: back led)
+ *  bits  4- 5 : LedType, 1 bit each
+ *  bits  6- 7 : LowPowerLedType
+ *  bits  8- 9 : BeepType
+ *  bits 16-31 : led times, signed 8 bits each (unit 200ms, -1 = forever)
+ *  bits 32-39 : low power led times, signed 8 bits (unit 200ms, -1 = forever)
+ *  bits 40-47 : beep times, signed 8 bits (unit 200ms, -1 = forever)
+ */
+typedef uint64_t UIMsg;
+
+/*********************************************************************
+ * MACROS
+ */
+
+#define UI_MSG_LED_SHIFT(i)         (2 * (i))
+#define UI_MSG_LEDTYPE_SHIFT(i)     (4 + (i))
+#define UI_MSG_LOWPOWER_SHIFT       6
+#define UI_MSG_BEEP_SHIFT           8
+#define UI_MSG_LEDTIMES_SHIFT(i)    (16 + 8 * (i))
+#define UI_MSG_LOWPOWERTIMES_SHIFT  32
+#define UI_MSG_BEEPTIMES_SHIFT      40
+
+#define UI_MSG_TIMES(times, shift)  ((UIMsg)(uint8_t)(times) << (shift))
+
+/* Build a UI request from all of its fields */
+#define UI_MSG(frontLed, frontType, frontTimes, backLed, backType, backTimes, lowPower, lowPowerTimes, beepType, beepTimes) \
+    ( ((UIMsg)(frontLed) << UI_MSG_LED_SHIFT(0)) | \
+      ((UIMsg)(backLed) << UI_MSG_LED_SHIFT(1)) | \
+      ((UIMsg)(frontType) << UI_MSG_LEDTYPE_SHIFT(0)) | \
+      ((UIMsg)(backType) << UI_MSG_LEDTYPE_SHIFT(1)) | \
+      ((UIMsg)(lowPower) << UI_MSG_LOWPOWER_SHIFT) | \
+      ((UIMsg)(beepType) << UI_MSG_BEEP_SHIFT) | \
+      UI_MSG_TIMES(frontTimes, UI_MSG_LEDTIMES_SHIFT(0)) | \
+      UI_MSG_TIMES(backTimes, UI_MSG_LEDTIMES_SHIFT(1)) | \
+      UI_MSG_TIMES(lowPowerTimes, UI_MSG_LOWPOWERTIMES_SHIFT) | \
+      UI_MSG_TIMES(beepTimes, UI_MSG_BEEPTIMES_SHIFT) )
+
+/* Common patterns */
+#define UI_MSG_BEEP_TYPE(beepTimes)  ((beepTimes) ? BEEP_ON : BEEP_NONE)
+
+#define UI_MSG_BEEP(beepTimes) \
+    UI_MSG(LED_NONE, LED_FLASH, 0, LED_NONE, LED_FLASH, 0, LOWPOWER_LED_NONE, 0, UI_MSG_BEEP_TYPE(beepTimes), beepTimes)
+
+#define UI_MSG_FRONT_FLASH(led, times, beepTimes) \
+    UI_MSG(led, LED_FLASH, times, LED_NONE, LED_FLASH, 0, LOWPOWER_LED_NONE, 0, UI_MSG_BEEP_TYPE(beepTimes), beepTimes)
+
+#define UI_MSG_BACK_FLASH(led, times, beepTimes) \
+    UI_MSG(LED_NONE, LED_FLASH, 0, led, LED_FLASH, times, LOWPOWER_LED_NONE, 0, UI_MSG_BEEP_TYPE(beepTimes), beepTimes)
+
+#define UI_MSG_BOTH_FLASH(led, times, beepTimes) \
+    UI_MSG(led, LED_FLASH, times, led, LED_FLASH, times, LOWPOWER_LED_NONE, 0, UI_MSG_BEEP_TYPE(beepTimes), beepTimes)
+
+/* Field accessors */
+#define UI_MSG_GET_LED(msg, i)          ((LED)(((msg) >> UI_MSG_LED_SHIFT(i)) & 0x3))
+#define UI_MSG_GET_LEDTYPE(msg, i)      ((LedType)(((msg) >> UI_MSG_LEDTYPE_SHIFT(i)) & 0x1))
+#define UI_MSG_GET_LOWPOWER(msg)        ((LowPowerLedType)(((msg) >> UI_MSG_LOWPOWER_SHIFT) & 0x3))
+#define UI_MSG_GET_BEEP(msg)            ((BeepType)(((msg) >> UI_MSG_BEEP_SHIFT) & 0x3))
+#define UI_MSG_GET_TIMES(msg, shift)    ((int32_t)(int8_t)(uint8_t)((msg) >> (shift)))
+#define UI_MSG_GET_LEDTIMES(msg, i)     UI_MSG_GET_TIMES(msg, UI_MSG_LEDTIMES_SHIFT(i))
+#define UI_MSG_GET_LOWPOWERTIMES(msg)   UI_MSG_GET_TIMES(msg, UI_MSG_LOWPOWERTIMES_SHIFT)
+#define UI_MSG_GET_BEEPTIMES(msg)       UI_MSG_GET_TIMES(msg, UI_MSG_BEEPTIMES_SHIFT)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_UI_H_